@@ -1,7 +1,10 @@
 #include "HttpServer.h"
 #include "Database.h"
+#include "Master.h"
 // 测试命令 curl http://localhost:8080/register -X POST
 //curl: (7) Failed to connect to localhost port 8080: Connection refused 可能是由于停止旧的server后没有及时释放8080端口，新server没有占用该端口
+// 多进程：WORKER_PROCESSES=4 ./myserver 8080；kill -QUIT <主进程> 平滑退出，kill -USR2 <主进程> 升级为磁盘上的新版本
+// 监听多个地址：LISTEN_ADDRESSES="unix:/run/myapp/app.sock,[::1]:8080,127.0.0.1:8080" ./myserver（格式见 Listener.h）
 
 int main(int argc, char* argv[]) {
     int port = 8080;
@@ -9,9 +12,51 @@ int main(int argc, char* argv[]) {
         port = std::stoi(argv[1]); // 从命令行获取端口
     }
     printf("port: %d\n", port);
-    Database db("users.db");
-    HttpServer server(port, 10, db);
-    server.setupRoutes();
-    server.start();
-    return 0;
-}
\ No newline at end of file
+    MasterOptions masterOptions;
+    if (const char* workers = getenv("WORKER_PROCESSES")) {
+        masterOptions.workers = std::stoi(workers); // 为0时单进程运行
+    }
+    ProcessMaster master(argv, masterOptions);
+    bool behindNginx = false; // 有Unix域套接字地址时，nginx 经它转发请求（见 nginx.conf 中的 upstream）
+    if (const char* addresses = getenv("LISTEN_ADDRESSES")) {
+        for (const ListenAddress& address : ListenAddress::parseList(addresses)) {
+            master.listen(address);
+            behindNginx = behindNginx || address.isUnix();
+        }
+    } else {
+        master.listen(port);
+    }
+    return master.run([&](int slot, const std::vector<int>& listeners) {
+        Database db("users.db"); // 每个工作进程在fork之后各自打开数据库
+        HttpServer<PlainTransport> server(port, 10, db);
+        for (int fd : listeners) server.adoptListener(fd);
+        SessionOptions sessionOptions;
+        // 重启后恢复登录会话；会话只在创建它的工作进程中有效，多进程时每个进程一份快照
+        sessionOptions.snapshotPath = masterOptions.workers > 1 ? "sessions." + std::to_string(slot) + ".dat" : "sessions.dat";
+        server.setSessionOptions(sessionOptions);
+        if (const char* keys = getenv("AUTH_TOKEN_KEYS")) {
+            server.setTokenOptions(TokenOptions(), keys); // 例如 AUTH_TOKEN_KEYS="k2:新密钥,k1:旧密钥"
+        } else {
+            server.setTokenOptions(TokenOptions(), "master:" + master.deriveKey("auth-token")); // 所有工作进程互认令牌
+        }
+        OverloadOptions overload;
+        if (const char* budget = getenv("CONNECTION_MEMORY_BUDGET_MB")) {
+            overload.maxConnections = 1000000;
+            overload.memoryBudgetBytes = size_t(std::stoul(budget)) << 20; // 超出时关闭最久没有活动的空闲连接
+        }
+        if (const char* rate = getenv("RATE_LIMIT_PER_SECOND")) {
+            overload.ratePerSecond = std::stod(rate); // 每个客户端IP每秒的请求数，超出回复429
+            if (const char* burst = getenv("RATE_LIMIT_BURST")) overload.burst = std::stod(burst);
+        }
+        // 经Unix域套接字转发的请求来自nginx，按它填写的 X-Real-IP 限流（只采信 trustedProxies 中的对端）
+        overload.trustRealIpHeader = behindNginx;
+        server.setOverloadOptions(overload);
+        if (const char* dir = getenv("UI_DIR")) {
+            server.setAssetDirectory(dir); // 开发时每次请求从磁盘读取页面，例如 UI_DIR=UI
+        }
+        ProcessMaster::onQuit([&server] { server.drain(); });
+        server.setupRoutes();
+        server.start();
+        return 0;
+    });
+}
@@ -3,4 +3,11 @@
 # 启动 Nginx 服务
 nginx -g 'daemon off;' &
 
-
+# 启动应用程序（主进程 + WORKER_PROCESSES 个工作进程），exec 使其接收 docker stop 发出的 SIGQUIT 并平滑退出
+# nginx 经Unix域套接字访问应用（见 nginx.conf 中的 upstream），8080 端口保留用于直接调试
+cd /usr/src/myapp
+mkdir -p /run/myapp
+export LISTEN_ADDRESSES="${LISTEN_ADDRESSES:-unix:/run/myapp/app.sock,8080}"
+# 按客户端IP限流：经nginx转发的请求按 X-Real-IP 计，直接访问8080的按对端IP计
+export RATE_LIMIT_PER_SECOND="${RATE_LIMIT_PER_SECOND:-100}"
+exec ./myserver10
@@ -0,0 +1,313 @@
+/*************************************************************************
+	> File Name: TlsSession.h
+	> Author:
+	> Mail:
+	> Created Time: Tue 20 Oct 2026 09:47:33 AM CST
+ ************************************************************************/
+
+// TLS会话复用：分片的服务端会话缓存、可轮换的会话票据密钥与0-RTT防重放窗口
+#ifndef _TLSSESSION_H
+#define _TLSSESSION_H
+
+#include <openssl/ssl.h>
+#include <openssl/rand.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <cerrno>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <ctime>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+class ReplayWindow;
+
+// 会话复用与应用层协议协商（ALPN）相关的配置
+struct TlsSessionOptions {
+	size_t sessionCacheEntries = 20480; // 服务端会话缓存容量（条），为0时关闭会话缓存
+	long sessionTimeoutSeconds = 3600; // 会话（及票据）的有效期
+	bool sessionTickets = true; // 是否发放无状态会话票据
+	long ticketRotationSeconds = 3600; // 票据密钥的轮换周期
+	std::string ticketSecretFile; // 票据主密钥文件（32字节以上），多个工作进程共用同一文件即可互认票据；为空时随机生成
+	std::string ticketSecret; // 票据主密钥（32字节以上），非空时优先于 ticketSecretFile，例如多进程模型中主进程派生的密钥
+	uint32_t maxEarlyData = 0; // TLS 1.3 0-RTT 早期数据的上限（字节），为0时关闭
+	size_t replayWindowBits = 1 << 20; // 早期数据防重放窗口中每个布隆过滤器的位数
+	std::shared_ptr<ReplayWindow> replayWindow; // 多进程共用的防重放窗口（见 ReplayWindow::shared），为空时每个服务器各自创建
+	bool enableHttp2 = true; // ALPN中是否提供 h2，关闭后TLS连接只使用HTTP/1.1
+};
+
+// 服务端会话缓存：按会话ID哈希分片，每个分片独立加锁并按LRU淘汰，
+// 保存DER序列化后的会话，所有工作线程共享
+class TlsSessionCache {
+public:
+	explicit TlsSessionCache(size_t capacity) : perShard(capacity / kShards + 1) {}
+
+	void put(SSL_SESSION* session) {
+		unsigned int idLen = 0;
+		const unsigned char* id = SSL_SESSION_get_id(session, &idLen);
+		int derLen = i2d_SSL_SESSION(session, nullptr);
+		if (idLen == 0 || derLen <= 0) return;
+		std::string der(derLen, '\0');
+		unsigned char* p = reinterpret_cast<unsigned char*>(&der[0]);
+		i2d_SSL_SESSION(session, &p);
+
+		std::string key(reinterpret_cast<const char*>(id), idLen);
+		Shard& shard = shardFor(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.entries.find(key);
+		if (it != shard.entries.end()) {
+			shard.lru.erase(it->second.lruPos);
+			shard.entries.erase(it);
+		}
+		while (shard.entries.size() >= perShard && !shard.lru.empty()) {
+			shard.entries.erase(shard.lru.back());
+			shard.lru.pop_back();
+		}
+		shard.lru.push_front(key);
+		shard.entries[key] = Entry{std::move(der), shard.lru.begin()};
+	}
+
+	// 查找会话，返回的 SSL_SESSION 由调用者（OpenSSL）负责释放
+	SSL_SESSION* get(const unsigned char* id, int idLen) {
+		std::string key(reinterpret_cast<const char*>(id), idLen);
+		Shard& shard = shardFor(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.entries.find(key);
+		if (it == shard.entries.end()) {
+			misses++;
+			return nullptr;
+		}
+		shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lruPos);
+		hits++;
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(it->second.der.data());
+		return d2i_SSL_SESSION(nullptr, &p, it->second.der.size());
+	}
+
+	void remove(SSL_SESSION* session) {
+		unsigned int idLen = 0;
+		const unsigned char* id = SSL_SESSION_get_id(session, &idLen);
+		std::string key(reinterpret_cast<const char*>(id), idLen);
+		Shard& shard = shardFor(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.entries.find(key);
+		if (it == shard.entries.end()) return;
+		shard.lru.erase(it->second.lruPos);
+		shard.entries.erase(it);
+	}
+
+	size_t size() {
+		size_t total = 0;
+		for (auto& shard : shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			total += shard.entries.size();
+		}
+		return total;
+	}
+
+	std::atomic<uint64_t> hits{0}, misses{0};
+
+private:
+	static const size_t kShards = 16;
+
+	struct Entry {
+		std::string der; // DER序列化的会话
+		std::list<std::string>::iterator lruPos;
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::unordered_map<std::string, Entry> entries;
+		std::list<std::string> lru; // 头部为最近使用
+	};
+
+	size_t perShard;
+	Shard shards[kShards];
+
+	Shard& shardFor(const std::string& key) {
+		return shards[std::hash<std::string>()(key) % kShards];
+	}
+};
+
+// 会话票据密钥：由一个主密钥和轮换周期序号派生（HMAC-SHA256），
+// 持有相同主密钥的进程无需通信就能在同一周期得到相同的密钥，
+// 当前周期的密钥用于加密，上一周期的密钥仍可解密（并触发票据续发）
+class TicketKeyRing {
+public:
+	struct Key {
+		unsigned char name[16];
+		unsigned char aesKey[32];
+		unsigned char hmacKey[32];
+	};
+
+	TicketKeyRing(long rotationSeconds, const std::string& secretFile, const std::string& secretBytes = std::string())
+		: rotation(rotationSeconds > 0 ? rotationSeconds : 3600), cachedEpoch(-1) {
+		if (!secretBytes.empty()) {
+			if (secretBytes.size() < 32) {
+				throw std::runtime_error("Ticket secret must contain at least 32 bytes");
+			}
+			secret = secretBytes;
+		} else if (!secretFile.empty()) {
+			std::ifstream in(secretFile, std::ios::binary);
+			secret.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+			if (secret.size() < 32) {
+				throw std::runtime_error("Ticket secret file must contain at least 32 bytes");
+			}
+		} else {
+			secret.resize(32);
+			if (RAND_bytes(reinterpret_cast<unsigned char*>(&secret[0]), secret.size()) != 1) {
+				throw std::runtime_error("RAND_bytes failed");
+			}
+		}
+	}
+
+	// 当前周期的加密密钥
+	Key current() {
+		std::lock_guard<std::mutex> lock(mutex);
+		refresh();
+		return keys[0];
+	}
+
+	// 按密钥名查找解密密钥；返回1表示当前密钥，2表示上一周期的密钥（需续发票据），0表示未找到
+	int find(const unsigned char name[16], Key& key) {
+		std::lock_guard<std::mutex> lock(mutex);
+		refresh();
+		for (int i = 0; i < 2; ++i) {
+			if (memcmp(keys[i].name, name, sizeof(keys[i].name)) == 0) {
+				key = keys[i];
+				return i + 1;
+			}
+		}
+		return 0;
+	}
+
+private:
+	long rotation;
+	std::string secret;
+	std::mutex mutex;
+	long cachedEpoch;
+	Key keys[2]; // [0] 当前周期，[1] 上一周期
+
+	// 周期变化时重新派生密钥（调用时已持有锁）
+	void refresh() {
+		long epoch = time(nullptr) / rotation;
+		if (epoch == cachedEpoch) return;
+		derive(epoch, keys[0]);
+		derive(epoch - 1, keys[1]);
+		cachedEpoch = epoch;
+	}
+
+	void derive(long epoch, Key& key) {
+		unsigned char material[96];
+		for (unsigned char block = 0; block < 3; ++block) {
+			unsigned char input[sizeof(epoch) + 1];
+			memcpy(input, &epoch, sizeof(epoch));
+			input[sizeof(epoch)] = block;
+			unsigned int len = 32;
+			HMAC(EVP_sha256(), secret.data(), secret.size(), input, sizeof(input), material + block * 32, &len);
+		}
+		memcpy(key.name, material, 16);
+		memcpy(key.aesKey, material + 32, 32);
+		memcpy(key.hmacKey, material + 64, 32);
+	}
+};
+
+// 0-RTT防重放窗口：记录用过的恢复密钥（每张票据唯一）的摘要，同一票据第二次携带早期数据时拒绝早期数据。
+// 使用两个轮换的布隆过滤器，每个覆盖一个票据有效期，内存固定；误判只会让该连接退回1-RTT。
+// 票据密钥在所有工作进程之间共用，同一张票据可以被发往任何一个工作进程，所以多进程时窗口也必须共用：
+// 用 shared() 在主进程fork之前创建，过滤器与锁放在 MAP_SHARED 的匿名映射中，各工作进程（包括崩溃后重启的）继承同一份。
+// 升级可执行文件时新旧两批工作进程各用一个窗口，交接期间一张票据最多可能被各接受一次
+class ReplayWindow {
+public:
+	ReplayWindow(size_t bits, long windowSeconds, bool processShared = false)
+		: words((bits > 64 ? bits : 64) / 64), window(windowSeconds > 0 ? windowSeconds : 3600) {
+		mappingSize = sizeof(Header) + 2 * words * sizeof(uint64_t);
+		void* memory = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+			(processShared ? MAP_SHARED : MAP_PRIVATE) | MAP_ANONYMOUS, -1, 0); // 匿名映射初始为全0
+		if (memory == MAP_FAILED) {
+			throw std::runtime_error(std::string("mmap replay window failed: ") + strerror(errno));
+		}
+		header = static_cast<Header*>(memory);
+		filters = reinterpret_cast<uint64_t*>(header + 1);
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		if (processShared) pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+		pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST); // 持锁的工作进程崩溃后其他进程仍能加锁
+		pthread_mutex_init(&header->mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+		header->rotatedAt = time(nullptr);
+	}
+
+	// 多进程共用的窗口，需在fork工作进程之前创建
+	static std::shared_ptr<ReplayWindow> shared(size_t bits, long windowSeconds) {
+		return std::make_shared<ReplayWindow>(bits, windowSeconds, true);
+	}
+
+	~ReplayWindow() {
+		munmap(header, mappingSize); // 只解除本进程的映射，其他工作进程不受影响
+	}
+
+	ReplayWindow(const ReplayWindow&) = delete;
+	ReplayWindow& operator=(const ReplayWindow&) = delete;
+
+	// 首次出现返回true并记录；已出现过（可能是重放）返回false
+	bool checkAndInsert(const unsigned char* data, size_t len) {
+		unsigned char digest[32];
+		unsigned int digestLen = 0;
+		EVP_Digest(data, len, digest, &digestLen, EVP_sha256(), nullptr);
+		uint64_t h1, h2;
+		memcpy(&h1, digest, sizeof(h1));
+		memcpy(&h2, digest + 8, sizeof(h2));
+
+		if (pthread_mutex_lock(&header->mutex) == EOWNERDEAD) {
+			pthread_mutex_consistent(&header->mutex); // 上一个持锁者崩溃，过滤器最多少记一张票据
+		}
+		time_t now = time(nullptr);
+		if (now - header->rotatedAt >= window) {
+			header->current ^= 1; // 上一窗口变为当前窗口并清空，丢弃更早的记录
+			std::fill(filter(header->current), filter(header->current) + words, 0);
+			header->rotatedAt = now;
+		}
+		uint64_t* current = filter(header->current);
+		uint64_t* previous = filter(header->current ^ 1);
+		bool seen = true;
+		for (int i = 0; i < kHashes; ++i) {
+			uint64_t bit = (h1 + i * h2) % (words * 64);
+			uint64_t mask = 1ULL << (bit % 64);
+			if (!((current[bit / 64] | previous[bit / 64]) & mask)) seen = false;
+			current[bit / 64] |= mask;
+		}
+		pthread_mutex_unlock(&header->mutex);
+		return !seen;
+	}
+
+private:
+	static const int kHashes = 4;
+
+	// 映射开头的共享状态，之后是两个过滤器
+	struct Header {
+		pthread_mutex_t mutex;
+		time_t rotatedAt;
+		int current; // 当前窗口的过滤器下标，另一个为上一窗口
+	};
+
+	size_t words;
+	long window;
+	size_t mappingSize;
+	Header* header;
+	uint64_t* filters;
+
+	uint64_t* filter(int index) {
+		return filters + index * words;
+	}
+};
+
+#endif
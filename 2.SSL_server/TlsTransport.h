@@ -0,0 +1,405 @@
+/*************************************************************************
+	> File Name: TlsTransport.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 19 Oct 2026 10:40:05 AM CST
+ ************************************************************************/
+
+#ifndef _TLSTRANSPORT_H
+#define _TLSTRANSPORT_H
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/core_names.h>
+#include <sys/uio.h>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <ostream>
+
+#include "Logger.h"
+#include "Transport.h"
+#include "TlsSession.h"
+
+// 按连接统计OpenSSL的堆内存：替换OpenSSL的内存分配函数，每块内存前加一个记录大小的头，
+// 在某个连接上调用SSL函数期间分配与释放的字节计入该连接（由 Scope 指定）。
+// 必须在OpenSSL第一次分配内存之前安装，因此在静态初始化阶段完成
+class TlsMemory {
+public:
+	static bool install() {
+		return CRYPTO_set_mem_functions(allocate, reallocate, release) == 1;
+	}
+
+	// OpenSSL当前占用的堆内存总量（包括SSL上下文与会话缓存）
+	static int64_t totalBytes() {
+		return total().load(std::memory_order_relaxed);
+	}
+
+	// 在作用域内把OpenSSL的内存分配计入 counter
+	class Scope {
+	public:
+		explicit Scope(int64_t& counter) : previous(current()) {
+			current() = &counter;
+		}
+
+		~Scope() {
+			current() = previous;
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		int64_t* previous;
+	};
+
+private:
+	static const size_t kHeader = 16; // 保持 malloc 的16字节对齐
+
+	static std::atomic<int64_t>& total() {
+		static std::atomic<int64_t> bytes{0};
+		return bytes;
+	}
+
+	static int64_t*& current() {
+		thread_local int64_t* counter = nullptr;
+		return counter;
+	}
+
+	static void add(int64_t delta) {
+		total().fetch_add(delta, std::memory_order_relaxed);
+		if (int64_t* counter = current()) *counter += delta;
+	}
+
+	static void* allocate(size_t n, const char*, int) {
+		char* base = static_cast<char*>(malloc(n + kHeader));
+		if (!base) return nullptr;
+		*reinterpret_cast<size_t*>(base) = n;
+		add(int64_t(n));
+		return base + kHeader;
+	}
+
+	static void* reallocate(void* ptr, size_t n, const char* file, int line) {
+		if (!ptr) return allocate(n, file, line);
+		char* base = static_cast<char*>(ptr) - kHeader;
+		size_t old = *reinterpret_cast<size_t*>(base);
+		char* grown = static_cast<char*>(realloc(base, n + kHeader));
+		if (!grown) return nullptr;
+		*reinterpret_cast<size_t*>(grown) = n;
+		add(int64_t(n) - int64_t(old));
+		return grown + kHeader;
+	}
+
+	static void release(void* ptr, const char*, int) {
+		if (!ptr) return;
+		char* base = static_cast<char*>(ptr) - kHeader;
+		add(-int64_t(*reinterpret_cast<size_t*>(base)));
+		free(base);
+	}
+};
+
+inline const bool tlsMemoryHooked = TlsMemory::install();
+
+// TLS传输，使用 SSL_read/SSL_write，内核支持时通过kTLS把对称加密交给内核完成
+class TlsTransport {
+public:
+	struct Session {
+		SSL* ssl = nullptr;
+		bool readingEarlyData = false; // 是否仍处于接收0-RTT早期数据的阶段
+		std::string earlyData; // 已收到但尚未交给服务器处理的早期数据
+		int64_t memory = 0; // OpenSSL为该连接分配、尚未释放的堆内存
+	};
+
+	static constexpr bool needsHandshake = true;
+	static constexpr bool canSplice = false; // 收到的是加密记录，必须经 SSL_read 解密
+
+	static const char* name() { return "HTTPS"; }
+
+	TlsTransport(const std::string& certFile = "server.crt", const std::string& keyFile = "server.key",
+		const TlsSessionOptions& sessionOptions = TlsSessionOptions()) {
+		SSL_library_init(); // 初始化OpenSSL
+		OpenSSL_add_ssl_algorithms(); // 加载SSL算法
+		SSL_load_error_strings(); // 加载错误信息
+		sslCtx = SSL_CTX_new(TLS_server_method()); // 创建SSL上下文
+		if (!sslCtx) {
+			throw std::runtime_error("Unable to create SSL context");
+		}
+
+		// 加载服务器证书和私钥
+		if (SSL_CTX_use_certificate_file(sslCtx, certFile.c_str(), SSL_FILETYPE_PEM) <= 0 ||
+			SSL_CTX_use_PrivateKey_file(sslCtx, keyFile.c_str(), SSL_FILETYPE_PEM) <= 0) {
+			ERR_print_errors_fp(stderr);
+			SSL_CTX_free(sslCtx);
+			throw std::runtime_error("Failed to load cert or key file");
+		}
+
+		// 允许部分写入，并允许重试 SSL_write 时传入不同地址的缓冲区（发送缓冲区可能被重新分配）；
+		// RELEASE_BUFFERS 让空闲连接归还约34KB的记录层读写缓冲区，下次收发时再分配
+		SSL_CTX_set_mode(sslCtx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER |
+			SSL_MODE_RELEASE_BUFFERS);
+		if (!tlsMemoryHooked) LOG_WARNING("OpenSSL memory functions not installed, per-connection TLS memory is not tracked");
+#ifdef SSL_OP_ENABLE_KTLS
+		// 内核与OpenSSL都支持时启用kTLS，握手完成后的记录层加解密由内核完成
+		SSL_CTX_set_options(sslCtx, SSL_OP_ENABLE_KTLS);
+#endif
+		setupSessionResumption(sessionOptions);
+		http2Enabled = sessionOptions.enableHttp2;
+		SSL_CTX_set_alpn_select_cb(sslCtx, alpnSelectCallback, this);
+	}
+
+	TlsTransport(const TlsTransport&) = delete;
+	TlsTransport& operator=(const TlsTransport&) = delete;
+
+	~TlsTransport() {
+		SSL_CTX_free(sslCtx); // 释放SSL上下文
+	}
+
+	bool open(Session& s, int fd) {
+		TlsMemory::Scope scope(s.memory);
+		s.ssl = SSL_new(sslCtx); // 为新连接创建一个新的SSL对象
+		if (!s.ssl) {
+			LOG_ERROR("SSL_new failed for fd: %d", fd);
+			return false;
+		}
+		SSL_set_fd(s.ssl, fd); // 将SSL对象与客户端的文件描述符绑定
+		SSL_set_accept_state(s.ssl); // 作为服务端等待客户端发起握手
+		s.readingEarlyData = replayWindow != nullptr;
+		return true;
+	}
+
+	// 推进非阻塞握手，未完成时返回需要等待的事件
+	IoStatus handshake(Session& s) {
+		TlsMemory::Scope scope(s.memory);
+		// 开启0-RTT时必须先用 SSL_read_early_data 读取早期数据，读到的数据暂存在 earlyData 中
+		while (s.readingEarlyData) {
+			char buffer[4096];
+			size_t n = 0;
+			int ret = SSL_read_early_data(s.ssl, buffer, sizeof(buffer), &n);
+			if (ret == SSL_READ_EARLY_DATA_ERROR) return toStatus(s, 0);
+			s.earlyData.append(buffer, n);
+			if (ret == SSL_READ_EARLY_DATA_FINISH) s.readingEarlyData = false;
+		}
+		int ret = SSL_do_handshake(s.ssl);
+		if (ret == 1) {
+			if (SSL_session_reused(s.ssl)) resumedHandshakes++; // 复用会话，省去了非对称运算
+			else fullHandshakes++;
+			return IO_OK;
+		}
+		return toStatus(s, ret);
+	}
+
+	IoStatus read(Session& s, char* buf, size_t len, size_t& n) {
+		TlsMemory::Scope scope(s.memory);
+		if (SSL_read_ex(s.ssl, buf, len, &n) == 1) return IO_OK;
+		return toStatus(s, 0);
+	}
+
+	// SSL_read 一次最多返回一条TLS记录，逐段读取，某段没有读满说明已没有现成的数据
+	IoStatus readv(Session& s, const struct iovec* iov, int count, size_t& n) {
+		TlsMemory::Scope scope(s.memory);
+		n = 0;
+		for (int i = 0; i < count; i++) {
+			size_t got = 0;
+			if (SSL_read_ex(s.ssl, iov[i].iov_base, iov[i].iov_len, &got) != 1) {
+				if (n > 0) return IO_OK; // 先交出已经读到的数据，错误留到下次读取时再报告
+				return toStatus(s, 0);
+			}
+			n += got;
+			if (got < iov[i].iov_len) break;
+		}
+		return IO_OK;
+	}
+
+	IoStatus write(Session& s, const char* buf, size_t len, size_t& n) {
+		TlsMemory::Scope scope(s.memory);
+		if (s.readingEarlyData) {
+			// 握手完成前对早期请求的响应（0.5-RTT数据）
+			if (SSL_write_early_data(s.ssl, buf, len, &n) == 1) return IO_OK;
+			return toStatus(s, 0);
+		}
+		if (SSL_write_ex(s.ssl, buf, len, &n) == 1) return IO_OK;
+		return toStatus(s, 0);
+	}
+
+	// 取走握手期间收到的早期数据，没有时返回false
+	bool takeEarlyData(Session& s, std::string& out) {
+		if (s.earlyData.empty()) return false;
+		out.swap(s.earlyData);
+		s.earlyData.clear();
+		return true;
+	}
+
+	// 握手时客户端与服务端是否通过ALPN选定了 h2
+	bool negotiatedHttp2(Session& s) {
+		const unsigned char* proto = nullptr;
+		unsigned int len = 0;
+		SSL_get0_alpn_selected(s.ssl, &proto, &len);
+		return len == 2 && memcmp(proto, "h2", 2) == 0;
+	}
+
+	void close(Session& s) {
+		if (!s.ssl) return;
+		TlsMemory::Scope scope(s.memory);
+		SSL_shutdown(s.ssl); // 尽力发送close_notify，非阻塞下失败也无妨
+		ERR_clear_error(); // 失败时留下的错误会让同一线程上下一个连接的 SSL_get_error 误报为SSL错误
+		SSL_free(s.ssl);
+		s.ssl = nullptr;
+	}
+
+	// 连接当前占用的TLS内存：SSL对象及其缓冲区，握手期间为该连接缓存的会话也计入其中
+	size_t memoryUsage(const Session& s) const {
+		return (s.memory > 0 ? size_t(s.memory) : 0) + s.earlyData.capacity();
+	}
+
+	// 导出握手与会话复用的计数器
+	void writeMetrics(std::ostream& out) {
+		out << "tls_handshakes_full_total " << fullHandshakes << "\n"
+			<< "tls_handshakes_resumed_total " << resumedHandshakes << "\n"
+			<< "tls_tickets_issued_total " << ticketsIssued << "\n"
+			<< "tls_early_data_accepted_total " << earlyDataAccepted << "\n"
+			<< "tls_early_data_replays_total " << earlyDataReplays << "\n"
+			<< "tls_heap_bytes " << TlsMemory::totalBytes() << "\n";
+		if (sessionCache) {
+			out << "tls_session_cache_entries " << sessionCache->size() << "\n"
+				<< "tls_session_cache_hits_total " << sessionCache->hits << "\n"
+				<< "tls_session_cache_misses_total " << sessionCache->misses << "\n";
+		}
+	}
+
+private:
+	SSL_CTX* sslCtx; // SSL上下文，所有连接共享
+	std::unique_ptr<TlsSessionCache> sessionCache; // 服务端会话缓存（替代OpenSSL内置的单锁缓存）
+	std::unique_ptr<TicketKeyRing> ticketKeys; // 会话票据密钥
+	std::shared_ptr<ReplayWindow> replayWindow; // 0-RTT防重放窗口，为空表示未开启早期数据
+	std::atomic<uint64_t> fullHandshakes{0}, resumedHandshakes{0}, ticketsIssued{0};
+	std::atomic<uint64_t> earlyDataAccepted{0}, earlyDataReplays{0};
+	bool http2Enabled = true; // ALPN中是否提供 h2
+
+	static TlsTransport* fromSSL(SSL* ssl) {
+		return static_cast<TlsTransport*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+	}
+
+	// 配置会话缓存与会话票据
+	void setupSessionResumption(const TlsSessionOptions& options) {
+		SSL_CTX_set_app_data(sslCtx, this);
+		static const unsigned char sidContext[] = "cpp_webserver";
+		SSL_CTX_set_session_id_context(sslCtx, sidContext, sizeof(sidContext) - 1);
+		SSL_CTX_set_timeout(sslCtx, options.sessionTimeoutSeconds);
+
+		if (options.sessionCacheEntries > 0) {
+			sessionCache.reset(new TlsSessionCache(options.sessionCacheEntries));
+			// 关闭OpenSSL内置缓存，改由外部分片缓存保存会话
+			SSL_CTX_set_session_cache_mode(sslCtx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+			SSL_CTX_sess_set_new_cb(sslCtx, [](SSL* ssl, SSL_SESSION* session) {
+				fromSSL(ssl)->sessionCache->put(session);
+				return 0; // 缓存保存的是序列化副本，不持有session的引用
+			});
+			SSL_CTX_sess_set_get_cb(sslCtx, [](SSL* ssl, const unsigned char* id, int idLen, int* copy) {
+				*copy = 0; // 返回的session引用交给OpenSSL
+				return fromSSL(ssl)->sessionCache->get(id, idLen);
+			});
+			SSL_CTX_sess_set_remove_cb(sslCtx, [](SSL_CTX* ctx, SSL_SESSION* session) {
+				static_cast<TlsTransport*>(SSL_CTX_get_app_data(ctx))->sessionCache->remove(session);
+			});
+		} else {
+			SSL_CTX_set_session_cache_mode(sslCtx, SSL_SESS_CACHE_OFF);
+		}
+
+		if (!options.sessionTickets) {
+			// TLS 1.3 下关闭无状态票据后，OpenSSL 改为发放指向会话缓存的有状态票据
+			SSL_CTX_set_options(sslCtx, SSL_OP_NO_TICKET);
+			return;
+		}
+		ticketKeys.reset(new TicketKeyRing(options.ticketRotationSeconds, options.ticketSecretFile, options.ticketSecret));
+		SSL_CTX_set_tlsext_ticket_key_evp_cb(sslCtx, ticketKeyCallback);
+
+		if (options.maxEarlyData > 0) {
+			// OpenSSL内置的防重放依赖其内部会话缓存，与外部缓存/无状态票据不兼容，
+			// 这里关闭它，改由 allow_early_data 回调中的重放窗口保证每张票据的早期数据只被接受一次
+			SSL_CTX_set_options(sslCtx, SSL_OP_NO_ANTI_REPLAY);
+			SSL_CTX_set_max_early_data(sslCtx, options.maxEarlyData);
+			SSL_CTX_set_recv_max_early_data(sslCtx, options.maxEarlyData);
+			replayWindow = options.replayWindow ? options.replayWindow
+				: std::make_shared<ReplayWindow>(options.replayWindowBits, options.sessionTimeoutSeconds);
+			SSL_CTX_set_allow_early_data_cb(sslCtx, allowEarlyDataCallback, this);
+		}
+	}
+
+	// ALPN协议选择：按服务端的偏好顺序（h2 优先于 http/1.1）从客户端列表中选择
+	static int alpnSelectCallback(SSL*, const unsigned char** out, unsigned char* outLen,
+		const unsigned char* in, unsigned int inLen, void* arg) {
+		static const unsigned char withHttp2[] = "\x02h2\x08http/1.1";
+		static const unsigned char http11Only[] = "\x08http/1.1";
+		TlsTransport* self = static_cast<TlsTransport*>(arg);
+		const unsigned char* protos = self->http2Enabled ? withHttp2 : http11Only;
+		unsigned int protosLen = self->http2Enabled ? sizeof(withHttp2) - 1 : sizeof(http11Only) - 1;
+		unsigned char* selected = nullptr;
+		if (SSL_select_next_proto(&selected, outLen, protos, protosLen, in, inLen) != OPENSSL_NPN_NEGOTIATED) {
+			return SSL_TLSEXT_ERR_NOACK; // 没有共同的协议：不回应ALPN，按HTTP/1.1处理
+		}
+		*out = selected;
+		return SSL_TLSEXT_ERR_OK;
+	}
+
+	// 决定是否接受早期数据：以恢复会话的主密钥（TLS 1.3 中每张票据各不相同）标识票据
+	static int allowEarlyDataCallback(SSL* ssl, void* arg) {
+		TlsTransport* self = static_cast<TlsTransport*>(arg);
+		SSL_SESSION* session = SSL_get0_session(ssl);
+		unsigned char secret[SSL_MAX_MASTER_KEY_LENGTH];
+		size_t len = session ? SSL_SESSION_get_master_key(session, secret, sizeof(secret)) : 0;
+		if (len == 0) return 0;
+		if (!self->replayWindow->checkAndInsert(secret, len)) {
+			self->earlyDataReplays++;
+			LOG_WARNING("Rejected replayed TLS early data");
+			return 0; // 票据已携带过早期数据，拒绝早期数据，握手照常进行
+		}
+		self->earlyDataAccepted++;
+		return 1;
+	}
+
+	// 会话票据的加解密回调：enc=1 时用当前密钥加密新票据，enc=0 时按密钥名查找解密密钥
+	static int ticketKeyCallback(SSL* ssl, unsigned char keyName[16], unsigned char* iv,
+		EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc) {
+		TlsTransport* self = fromSSL(ssl);
+		TicketKeyRing::Key key;
+		int result = 1;
+		if (enc) {
+			key = self->ticketKeys->current();
+			if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1) return -1;
+			memcpy(keyName, key.name, sizeof(key.name));
+			if (EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) != 1) return -1;
+			self->ticketsIssued++;
+		} else {
+			result = self->ticketKeys->find(keyName, key);
+			if (result == 0) return 0; // 密钥已过期或不认识，退回完整握手
+			if (EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) != 1) return -1;
+		}
+		OSSL_PARAM params[] = {
+			OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmacKey, sizeof(key.hmacKey)),
+			OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+			OSSL_PARAM_construct_end()
+		};
+		if (EVP_MAC_CTX_set_params(macCtx, params) != 1) return -1;
+		return result; // 2 表示用上一周期的密钥解密成功，OpenSSL 会续发新票据
+	}
+
+	// 将OpenSSL的错误码映射为IoStatus
+	IoStatus toStatus(Session& s, int ret) {
+		int err = SSL_get_error(s.ssl, ret);
+		switch (err) {
+			case SSL_ERROR_WANT_READ: return IO_WANT_READ;
+			case SSL_ERROR_WANT_WRITE: return IO_WANT_WRITE;
+			case SSL_ERROR_ZERO_RETURN: return IO_CLOSED;
+			default:
+				LOG_ERROR("SSL operation failed with SSL error: %d", err);
+				ERR_clear_error(); // 清空线程本地错误队列，避免影响同一线程上的下一个连接
+				return IO_ERROR;
+		}
+	}
+};
+
+#endif
@@ -1,17 +1,86 @@
+#include <thread>
+
 #include "HttpServer.h"
+#include "TlsTransport.h"
 #include "Database.h"
-// 测试命令 curl http://localhost:8080/register -X POST
+#include "Master.h"
+// 测试命令 curl -k https://localhost:8080/register -X POST
+// 同时提供明文服务：./myserver 8080 8081，然后 curl http://localhost:8081/
 //curl: (7) Failed to connect to localhost port 8080: Connection refused 可能是由于停止旧的server后没有及时释放8080端口，新server没有占用该端口
+// 多进程：WORKER_PROCESSES=4 ./myserver 8080；kill -QUIT <主进程> 平滑退出，kill -USR2 <主进程> 升级为磁盘上的新版本
 
 int main(int argc, char* argv[]) {
     int port = 8080;
     if (argc > 1) {
-        port = std::stoi(argv[1]); // 从命令行获取端口
+        port = std::stoi(argv[1]); // 从命令行获取HTTPS端口
     }
     printf("port: %d\n", port);
-    Database db("users.db");
-    HttpServer server(port, 10, db);
-    server.setupRoutes();
-    server.start();
-    return 0;
-}
\ No newline at end of file
+    int plain_port = argc > 2 ? std::stoi(argv[2]) : 0; // 可选的明文端口
+    if (plain_port) printf("plain port: %d\n", plain_port);
+    MasterOptions masterOptions;
+    if (const char* workers = getenv("WORKER_PROCESSES")) {
+        masterOptions.workers = std::stoi(workers); // 为0时单进程运行
+    }
+    ProcessMaster master(argv, masterOptions);
+    // 0-RTT早期数据（默认关闭），例如 TLS_EARLY_DATA=16384。票据在所有工作进程之间互认，
+    // 防重放窗口必须由主进程在fork之前创建（MAP_SHARED），否则同一份早期数据可以在每个工作进程各重放一次
+    TlsSessionOptions earlyDataOptions;
+    if (const char* earlyData = getenv("TLS_EARLY_DATA")) {
+        earlyDataOptions.maxEarlyData = uint32_t(std::stoul(earlyData));
+        if (earlyDataOptions.maxEarlyData > 0) {
+            earlyDataOptions.replayWindow = ReplayWindow::shared(earlyDataOptions.replayWindowBits, earlyDataOptions.sessionTimeoutSeconds);
+        }
+    }
+    master.listen(port);
+    if (plain_port) master.listen(plain_port);
+    return master.run([&](int slot, const std::vector<int>& listeners) {
+        Database db("users.db"); // 每个工作进程在fork之后各自打开数据库
+        DbExecutor dbExecutor(db); // HTTPS与明文服务器共用同一个数据库连接，也必须共用它的执行器
+        TlsSessionOptions tlsOptions = earlyDataOptions;
+        tlsOptions.ticketSecret = master.deriveKey("tls-ticket"); // 所有工作进程（以及升级后的新进程）互认会话票据
+        HttpServer<TlsTransport> server(port, 10, dbExecutor, "server.crt", "server.key", tlsOptions);
+        server.adoptListener(listeners[0]);
+        SessionOptions sessionOptions;
+        sessionOptions.secureCookie = true; // 会话Cookie只在HTTPS上发送
+        // 重启后恢复登录会话；会话只在创建它的工作进程中有效，多进程时每个进程一份快照
+        sessionOptions.snapshotPath = masterOptions.workers > 1 ? "sessions." + std::to_string(slot) + ".dat" : "sessions.dat";
+        server.setSessionOptions(sessionOptions);
+        if (const char* keys = getenv("AUTH_TOKEN_KEYS")) {
+            server.setTokenOptions(TokenOptions(), keys); // 例如 AUTH_TOKEN_KEYS="k2:新密钥,k1:旧密钥"
+        } else {
+            server.setTokenOptions(TokenOptions(), "master:" + master.deriveKey("auth-token")); // 所有工作进程互认令牌
+        }
+        OverloadOptions overload;
+        if (const char* budget = getenv("CONNECTION_MEMORY_BUDGET_MB")) {
+            overload.maxConnections = 1000000;
+            overload.memoryBudgetBytes = size_t(std::stoul(budget)) << 20; // 超出时关闭最久没有活动的空闲连接
+        }
+        if (const char* rate = getenv("RATE_LIMIT_PER_SECOND")) {
+            overload.ratePerSecond = std::stod(rate); // 每个客户端IP每秒的请求数，超出回复429
+            if (const char* burst = getenv("RATE_LIMIT_BURST")) overload.burst = std::stod(burst);
+        }
+        server.setOverloadOptions(overload);
+        if (const char* dir = getenv("UI_DIR")) {
+            server.setAssetDirectory(dir); // 开发时每次请求从磁盘读取页面，例如 UI_DIR=UI
+        }
+        ProcessMaster::onQuit([&server] { server.drain(); });
+        server.setupRoutes();
+
+        // 明文端口与HTTPS服务共用同一个进程和数据库，平滑退出时两者都处理完现有连接；没有配置明文端口时不创建
+        std::unique_ptr<HttpServer<PlainTransport> > plainServer;
+        std::thread plainThread;
+        if (plain_port) {
+            plainServer.reset(new HttpServer<PlainTransport>(plain_port, 10, dbExecutor));
+            plainServer->adoptListener(listeners[1]);
+            if (const char* dir = getenv("UI_DIR")) plainServer->setAssetDirectory(dir);
+            plainServer->setupRoutes();
+            HttpServer<PlainTransport>* plain = plainServer.get();
+            ProcessMaster::onQuit([plain] { plain->drain(); });
+            plainThread = std::thread([plain]() { plain->start(); });
+        }
+
+        server.start();
+        if (plainThread.joinable()) plainThread.join();
+        return 0;
+    });
+}
@@ -3,4 +3,6 @@
 # 启动 Nginx 服务
 nginx -g 'daemon off;' &
 
-
+# 启动应用程序（主进程 + WORKER_PROCESSES 个工作进程），exec 使其接收 docker stop 发出的 SIGQUIT 并平滑退出
+cd /usr/src/myapp
+exec ./myserver10 8080 8081
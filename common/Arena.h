@@ -0,0 +1,159 @@
+/*************************************************************************
+	> File Name: Arena.h
+	> Author:
+	> Mail:
+	> Created Time: Fri 23 Oct 2026 03:36:08 PM CST
+ ************************************************************************/
+
+// 请求级的单调内存池（std::pmr::memory_resource）：分配只移动指针，释放是空操作，
+// 请求处理完后 reset() 一次性回收。内存块在 reset 后保留复用，稳态下处理请求不再调用全局 malloc。
+// HttpRequest、HttpResponse 默认从 Arena::resource() 取内存：处于 Arena::Scope 之内时为当前线程的内存池，
+// 否则为全局堆。需要活得比请求更久的对象（响应缓存、HTTP/2流）必须显式使用堆
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <memory_resource>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+class Arena : public std::pmr::memory_resource {
+public:
+	// chunkSize 为每个内存块的大小；reset 时超过 maxRetained 的内存块归还给系统
+	explicit Arena(size_t chunkSize = 16384, size_t maxRetained = 1 << 20)
+		: chunkSize(chunkSize), maxRetained(maxRetained), head(nullptr), current(nullptr), cursor(nullptr), limit(nullptr) {}
+
+	~Arena() override {
+		release(head);
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// 回到第一个内存块的起点，之前分配的内存全部失效。内存块总量不超过 maxRetained 时为O(1)
+	void reset() {
+		if (retained > maxRetained && head) {
+			release(head->next); // 一次异常大的请求之后把多出来的内存块还回去
+			head->next = nullptr;
+			retained = head->size;
+		}
+		current = head;
+		cursor = head ? head->data() : nullptr;
+		limit = head ? head->data() + head->size : nullptr;
+		used = 0;
+	}
+
+	size_t bytesUsed() const { return used; }
+	size_t bytesRetained() const { return retained; }
+
+	// 当前线程的请求内存池，不在 Scope 之内时为全局堆
+	static std::pmr::memory_resource* resource() {
+		Arena* arena = active();
+		return arena ? static_cast<std::pmr::memory_resource*>(arena) : std::pmr::new_delete_resource();
+	}
+
+	// 在作用域内把 arena 设为当前线程的请求内存池，离开时 reset。
+	// resetOnExit 为false时保留其中的分配，用于跨越多次调度的请求（挂起的协程处理函数）
+	class Scope {
+	public:
+		explicit Scope(Arena& arena, bool resetOnExit = true) : arena(arena), previous(active()), resetOnExit(resetOnExit) {
+			active() = &arena;
+		}
+
+		~Scope() {
+			active() = previous;
+			if (resetOnExit) arena.reset();
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Arena& arena;
+		Arena* previous;
+		bool resetOnExit;
+	};
+
+	// 每个工作线程一个，处理完一个请求后整体回收
+	static Arena& forThisThread() {
+		thread_local Arena arena;
+		return arena;
+	}
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		char* p = align(cursor, alignment);
+		while (!p || p + bytes > limit) {
+			// 当前块放不下：复用后面保留的块，没有合适的块时新分配一个
+			Chunk* next = current ? current->next : head;
+			if (next && next->size >= bytes + alignment) {
+				current = next;
+			} else {
+				Chunk* chunk = allocateChunk(bytes + alignment > chunkSize ? bytes + alignment : chunkSize);
+				if (current) {
+					chunk->next = current->next;
+					current->next = chunk;
+				} else {
+					chunk->next = head;
+					head = chunk;
+				}
+				current = chunk;
+			}
+			cursor = current->data();
+			limit = cursor + current->size;
+			p = align(cursor, alignment);
+		}
+		cursor = p + bytes;
+		used += bytes;
+		return p;
+	}
+
+	void do_deallocate(void*, size_t, size_t) override {} // 在 reset 时统一回收
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+
+private:
+	struct Chunk {
+		Chunk* next;
+		size_t size;
+		char* data() { return reinterpret_cast<char*>(this + 1); }
+	};
+
+	size_t chunkSize, maxRetained;
+	size_t retained = 0, used = 0;
+	Chunk* head; // 内存块链表，reset 后从头复用
+	Chunk* current;
+	char* cursor; // 当前块中下一次分配的位置
+	char* limit;
+
+	static Arena*& active() {
+		thread_local Arena* arena = nullptr;
+		return arena;
+	}
+
+	static char* align(char* p, size_t alignment) {
+		if (!p) return nullptr;
+		uintptr_t value = reinterpret_cast<uintptr_t>(p);
+		return reinterpret_cast<char*>((value + alignment - 1) & ~(uintptr_t(alignment) - 1));
+	}
+
+	Chunk* allocateChunk(size_t size) {
+		Chunk* chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+		chunk->next = nullptr;
+		chunk->size = size;
+		retained += size;
+		return chunk;
+	}
+
+	static void release(Chunk* chunk) {
+		while (chunk) {
+			Chunk* next = chunk->next;
+			::operator delete(chunk);
+			chunk = next;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,243 @@
+/*************************************************************************
+	> File Name: AuthToken.h
+	> Author:
+	> Mail:
+	> Created Time: Thu 22 Oct 2026 05:40:12 PM CST
+ ************************************************************************/
+
+// 无状态的登录令牌：令牌中带有用户名、过期时间与签名密钥的ID，用HMAC-SHA256签名。
+// 校验只需要密钥，不查数据库也不查会话表，nginx之后的多个进程或主机配置相同的密钥即可互相认可对方签发的令牌。
+// 令牌格式：<密钥ID>.<过期时间(Unix秒)>.<base64url(用户名)>.<base64url(签名)>，签名覆盖前三段
+#ifndef _AUTHTOKEN_H
+#define _AUTHTOKEN_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include <strings.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/crypto.h>
+
+#include "Logger.h"
+
+// 令牌相关的配置
+struct TokenOptions {
+	std::chrono::seconds ttl{3600}; // 令牌有效期
+	std::string cookieName = "AUTHTOKEN"; // 除 Authorization: Bearer 外，也接受该Cookie中的令牌
+};
+
+class TokenSigner {
+public:
+	explicit TokenSigner(const TokenOptions& options = TokenOptions())
+		: options(options), keys(std::make_shared<const KeyRing>()) {}
+
+	TokenSigner(const TokenSigner&) = delete;
+	TokenSigner& operator=(const TokenSigner&) = delete;
+
+	void setOptions(const TokenOptions& o) {
+		options = o;
+	}
+
+	const TokenOptions& getOptions() const { return options; }
+
+	// 添加密钥；active 为true时之后签发的令牌改用该密钥。
+	// 轮换密钥时先添加新密钥并设为active，等旧令牌过期后再 removeKey 旧密钥
+	void addKey(const std::string& kid, const std::string& secret, bool active) {
+		if (kid.empty() || kid.find('.') != std::string::npos || secret.size() < 16) {
+			LOG_ERROR("Invalid token key '%s' (id must not contain '.', secret needs >= 16 bytes)", kid.c_str());
+			throw std::runtime_error("invalid token key");
+		}
+		std::lock_guard<std::mutex> lock(writeMutex);
+		std::shared_ptr<KeyRing> ring = std::make_shared<KeyRing>(*std::atomic_load(&keys));
+		for (auto it = ring->keys.begin(); it != ring->keys.end(); ++it) {
+			if (it->kid == kid) {
+				ring->keys.erase(it);
+				break;
+			}
+		}
+		ring->keys.push_back(Key{kid, secret});
+		if (active || ring->active.empty()) ring->active = kid;
+		std::atomic_store(&keys, std::shared_ptr<const KeyRing>(ring));
+	}
+
+	// 删除密钥，用它签名的令牌随即失效
+	void removeKey(const std::string& kid) {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		std::shared_ptr<KeyRing> ring = std::make_shared<KeyRing>(*std::atomic_load(&keys));
+		for (auto it = ring->keys.begin(); it != ring->keys.end(); ++it) {
+			if (it->kid == kid) {
+				ring->keys.erase(it);
+				break;
+			}
+		}
+		if (ring->active == kid) ring->active = ring->keys.empty() ? std::string() : ring->keys.back().kid;
+		std::atomic_store(&keys, std::shared_ptr<const KeyRing>(ring));
+	}
+
+	// 按 "kid:secret,kid:secret" 的格式加载密钥，第一个为签发用的密钥；返回加载的密钥数
+	size_t loadKeys(const std::string& spec) {
+		size_t count = 0, pos = 0;
+		while (pos < spec.size()) {
+			size_t end = spec.find(',', pos);
+			if (end == std::string::npos) end = spec.size();
+			std::string item = spec.substr(pos, end - pos);
+			size_t colon = item.find(':');
+			if (colon == std::string::npos) {
+				LOG_ERROR("Malformed token key entry (expected kid:secret)");
+				throw std::runtime_error("malformed token key");
+			}
+			addKey(item.substr(0, colon), item.substr(colon + 1), count == 0);
+			count++;
+			pos = end + 1;
+		}
+		return count;
+	}
+
+	// 还没有配置密钥时生成一个随机密钥，只有本进程能校验用它签发的令牌
+	void ensureKey() {
+		if (!std::atomic_load(&keys)->keys.empty()) return;
+		unsigned char secret[32];
+		if (RAND_bytes(secret, sizeof(secret)) != 1) {
+			LOG_ERROR("RAND_bytes failed");
+			throw std::runtime_error("RAND_bytes failed");
+		}
+		LOG_WARNING("No token keys configured, generated a process-local key");
+		addKey("local", std::string(reinterpret_cast<char*>(secret), sizeof(secret)), true);
+	}
+
+	bool enabled() const {
+		return !std::atomic_load(&keys)->active.empty();
+	}
+
+	// 用当前密钥为用户签发令牌
+	std::string mint(const std::string& user) const {
+		std::shared_ptr<const KeyRing> ring = std::atomic_load(&keys);
+		const Key* key = ring->find(ring->active);
+		if (!key) {
+			LOG_ERROR("No active token key");
+			throw std::runtime_error("no active token key");
+		}
+		long long expires = unixNow() + options.ttl.count();
+		std::string token = key->kid + "." + std::to_string(expires) + "." + base64UrlEncode(user);
+		return token + "." + base64UrlEncode(sign(*key, token));
+	}
+
+	// 校验令牌，通过时把用户名写入 user。签名用 CRYPTO_memcmp 做常数时间比较，
+	// 避免通过响应时间逐字节猜出签名
+	bool verify(const std::string& token, std::string& user) const {
+		size_t dot1 = token.find('.');
+		size_t dot2 = dot1 == std::string::npos ? dot1 : token.find('.', dot1 + 1);
+		size_t dot3 = dot2 == std::string::npos ? dot2 : token.find('.', dot2 + 1);
+		if (dot3 == std::string::npos) return false;
+
+		std::shared_ptr<const KeyRing> ring = std::atomic_load(&keys);
+		const Key* key = ring->find(token.substr(0, dot1));
+		if (!key) return false;
+
+		std::string expected = sign(*key, token.substr(0, dot3));
+		std::string signature;
+		if (!base64UrlDecode(token.substr(dot3 + 1), signature) || signature.size() != expected.size() ||
+			CRYPTO_memcmp(signature.data(), expected.data(), expected.size()) != 0) {
+			return false;
+		}
+		// 签名正确之后再解析其余字段
+		long long expires = 0;
+		for (size_t i = dot1 + 1; i < dot2; i++) {
+			if (token[i] < '0' || token[i] > '9') return false;
+			expires = expires * 10 + (token[i] - '0');
+		}
+		if (expires <= unixNow()) return false;
+		return base64UrlDecode(token.substr(dot2 + 1, dot3 - dot2 - 1), user);
+	}
+
+	// 从 Authorization: Bearer 头或令牌Cookie中取出令牌；没有时返回空字符串
+	template <class Request>
+	std::string extract(const Request& request) const {
+		std::string auth(request.getHeader("authorization"));
+		if (auth.size() > 7 && strncasecmp(auth.c_str(), "Bearer ", 7) == 0) return auth.substr(7);
+		return std::string(request.getCookie(options.cookieName));
+	}
+
+	static std::string base64UrlEncode(const std::string& data) {
+		static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		std::string out;
+		out.reserve((data.size() * 4 + 2) / 3);
+		uint32_t acc = 0;
+		int bits = 0;
+		for (unsigned char c : data) {
+			acc = (acc << 8) | c;
+			bits += 8;
+			while (bits >= 6) {
+				bits -= 6;
+				out += alphabet[(acc >> bits) & 0x3f];
+			}
+		}
+		if (bits > 0) out += alphabet[(acc << (6 - bits)) & 0x3f];
+		return out;
+	}
+
+	static bool base64UrlDecode(const std::string& text, std::string& out) {
+		out.clear();
+		uint32_t acc = 0;
+		int bits = 0;
+		for (char c : text) {
+			int value;
+			if (c >= 'A' && c <= 'Z') value = c - 'A';
+			else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+			else if (c >= '0' && c <= '9') value = c - '0' + 52;
+			else if (c == '-') value = 62;
+			else if (c == '_') value = 63;
+			else return false;
+			acc = (acc << 6) | value;
+			bits += 6;
+			if (bits >= 8) {
+				bits -= 8;
+				out += char((acc >> bits) & 0xff);
+			}
+		}
+		return true;
+	}
+
+private:
+	struct Key {
+		std::string kid, secret;
+	};
+
+	// 密钥集合只读，轮换时整体替换，校验时不需要加锁
+	struct KeyRing {
+		std::vector<Key> keys; // 同时有效的密钥很少，顺序查找即可
+		std::string active;
+
+		const Key* find(const std::string& kid) const {
+			for (const Key& key : keys) {
+				if (key.kid == kid) return &key;
+			}
+			return nullptr;
+		}
+	};
+
+	TokenOptions options;
+	std::shared_ptr<const KeyRing> keys; // 通过 std::atomic_load/atomic_store 访问
+	std::mutex writeMutex; // 串行化密钥的修改
+
+	static std::string sign(const Key& key, const std::string& data) {
+		unsigned char mac[EVP_MAX_MD_SIZE];
+		unsigned int length = 0;
+		HMAC(EVP_sha256(), key.secret.data(), int(key.secret.size()),
+			reinterpret_cast<const unsigned char*>(data.data()), data.size(), mac, &length);
+		return std::string(reinterpret_cast<char*>(mac), length);
+	}
+
+	static long long unixNow() {
+		return std::chrono::duration_cast<std::chrono::seconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+};
+
+#endif
@@ -0,0 +1,284 @@
+/*************************************************************************
+	> File Name: Buffer.h
+	> Author:
+	> Mail:
+	> Created Time: Sat 24 Oct 2026 09:47:15 AM CST
+ ************************************************************************/
+
+// 连接的读缓冲区：固定大小的内存块串成链表，请求体再大也只是多挂几个块，不需要整体搬移。
+// 内存块来自每个线程自己的空闲链表（BufferPool），取还都不加锁；
+// 数据处理完后内存块立即还回去，空闲的长连接不占用任何读缓冲区
+#ifndef _BUFFER_H
+#define _BUFFER_H
+
+#include <sys/uio.h>
+#include <string_view>
+#include <memory_resource>
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+class BufferPool {
+public:
+	static const size_t kChunkSize = 16384; // 与TLS记录的最大长度相同，一次SSL_read正好填满一块
+	static const size_t kMaxCached = 64; // 每个线程最多缓存的空闲块，超出的还给系统
+
+	struct Chunk {
+		Chunk* next;
+		uint32_t begin; // 未读数据的起点
+		uint32_t end; // 已写入数据的终点
+		char data[kChunkSize];
+	};
+
+	// 从当前线程的空闲链表取一块，没有时新分配
+	static Chunk* acquire() {
+		FreeList& list = local();
+		Chunk* chunk = list.head;
+		if (chunk) {
+			list.head = chunk->next;
+			list.count--;
+		} else {
+			chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk)));
+			allocated().fetch_add(1, std::memory_order_relaxed);
+		}
+		chunk->next = nullptr;
+		chunk->begin = chunk->end = 0;
+		return chunk;
+	}
+
+	// 还回当前线程的空闲链表（可以不是取出它的线程）
+	static void release(Chunk* chunk) {
+		FreeList& list = local();
+		if (list.count >= kMaxCached) {
+			destroy(chunk);
+			return ;
+		}
+		chunk->next = list.head;
+		list.head = chunk;
+		list.count++;
+	}
+
+	// 所有线程当前持有的内存块总数（使用中与空闲链表中的），用于 /metrics
+	static size_t chunksAllocated() {
+		return allocated().load(std::memory_order_relaxed);
+	}
+
+private:
+	struct FreeList {
+		Chunk* head = nullptr;
+		size_t count = 0;
+
+		~FreeList() {
+			while (head) {
+				Chunk* next = head->next;
+				destroy(head);
+				head = next;
+			}
+		}
+	};
+
+	static FreeList& local() {
+		thread_local FreeList list;
+		return list;
+	}
+
+	static std::atomic<size_t>& allocated() {
+		static std::atomic<size_t> count{0};
+		return count;
+	}
+
+	static void destroy(Chunk* chunk) {
+		::operator delete(chunk);
+		allocated().fetch_sub(1, std::memory_order_relaxed);
+	}
+};
+
+// 由内存块链表组成的字节队列：尾部写入（readv 或 append），头部读取（consume）
+class ChainBuffer {
+public:
+	using Chunk = BufferPool::Chunk;
+	static const size_t npos = size_t(-1);
+
+	ChainBuffer() = default;
+
+	~ChainBuffer() {
+		clear();
+	}
+
+	ChainBuffer(const ChainBuffer&) = delete;
+	ChainBuffer& operator=(const ChainBuffer&) = delete;
+
+	size_t size() const { return bytes; }
+	bool empty() const { return bytes == 0; }
+
+	// 持有的内存块占用的内存
+	size_t memoryUsage() const { return chunks * sizeof(Chunk); }
+
+	// 为一次 readv 准备最多 maxChunks 段可写区域：先用尾块剩下的空间，再从池中取新块；返回段数
+	int prepare(struct iovec* iov, int maxChunks) {
+		int count = 0;
+		if (tail && tail->end < BufferPool::kChunkSize) {
+			iov[count].iov_base = tail->data + tail->end;
+			iov[count].iov_len = BufferPool::kChunkSize - tail->end;
+			count++;
+		}
+		Chunk** slot = &reserve;
+		while (count < maxChunks) {
+			if (!*slot) *slot = BufferPool::acquire();
+			iov[count].iov_base = (*slot)->data;
+			iov[count].iov_len = BufferPool::kChunkSize;
+			count++;
+			slot = &(*slot)->next;
+		}
+		return count;
+	}
+
+	// 提交 readv 实际读到的 n 字节；没有用上的新块立即还回池中
+	void commit(size_t n) {
+		bytes += n;
+		if (tail) {
+			size_t room = BufferPool::kChunkSize - tail->end;
+			size_t take = n < room ? n : room;
+			tail->end += take;
+			n -= take;
+		}
+		while (n > 0 && reserve) {
+			Chunk* chunk = reserve;
+			reserve = chunk->next;
+			chunk->next = nullptr;
+			chunk->end = n < BufferPool::kChunkSize ? n : BufferPool::kChunkSize;
+			n -= chunk->end;
+			link(chunk);
+		}
+		releaseReserve();
+	}
+
+	void append(const char* data, size_t len) {
+		while (len > 0) {
+			if (!tail || tail->end == BufferPool::kChunkSize) link(BufferPool::acquire());
+			size_t take = BufferPool::kChunkSize - tail->end;
+			if (take > len) take = len;
+			memcpy(tail->data + tail->end, data, take);
+			tail->end += take;
+			bytes += take;
+			data += take;
+			len -= take;
+		}
+	}
+
+	// 丢弃开头的 n 字节，读完的块还回池中
+	void consume(size_t n) {
+		if (n > bytes) n = bytes;
+		bytes -= n;
+		while (n > 0) {
+			size_t available = head->end - head->begin;
+			if (n < available) {
+				head->begin += n;
+				return ;
+			}
+			n -= available;
+			popHead();
+		}
+		if (bytes == 0) clear();
+	}
+
+	// 清空并把所有块还回池中
+	void clear() {
+		while (head) popHead();
+		releaseReserve();
+		bytes = 0;
+	}
+
+	// 从 from 开始查找 pattern（可以跨越块的边界），没有时返回npos
+	size_t find(std::string_view pattern, size_t from = 0) const {
+		if (pattern.empty() || bytes < pattern.size()) return npos;
+		size_t offset = 0; // 当前块第一个字节在整个缓冲区中的位置
+		for (const Chunk* chunk = head; chunk; chunk = chunk->next) {
+			std::string_view segment(chunk->data + chunk->begin, chunk->end - chunk->begin);
+			size_t start = from > offset ? from - offset : 0;
+			for (size_t i = start; i < segment.size(); i++) {
+				i = segment.find(pattern[0], i);
+				if (i == std::string_view::npos) break;
+				if (matches(chunk, i, pattern)) return offset + i;
+			}
+			offset += segment.size();
+		}
+		return npos;
+	}
+
+	// 复制开头的 n 字节到 out
+	void copyTo(char* out, size_t n) const {
+		for (const Chunk* chunk = head; chunk && n > 0; chunk = chunk->next) {
+			size_t take = chunk->end - chunk->begin;
+			if (take > n) take = n;
+			memcpy(out, chunk->data + chunk->begin, take);
+			out += take;
+			n -= take;
+		}
+	}
+
+	// 开头 n 字节的连续视图：全部在第一个块中时直接指向块内，否则复制到 mr 中。
+	// 视图在下一次 consume/clear 之前有效
+	std::string_view contiguous(size_t n, std::pmr::memory_resource* mr) const {
+		if (n > bytes) n = bytes;
+		if (head && head->end - head->begin >= n) return std::string_view(head->data + head->begin, n);
+		char* out = static_cast<char*>(mr->allocate(n ? n : 1, 1));
+		copyTo(out, n);
+		return std::string_view(out, n);
+	}
+
+	// 依次访问每一段连续的数据：f(const char* data, size_t len)
+	template <class F>
+	void forEachSegment(F&& f) const {
+		for (const Chunk* chunk = head; chunk; chunk = chunk->next) {
+			if (chunk->end > chunk->begin) f(chunk->data + chunk->begin, size_t(chunk->end - chunk->begin));
+		}
+	}
+
+private:
+	Chunk* head = nullptr;
+	Chunk* tail = nullptr;
+	Chunk* reserve = nullptr; // prepare 取出、尚未提交的块
+	size_t bytes = 0;
+	size_t chunks = 0; // 链表中的块数
+
+	void link(Chunk* chunk) {
+		chunks++;
+		if (tail) tail->next = chunk;
+		else head = chunk;
+		tail = chunk;
+	}
+
+	void releaseReserve() {
+		while (reserve) {
+			Chunk* next = reserve->next;
+			BufferPool::release(reserve);
+			reserve = next;
+		}
+	}
+
+	void popHead() {
+		Chunk* chunk = head;
+		head = chunk->next;
+		if (!head) tail = nullptr;
+		chunks--;
+		BufferPool::release(chunk);
+	}
+
+	// 从 chunk 的第 i 个未读字节开始是否与 pattern 相同（可以延伸到后面的块）
+	static bool matches(const Chunk* chunk, size_t i, std::string_view pattern) {
+		size_t pos = chunk->begin + i;
+		for (char c : pattern) {
+			while (chunk && pos >= chunk->end) {
+				chunk = chunk->next;
+				pos = chunk ? chunk->begin : 0;
+			}
+			if (!chunk || chunk->data[pos] != c) return false;
+			pos++;
+		}
+		return true;
+	}
+};
+
+#endif
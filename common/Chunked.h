@@ -0,0 +1,144 @@
+/*************************************************************************
+	> File Name: Chunked.h
+	> Author:
+	> Mail:
+	> Created Time: Tue 27 Oct 2026 10:21:44 AM CST
+ ************************************************************************/
+
+// HTTP/1.1 的 chunked 传输编码：
+//   ChunkedDecoder  增量解码 chunked 请求体，数据分几次到达都可以，每次只处理新到的字节
+//   appendChunk     把一段响应体写成一个块追加到发送缓冲区，appendLastChunk 写出结束块
+#ifndef _CHUNKED_H
+#define _CHUNKED_H
+
+#include <string>
+#include <string_view>
+#include <cstdio>
+
+// 把 data 写成一个块（长度为0时不写，空块表示结束）
+inline void appendChunk(std::string& out, std::string_view data) {
+	if (data.empty()) return ;
+	char size[20];
+	out.append(size, snprintf(size, sizeof(size), "%zx\r\n", data.size()));
+	out += data;
+	out += "\r\n";
+}
+
+inline void appendLastChunk(std::string& out) {
+	out += "0\r\n\r\n";
+}
+
+// chunked 请求体的解码状态机。块扩展与尾部字段（trailers）被跳过，行尾必须是CRLF
+class ChunkedDecoder {
+public:
+	enum Status { NEED_MORE, DONE, BAD, TOO_LARGE };
+
+	// limit 为解码后请求体的上限，maxTrailer 为尾部字段的上限
+	ChunkedDecoder(size_t limit, size_t maxTrailer) : limit(limit), maxTrailer(maxTrailer) {}
+
+	// 解码 data 中的数据，解码出的请求体追加到 body；consumed 为用掉的字节数，
+	// 返回 DONE 时 data 中在此之后的数据属于下一个请求
+	Status feed(const char* data, size_t len, std::string& body, size_t& consumed) {
+		size_t i = 0;
+		while (i < len) {
+			char c = data[i];
+			switch (state) {
+				case SIZE:
+					if (hexValue(c) >= 0) {
+						if (size > (limit >> 4)) return finish(TOO_LARGE, i, consumed); // 一个块就超出上限，也避免溢出
+						size = (size << 4) | size_t(hexValue(c));
+						digits++;
+					} else if (digits > 0 && (c == ';' || c == ' ' || c == '\t')) {
+						state = EXTENSION;
+					} else if (digits > 0 && c == '\r') {
+						state = SIZE_LF;
+					} else {
+						return finish(BAD, i, consumed);
+					}
+					i++;
+					break;
+				case EXTENSION: // 块扩展：忽略到行尾
+					if (c == '\r') state = SIZE_LF;
+					else if (++trailerBytes > maxTrailer) return finish(BAD, i, consumed);
+					i++;
+					break;
+				case SIZE_LF:
+					if (c != '\n') return finish(BAD, i, consumed);
+					i++;
+					if (size == 0) {
+						state = TRAILER_START;
+					} else if (bodyBytes + size > limit) {
+						return finish(TOO_LARGE, i, consumed);
+					} else {
+						state = DATA;
+					}
+					break;
+				case DATA: {
+					size_t n = len - i < size ? len - i : size;
+					body.append(data + i, n);
+					bodyBytes += n;
+					i += n;
+					size -= n;
+					if (size == 0) state = DATA_CR;
+					break;
+				}
+				case DATA_CR:
+					if (c != '\r') return finish(BAD, i, consumed);
+					state = DATA_LF;
+					i++;
+					break;
+				case DATA_LF:
+					if (c != '\n') return finish(BAD, i, consumed);
+					state = SIZE;
+					digits = 0;
+					trailerBytes = 0;
+					i++;
+					break;
+				case TRAILER_START: // 空行结束请求，否则是一行尾部字段
+					state = c == '\r' ? FINAL_LF : TRAILER_LINE;
+					if (c != '\r') trailerBytes++;
+					i++;
+					break;
+				case TRAILER_LINE:
+					if (c == '\r') state = TRAILER_LF;
+					else if (++trailerBytes > maxTrailer) return finish(BAD, i, consumed);
+					i++;
+					break;
+				case TRAILER_LF:
+					if (c != '\n') return finish(BAD, i, consumed);
+					state = TRAILER_START;
+					i++;
+					break;
+				case FINAL_LF:
+					if (c != '\n') return finish(BAD, i, consumed);
+					return finish(DONE, i + 1, consumed);
+			}
+		}
+		consumed = i;
+		return NEED_MORE;
+	}
+
+private:
+	enum State { SIZE, EXTENSION, SIZE_LF, DATA, DATA_CR, DATA_LF, TRAILER_START, TRAILER_LINE, TRAILER_LF, FINAL_LF };
+
+	State state = SIZE;
+	size_t size = 0; // 当前块剩余的字节数
+	int digits = 0; // 块长度已读到的十六进制位数
+	size_t trailerBytes = 0; // 块扩展与尾部字段已读到的字节数
+	size_t bodyBytes = 0; // 已解码的请求体长度
+	size_t limit, maxTrailer;
+
+	static int hexValue(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+
+	static Status finish(Status status, size_t at, size_t& consumed) {
+		consumed = at;
+		return status;
+	}
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*************************************************************************
+	> File Name: Compression.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 26 Oct 2026 07:48:05 PM CST
+ ************************************************************************/
+
+// 响应压缩：按 Accept-Encoding 选择 gzip 或 deflate，用zlib即时压缩动态响应。
+// 每个工作线程为每种编码保留一个 z_stream，处理响应时 deflateReset 复用，不会为每个响应重新分配zlib的状态（约256KB）。
+// 只压缩不小于 minSize、Content-Type 在白名单中且没有 Content-Encoding 的响应（嵌入页面的预压缩版本优先）；
+// HTTP/1.1上大的响应体边压缩边以 chunked 编码写入发送缓冲区，不需要先得到完整的压缩结果
+#ifndef _COMPRESSION_H
+#define _COMPRESSION_H
+
+#include <zlib.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <ostream>
+
+#include "HttpResponse.h"
+#include "Chunked.h"
+#include "Logger.h"
+
+struct CompressionOptions {
+	int level = 6; // 路由没有单独指定时的压缩级别（1最快，9压缩率最高，0不压缩）
+	size_t minSize = 1024; // 更小的响应压缩后省不了几个字节，不压缩
+	size_t chunkedThreshold = 64 * 1024; // HTTP/1.1上不小于该大小的响应体以 chunked 编码边压缩边发送
+	std::vector<std::string> types = {"text/", "application/json", "application/javascript", "application/xml", "image/svg+xml"}; // Content-Type 前缀
+};
+
+class Compressor {
+public:
+	enum Encoding { IDENTITY, GZIP, DEFLATE };
+
+	struct Stats {
+		std::atomic<uint64_t> responses{0}; // 压缩过的响应数
+		std::atomic<uint64_t> bytesIn{0}, bytesOut{0}; // 压缩前后的字节数
+	};
+
+	// 按 Accept-Encoding 选择编码：q值高者优先，相同时优先gzip；q=0 表示不接受
+	static Encoding negotiate(std::string_view header) {
+		double gzip = 0, deflate = 0, any = -1;
+		size_t pos = 0;
+		while (pos < header.size()) {
+			size_t end = header.find(',', pos);
+			if (end == std::string_view::npos) end = header.size();
+			std::string_view item = header.substr(pos, end - pos);
+			pos = end + 1;
+			while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+			std::string_view coding = item.substr(0, item.find(';'));
+			while (!coding.empty() && coding.back() == ' ') coding.remove_suffix(1);
+			double q = 1;
+			size_t qpos = item.find("q=");
+			if (qpos != std::string_view::npos) q = strtod(std::string(item.substr(qpos + 2)).c_str(), nullptr);
+			if (coding == "gzip" || coding == "x-gzip") gzip = q;
+			else if (coding == "deflate") deflate = q;
+			else if (coding == "*") any = q;
+		}
+		if (any > 0) {
+			if (header.find("gzip") == std::string_view::npos) gzip = any;
+			if (header.find("deflate") == std::string_view::npos) deflate = any;
+		}
+		if (gzip > 0 && gzip >= deflate) return GZIP;
+		if (deflate > 0) return DEFLATE;
+		return IDENTITY;
+	}
+
+	// 响应是否值得压缩：成功响应（流式响应不压缩）、没有 Content-Encoding、类型在白名单中且足够大
+	static bool eligible(const HttpResponse& response, const CompressionOptions& options) {
+		if (response.getStatusCode() != 200 || response.isStreaming() || response.getBody().size() < options.minSize) return false;
+		if (!response.getHeader("Content-Encoding").empty()) return false;
+		std::string_view type = response.getHeader("Content-Type");
+		for (const std::string& prefix : options.types) {
+			if (type.compare(0, prefix.size(), prefix) == 0) return true;
+		}
+		return false;
+	}
+
+	static const char* name(Encoding encoding) {
+		return encoding == GZIP ? "gzip" : "deflate";
+	}
+
+	// 压缩整个响应体并设置 Content-Encoding（HTTP/2与较小的HTTP/1.1响应）
+	static void compressBody(HttpResponse& response, Encoding encoding, int level) {
+		z_stream* zs = stream(encoding).begin(level);
+		if (!zs) return ; // 无法初始化时原样发送
+		std::string& out = scratch();
+		out.clear();
+		deflateBody(zs, response.getBody(), [&out](const char* data, size_t len) { out.append(data, len); });
+		count(response.getBody().size(), out.size());
+		response.setBody(out);
+		response.setHeader("Content-Encoding", name(encoding));
+	}
+
+	// 把响应以 chunked 编码追加到 out：响应头之后每压缩出一段就写成一个块，压缩结果不经过额外的缓冲区
+	static void appendChunked(HttpResponse& response, Encoding encoding, int level, std::string& out) {
+		z_stream* zs = stream(encoding).begin(level);
+		if (!zs) {
+			response.appendTo(out);
+			return ;
+		}
+		response.setHeader("Content-Encoding", name(encoding));
+		response.appendHead(out, true);
+		size_t before = out.size();
+		deflateBody(zs, response.getBody(), [&out](const char* data, size_t len) {
+			appendChunk(out, std::string_view(data, len));
+		});
+		appendLastChunk(out);
+		count(response.getBody().size(), out.size() - before);
+	}
+
+	static void writeMetrics(std::ostream& out) {
+		out << "compression_responses_total " << stats().responses << "\n"
+			<< "compression_bytes_in_total " << stats().bytesIn << "\n"
+			<< "compression_bytes_out_total " << stats().bytesOut << "\n";
+	}
+
+private:
+	static const size_t kOutputChunk = 16384;
+
+	// 一个工作线程上某种编码的 z_stream，第一次使用时初始化，之后每个响应 deflateReset 复用
+	class Stream {
+	public:
+		explicit Stream(int windowBits) : windowBits(windowBits) {}
+
+		~Stream() {
+			if (initialized) deflateEnd(&zs);
+		}
+
+		z_stream* begin(int level) {
+			if (!initialized) {
+				zs = z_stream();
+				if (deflateInit2(&zs, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+					LOG_ERROR("deflateInit2 failed");
+					return nullptr;
+				}
+				initialized = true;
+			} else {
+				deflateReset(&zs);
+				if (level != currentLevel) deflateParams(&zs, level, Z_DEFAULT_STRATEGY); // 刚重置、没有待处理的输入
+			}
+			currentLevel = level;
+			return &zs;
+		}
+
+	private:
+		z_stream zs;
+		int windowBits;
+		int currentLevel = -1;
+		bool initialized = false;
+	};
+
+	static Stream& stream(Encoding encoding) {
+		thread_local Stream gzip(15 + 16); // gzip 格式
+		thread_local Stream deflate(15); // zlib 格式（HTTP中的 deflate）
+		return encoding == GZIP ? gzip : deflate;
+	}
+
+	static std::string& scratch() {
+		thread_local std::string buffer;
+		return buffer;
+	}
+
+	// 用已经重置的 zs 压缩 body，每得到一段输出调用 emit(data, len)
+	template <class Emit>
+	static void deflateBody(z_stream* zs, std::string_view body, Emit&& emit) {
+		char output[kOutputChunk];
+		zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+		zs->avail_in = uInt(body.size());
+		int status = Z_OK;
+		while (status != Z_STREAM_END) {
+			zs->next_out = reinterpret_cast<Bytef*>(output);
+			zs->avail_out = sizeof(output);
+			status = deflate(zs, Z_FINISH); // 输入已经完整，输出空间用完时返回 Z_OK，继续取下一段
+			size_t produced = sizeof(output) - zs->avail_out;
+			if (produced) emit(output, produced);
+			if (status != Z_OK && status != Z_STREAM_END) {
+				LOG_ERROR("deflate failed: %d", status);
+				break;
+			}
+		}
+	}
+
+	static void count(size_t in, size_t out) {
+		stats().responses++;
+		stats().bytesIn += in;
+		stats().bytesOut += out;
+	}
+
+	static Stats& stats() {
+		static Stats instance;
+		return instance;
+	}
+};
+
+#endif
@@ -0,0 +1,351 @@
+/*************************************************************************
+	> File Name: Coroutine.h
+	> Author:
+	> Mail:
+	> Created Time: Sun 25 Oct 2026 03:42:51 PM CST
+ ************************************************************************/
+
+// 协程处理函数（C++20）：处理函数返回 Task<HttpResponse>，其中 co_await 数据库、哈希等阻塞操作或定时器时协程挂起，
+// 当前工作线程立即去处理其他连接；操作完成后通过 Resumer 把恢复请求交回连接所在的事件循环，
+// 由事件循环重新调度该连接，在工作线程中继续执行协程。少量工作线程即可同时挂起成千上万个请求。
+//   Task<T>         惰性启动的协程，可以在另一个 Task 中 co_await，结果或异常传回等待者
+//   blocking(f)     在专用的阻塞线程池中执行 f()，完成后恢复协程，返回 f() 的结果
+//   sleepFor(d)     挂起 d 之后恢复
+//   syncWait(task)  在当前线程中运行 task 直到完成（HTTP/2、0-RTT等无法挂起的路径使用）
+//   Generator<T>    co_yield 逐个产生值的同步生成器（流式响应体）
+#ifndef _COROUTINE_H
+#define _COROUTINE_H
+
+#include <coroutine>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <string>
+
+#include "ThreadPool.h"
+
+// 恢复挂起的协程：由协程的最外层 Task 指定，co_await 的操作完成后调用 post（可能在任意线程），
+// 实现者决定在哪个线程、什么时候 resume
+class Resumer {
+public:
+	virtual void post(std::coroutine_handle<> handle) = 0;
+
+protected:
+	~Resumer() = default;
+};
+
+template <class T>
+class Task {
+public:
+	struct promise_type {
+		std::optional<T> value;
+		std::exception_ptr error;
+		std::coroutine_handle<> continuation; // co_await 该 Task 的协程，完成后转去执行它
+		Resumer* resumer = nullptr; // 由最外层 Task 传给内层
+
+		Task get_return_object() {
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		struct FinalAwaiter {
+			bool await_ready() noexcept { return false; }
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+				std::coroutine_handle<> next = handle.promise().continuation;
+				return next ? next : std::noop_coroutine(); // 对称转移，嵌套再深也不会增长调用栈
+			}
+			void await_resume() noexcept {}
+		};
+
+		FinalAwaiter final_suspend() noexcept { return {}; }
+
+		template <class U>
+		void return_value(U&& result) {
+			value.emplace(std::forward<U>(result));
+		}
+
+		void unhandled_exception() {
+			error = std::current_exception();
+		}
+	};
+
+	Task() = default;
+
+	Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+	Task& operator=(Task&& other) noexcept {
+		if (this != &other) {
+			if (handle) handle.destroy();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+
+	~Task() {
+		if (handle) handle.destroy();
+	}
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	// 最外层 Task：指定恢复方式并开始执行，直到第一次挂起或完成
+	void start(Resumer* resumer) {
+		handle.promise().resumer = resumer;
+		handle.resume();
+	}
+
+	bool done() const { return !handle || handle.done(); }
+
+	// 完成后取出结果，协程中抛出的异常在这里重新抛出
+	T result() {
+		if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+		return std::move(*handle.promise().value);
+	}
+
+	// 在另一个协程中 co_await：内层 Task 继承外层的 Resumer，完成后直接转回外层
+	bool await_ready() const noexcept { return false; }
+
+	template <class Promise>
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) noexcept {
+		handle.promise().continuation = parent;
+		handle.promise().resumer = parent.promise().resumer;
+		return handle;
+	}
+
+	T await_resume() { return result(); }
+
+private:
+	explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+// 同步的生成器：co_yield 逐个产生值，调用方每次取一个时才继续执行，用作流式响应体的产生器：
+//   response.setStream([](int n) -> Generator<std::string> { for (int i = 0; i < n; i++) co_yield row(i); }(n));
+// 生成器中不能 co_await，产生数据期间占用当前工作线程
+template <class T>
+class Generator {
+public:
+	struct promise_type {
+		std::optional<T> current;
+		std::exception_ptr error;
+
+		Generator get_return_object() {
+			return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		template <class U>
+		std::suspend_always yield_value(U&& value) {
+			current.emplace(std::forward<U>(value));
+			return {};
+		}
+
+		void return_void() {}
+
+		void unhandled_exception() {
+			error = std::current_exception();
+		}
+	};
+
+	Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+	~Generator() {
+		if (handle) handle.destroy();
+	}
+
+	Generator(const Generator&) = delete;
+	Generator& operator=(const Generator&) = delete;
+
+	// 取下一个值；生成器已经结束时返回false，其中抛出的异常在这里重新抛出
+	bool next() {
+		if (!handle || handle.done()) return false;
+		handle.promise().current.reset();
+		handle.resume();
+		if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+		return !handle.done();
+	}
+
+	T& value() {
+		return *handle.promise().current;
+	}
+
+	// 作为 HttpResponse::BodyProducer：把下一个值追加到 chunk
+	bool operator()(std::string& chunk) {
+		if (!next()) return false;
+		chunk += value();
+		return true;
+	}
+
+private:
+	explicit Generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+// 阻塞操作专用的线程池：阻塞在SQLite、哈希上的是这里的线程，处理连接的工作线程不受影响
+inline ThreadPool& blockingPool() {
+	static ThreadPool pool(4);
+	return pool;
+}
+
+// co_await blocking(f)：f() 在阻塞线程池中执行，完成后经 Resumer 恢复协程
+template <class F>
+class BlockingAwaiter {
+public:
+	using Result = std::invoke_result_t<F>;
+
+	explicit BlockingAwaiter(F f) : f(std::move(f)) {}
+
+	bool await_ready() const noexcept { return false; }
+
+	template <class Promise>
+	void await_suspend(std::coroutine_handle<Promise> handle) {
+		Resumer* resumer = handle.promise().resumer;
+		blockingPool().post([this, handle, resumer]() {
+			try {
+				if constexpr (std::is_void_v<Result>) f();
+				else value.emplace(f());
+			} catch (...) {
+				error = std::current_exception();
+			}
+			resumer->post(handle); // 之后协程可能随时恢复并销毁本对象，不能再访问成员
+		});
+	}
+
+	Result await_resume() {
+		if (error) std::rethrow_exception(error);
+		if constexpr (!std::is_void_v<Result>) return std::move(*value);
+	}
+
+private:
+	F f;
+	std::conditional_t<std::is_void_v<Result>, std::optional<bool>, std::optional<Result> > value;
+	std::exception_ptr error;
+};
+
+template <class F>
+BlockingAwaiter<std::decay_t<F> > blocking(F&& f) {
+	return BlockingAwaiter<std::decay_t<F> >(std::forward<F>(f));
+}
+
+// sleepFor 使用的定时线程：按到期时间排序，到期后经 Resumer 恢复协程
+class CoroutineTimer {
+public:
+	static CoroutineTimer& instance() {
+		static CoroutineTimer timer;
+		return timer;
+	}
+
+	void add(std::chrono::steady_clock::time_point when, Resumer* resumer, std::coroutine_handle<> handle) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pending.emplace(when, std::make_pair(resumer, handle));
+		}
+		condition.notify_one();
+	}
+
+	~CoroutineTimer() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_one();
+		thread.join();
+	}
+
+private:
+	std::multimap<std::chrono::steady_clock::time_point, std::pair<Resumer*, std::coroutine_handle<> > > pending;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stop = false;
+	std::thread thread;
+
+	CoroutineTimer() : thread([this] { run(); }) {}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stop) {
+			if (pending.empty()) {
+				condition.wait(lock);
+				continue;
+			}
+			auto first = pending.begin();
+			if (condition.wait_until(lock, first->first) == std::cv_status::no_timeout) continue; // 有新的定时
+			std::vector<std::pair<Resumer*, std::coroutine_handle<> > > due;
+			auto now = std::chrono::steady_clock::now();
+			while (!pending.empty() && pending.begin()->first <= now) {
+				due.push_back(pending.begin()->second);
+				pending.erase(pending.begin());
+			}
+			lock.unlock();
+			for (auto& entry : due) entry.first->post(entry.second);
+			lock.lock();
+		}
+	}
+};
+
+// co_await sleepFor(d)：挂起 d 之后恢复
+class SleepAwaiter {
+public:
+	explicit SleepAwaiter(std::chrono::steady_clock::duration duration) : duration(duration) {}
+
+	bool await_ready() const noexcept { return duration.count() <= 0; }
+
+	template <class Promise>
+	void await_suspend(std::coroutine_handle<Promise> handle) {
+		CoroutineTimer::instance().add(std::chrono::steady_clock::now() + duration, handle.promise().resumer, handle);
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+	std::chrono::steady_clock::duration duration;
+};
+
+inline SleepAwaiter sleepFor(std::chrono::steady_clock::duration duration) {
+	return SleepAwaiter(duration);
+}
+
+// 在当前线程中运行 task 直到完成：挂起期间阻塞等待，恢复请求到达后在当前线程中继续执行
+template <class T>
+T syncWait(Task<T> task) {
+	class SyncResumer : public Resumer {
+	public:
+		void post(std::coroutine_handle<> handle) override {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				ready = handle;
+			}
+			condition.notify_one();
+		}
+
+		std::coroutine_handle<> wait() {
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this] { return bool(ready); });
+			return std::exchange(ready, nullptr);
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::coroutine_handle<> ready;
+	} resumer;
+
+	task.start(&resumer);
+	while (!task.done()) resumer.wait().resume();
+	return task.result();
+}
+
+#endif
@@ -3,9 +3,11 @@
 
 #include <sqlite3.h>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <mutex>
 #include "Logger.h"
+#include "Probes.h"
 class Database {
 private:
     sqlite3* db;
@@ -33,42 +35,71 @@ public:
         sqlite3_close(db);
     }
 
+    // 事务：DbExecutor 把排队中的多个读请求合并到一个读事务中执行，读到同一个快照。
+    // 锁只保护单条语句，事务期间不能有其他线程使用同一个连接，所以每个 Database 只能有一个 DbExecutor
+    bool begin() {
+        return exec("BEGIN;");
+    }
+
+    bool commit() {
+        return exec("COMMIT;");
+    }
+
+    bool exec(const char* sql) {
+        std::lock_guard<std::mutex> guard(dbMutex);
+        PROBE1(query_start, sql);
+        char* errmsg = nullptr;
+        if (sqlite3_exec(db, sql, 0, 0, &errmsg) != SQLITE_OK) {
+            PROBE2(query_done, sql, 0);
+            LOG_ERROR("SQL '%s' failed: %s", sql, errmsg ? errmsg : "unknown error");
+            sqlite3_free(errmsg);
+            return false;
+        }
+        PROBE2(query_done, sql, 1);
+        return true;
+    }
+
     //用户注册函数
-    bool registerUser(const std::string& username, const std::string& password) {
+    bool registerUser(std::string_view username, std::string_view password) {
         std::lock_guard<std::mutex> guard(dbMutex); // 锁定互斥锁
-        std::string sql = "INSERT INTO users (username, password) VALUES (?, ?);";
+        const char* sql = "INSERT INTO users (username, password) VALUES (?, ?);";
+        PROBE1(query_start, sql);
         sqlite3_stmt* stmt;
-        DBG(YELLOW "registing: username: %s, password: %s" NONE"\n", username.c_str(), password.c_str());
+        DBG(YELLOW "registing: username: %.*s, password: %.*s" NONE"\n", int(username.size()), username.data(), int(password.size()), password.data());
 
         //准备SQL语句
 
         int ret;
-        if (ret = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) { ////
-            LOG_INFO("Error %d: Failed to prepare registration SQL for user: %s", ret, username.c_str()); // 记录日志
+        if (ret = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) { ////
+            LOG_INFO("Error %d: Failed to prepare registration SQL for user: %.*s", ret, int(username.size()), username.data()); // 记录日志
+            PROBE2(query_done, sql, 0);
             return false;
         }
 
         //绑定参数
-        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, password.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 1, username.data(), int(username.size()), SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, password.data(), int(password.size()), SQLITE_STATIC);
 
         //执行SQL语句
         if (ret = sqlite3_step(stmt) != SQLITE_DONE) {
-            LOG_INFO("error %d: Registration failed for user: %s", ret, username.c_str()); 
+            LOG_INFO("error %d: Registration failed for user: %.*s", ret, int(username.size()), username.data()); 
             sqlite3_finalize(stmt);
+            PROBE2(query_done, sql, 0);
             return false;
         }
 
         //完成操作，关闭语句
         sqlite3_finalize(stmt);
-        LOG_INFO("User registered: %s with password: %s", username.c_str(), password.c_str());
+        PROBE2(query_done, sql, 1);
+        LOG_INFO("User registered: %.*s with password: %.*s", int(username.size()), username.data(), int(password.size()), password.data());
         return true;
     }
 
     // 用户登录函数
-    bool loginUser(const std::string& username, const std::string& password) {
+    bool loginUser(std::string_view username, std::string_view password) {
         std::lock_guard<std::mutex> guard(dbMutex); // 锁定互斥锁
-        std::string sql = "SELECT password FROM users WHERE username = ?;";
+        const char* sql = "SELECT password FROM users WHERE username = ?;";
+        PROBE1(query_start, sql);
         sqlite3_stmt* stmt;
         int ret;
 
@@ -81,8 +112,9 @@ public:
         //sqlite3_stmt **ppStmt,  /* OUT: Statement handle */ //输出参数，将指向新创建的预编译语句对象
         //const char **pzTail     /* OUT: Pointer to unused portion of zSql */ //可选输出参数，指向未被编译的部分（同窗在处理多条SQL时有用）
         //);
-        if (ret = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-            LOG_INFO("Error %d: Failed to prepare login SQL for user: %s", ret, username.c_str());
+        if (ret = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            LOG_INFO("Error %d: Failed to prepare login SQL for user: %.*s", ret, int(username.size()), username.data());
+            PROBE2(query_done, sql, 0);
             return false;
         }
 
@@ -92,7 +124,7 @@ public:
         //    const char* value,
         //    int n,
         //    void(*destroy)(void*)); /*或使用 SQLITE_TRANSIENT */
-        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 1, username.data(), int(username.size()), SQLITE_STATIC);
 
         //执行SQL语句
         //功能：执行预编译的 SQL 语句（prepared statement）。它会推进到下一个结果行或者直到整个查询完成。
@@ -101,8 +133,9 @@ public:
         //返回值：在处理 SELECT 查询时，如果还有更多的数据行可读取，将返回 SQLITE_ROW；
         //当查询完全执行完毕且没有错误时，返回 SQLITE_DONE。
         if (ret = sqlite3_step(stmt) != SQLITE_ROW) {
-            LOG_INFO("error %d: User not found: %s", ret, username.c_str());
+            LOG_INFO("error %d: User not found: %.*s", ret, int(username.size()), username.data());
             sqlite3_finalize(stmt);
+            PROBE2(query_done, sql, 0);
             return false;
         }
 
@@ -122,13 +155,14 @@ public:
         //用法：在完成所有查询执行并不再需要预编译的SQL语句时，应该调用 sqlite3_finalize 函数，传入预编译语句句柄作为参数。
         //这样可以释放与该句柄相关的资源防止内存泄漏
         sqlite3_finalize(stmt);
+        PROBE2(query_done, sql, 1);
         if (stored_password == nullptr || password != password_str) {
-            LOG_INFO("Login failed for user: %s password: %s stored password is %s", username.c_str(), password.c_str(), password_str.c_str());
+            LOG_INFO("Login failed for user: %.*s password: %.*s stored password is %s", int(username.size()), username.data(), int(password.size()), password.data(), password_str.c_str());
             return false;
         }
 
         //登录成功，记录日志
-        LOG_INFO("User logged in: %s", username.c_str());
+        LOG_INFO("User logged in: %.*s", int(username.size()), username.data());
         return true;
     }
 };
@@ -0,0 +1,238 @@
+/*************************************************************************
+	> File Name: DbExecutor.h
+	> Author:
+	> Mail:
+	> Created Time: Sun 25 Oct 2026 08:17:36 PM CST
+ ************************************************************************/
+
+// 数据库执行器：所有SQLite调用都在一个专用线程中执行，有自己的提交队列。
+// 协程处理函数中 co_await executor.read(f) / write(f) 提交后挂起，执行完成后经 Resumer 通知发起请求的事件循环
+// （HttpServer 的 eventfd），由事件循环重新调度连接继续执行，处理连接的线程从不阻塞在SQLite上。
+//   - 连续排队的读请求合并到一个读事务中执行（最多 maxBatch 个），读到同一个快照、只提交一次。
+//     事务属于整个SQLite连接而 Database 只在每条语句上加锁，因此一个 Database 只能有一个执行器：
+//     同一进程中的多个服务器共用一个执行器（见 HttpServer 以 DbExecutor& 为参数的构造函数）
+//   - 写请求逐个在自动提交模式下执行，与读请求保持提交顺序
+//   - 队列有上限：满时 co_await 立即抛出 DbExecutor::Overloaded（返回503），排队时延不会无限增长
+//   - 队列深度、排队时延与执行时间通过 writeMetrics 导出；被追踪的请求记录 db.queue 与 db.read/db.write 两段（见 Trace.h）
+#ifndef _DB_EXECUTOR_H
+#define _DB_EXECUTOR_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <ostream>
+
+#include "Database.h"
+#include "Coroutine.h"
+#include "Logger.h"
+#include "Trace.h"
+
+struct DbExecutorOptions {
+	size_t queueCapacity = 1024; // 排队中的请求上限
+	size_t maxBatch = 64; // 一个读事务中最多合并的读请求数
+};
+
+class DbExecutor {
+public:
+	// 提交队列已满
+	class Overloaded : public std::runtime_error {
+	public:
+		Overloaded() : std::runtime_error("database queue full") {}
+	};
+
+	explicit DbExecutor(Database& db, const DbExecutorOptions& options = DbExecutorOptions())
+		: db(db), options(options), thread([this] { run(); }) {}
+
+	// 执行完已经排队的请求后退出
+	~DbExecutor() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_one();
+		thread.join();
+	}
+
+	DbExecutor(const DbExecutor&) = delete;
+	DbExecutor& operator=(const DbExecutor&) = delete;
+
+	Database& getDatabase() {
+		return db;
+	}
+
+	void setOptions(const DbExecutorOptions& options) {
+		std::lock_guard<std::mutex> lock(mutex);
+		this->options = options;
+	}
+
+	// co_await read(f)：f(Database&) 在执行器线程中执行（可能与其他读请求合并到一个事务中），返回 f 的结果
+	template <class F>
+	auto read(F&& f) {
+		return Awaiter<std::decay_t<F> >(*this, false, std::forward<F>(f));
+	}
+
+	// co_await write(f)：f(Database&) 在执行器线程中单独执行
+	template <class F>
+	auto write(F&& f) {
+		return Awaiter<std::decay_t<F> >(*this, true, std::forward<F>(f));
+	}
+
+	void writeMetrics(std::ostream& out) const {
+		size_t capacity;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			capacity = options.queueCapacity;
+		}
+		uint64_t completed = stats.completed.load();
+		out << "db_queue_depth " << stats.depth << "\n"
+			<< "db_queue_depth_max " << stats.maxDepth << "\n"
+			<< "db_queue_capacity " << capacity << "\n"
+			<< "db_requests_total " << completed << "\n"
+			<< "db_requests_rejected_total " << stats.rejected << "\n"
+			<< "db_read_batches_total " << stats.batches << "\n"
+			<< "db_reads_batched_total " << stats.batchedReads << "\n"
+			<< "db_queue_wait_us_avg " << (completed ? stats.waitMicros / completed : 0) << "\n"
+			<< "db_service_us_avg " << (completed ? stats.serviceMicros / completed : 0) << "\n";
+	}
+
+private:
+	struct Job {
+		bool write;
+		std::function<void(Database&)> run; // 执行并保存结果，然后恢复协程
+		std::chrono::steady_clock::time_point queuedAt;
+		uint64_t trace; // 提交时正在追踪的请求
+	};
+
+	struct Stats {
+		std::atomic<uint64_t> depth{0}, maxDepth{0}; // 当前、历史最大排队数
+		std::atomic<uint64_t> completed{0}, rejected{0};
+		std::atomic<uint64_t> batches{0}, batchedReads{0}; // 合并执行的读事务数及其中的读请求数
+		std::atomic<uint64_t> waitMicros{0}, serviceMicros{0}; // 累计排队时延与执行时间
+	};
+
+	template <class F>
+	class Awaiter {
+	public:
+		using Result = std::invoke_result_t<F, Database&>;
+
+		Awaiter(DbExecutor& executor, bool write, F f) : executor(executor), write(write), f(std::move(f)) {}
+
+		bool await_ready() const noexcept { return false; }
+
+		// 队列已满时不挂起，await_resume 中抛出 Overloaded
+		template <class Promise>
+		bool await_suspend(std::coroutine_handle<Promise> handle) {
+			Resumer* resumer = handle.promise().resumer;
+			overloaded = !executor.submit(write, [this, handle, resumer](Database& db) {
+				try {
+					if constexpr (std::is_void_v<Result>) f(db);
+					else value.emplace(f(db));
+				} catch (...) {
+					error = std::current_exception();
+				}
+				resumer->post(handle); // 之后协程可能随时恢复并销毁本对象，不能再访问成员
+			});
+			return !overloaded;
+		}
+
+		Result await_resume() {
+			if (overloaded) throw Overloaded();
+			if (error) std::rethrow_exception(error);
+			if constexpr (!std::is_void_v<Result>) return std::move(*value);
+		}
+
+	private:
+		DbExecutor& executor;
+		bool write;
+		bool overloaded = false;
+		F f;
+		std::conditional_t<std::is_void_v<Result>, std::optional<bool>, std::optional<Result> > value;
+		std::exception_ptr error;
+	};
+
+	Database& db;
+	DbExecutorOptions options;
+	std::deque<Job> queue;
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	bool stop = false;
+	Stats stats;
+	std::thread thread; // 最后声明，启动时其他成员都已初始化
+
+	bool submit(bool write, std::function<void(Database&)> run) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (queue.size() >= options.queueCapacity) {
+				stats.rejected++;
+				return false;
+			}
+			queue.push_back(Job{write, std::move(run), std::chrono::steady_clock::now(), Tracer::current()});
+			uint64_t depth = queue.size();
+			stats.depth = depth;
+			if (depth > stats.maxDepth) stats.maxDepth = depth;
+		}
+		condition.notify_one();
+		return true;
+	}
+
+	void run() {
+		std::vector<Job> batch;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this] { return stop || !queue.empty(); });
+				if (queue.empty()) return; // stop 且队列已空
+				// 队首是写请求时单独执行；否则取出队首连续的读请求（遇到写请求为止），保持提交顺序
+				if (queue.front().write) {
+					batch.push_back(std::move(queue.front()));
+					queue.pop_front();
+				} else {
+					while (!queue.empty() && !queue.front().write && batch.size() < options.maxBatch) {
+						batch.push_back(std::move(queue.front()));
+						queue.pop_front();
+					}
+				}
+				stats.depth = queue.size();
+			}
+			execute(batch);
+			batch.clear();
+		}
+	}
+
+	void execute(std::vector<Job>& batch) {
+		auto start = std::chrono::steady_clock::now();
+		uint64_t wait = 0;
+		for (const Job& job : batch) {
+			wait += std::chrono::duration_cast<std::chrono::microseconds>(start - job.queuedAt).count();
+		}
+		bool shared = batch.size() > 1 && db.begin(); // 开启事务失败时逐个在自动提交模式下执行
+		for (Job& job : batch) {
+			uint64_t begin = job.trace ? Tracer::now() : 0;
+			job.run(db);
+			if (job.trace) {
+				Tracer::record("db.queue", Tracer::toNanos(job.queuedAt), Tracer::toNanos(start), std::string_view(), job.trace);
+				Tracer::record(job.write ? "db.write" : "db.read", begin, Tracer::now(), shared ? "batched" : "", job.trace);
+			}
+		}
+		if (shared && !db.commit()) LOG_ERROR("Failed to commit batch of %zu reads", batch.size());
+		uint64_t service = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		if (shared) {
+			stats.batches++;
+			stats.batchedReads += batch.size();
+		}
+		stats.waitMicros += wait;
+		stats.serviceMicros += service; // 合并执行的读请求按整批的执行时间摊分
+		stats.completed += batch.size();
+	}
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*************************************************************************
+	> File Name: FormData.h
+	> Author:
+	> Mail:
+	> Created Time: Fri 23 Oct 2026 10:12:53 AM CST
+ ************************************************************************/
+
+// application/x-www-form-urlencoded 与查询字符串的解码。
+// FormParser 按顺序逐个返回键值对的 string_view，不复制也不建哈希表；
+// 只有含 %XX 或 + 的字段才需要解码，解码结果写入调用方提供的内存池（通常是栈上的缓冲区）
+#ifndef _FORMDATA_H
+#define _FORMDATA_H
+
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <cstring>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+class UrlDecoder {
+public:
+	// 返回第一个 '%' 或 '+' 的位置，没有时返回 len。表单字段大多不含转义，整段扫描一遍即可直接返回原文
+	static size_t findEscape(const char* data, size_t len) {
+		size_t i = 0;
+#if defined(__SSE2__)
+		const __m128i percent = _mm_set1_epi8('%');
+		const __m128i plus = _mm_set1_epi8('+');
+		for (; i + 16 <= len; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, percent), _mm_cmpeq_epi8(v, plus)));
+			if (mask != 0) return i + __builtin_ctz(mask);
+		}
+#endif
+		for (; i < len; ++i) {
+			if (data[i] == '%' || data[i] == '+') return i;
+		}
+		return len;
+	}
+
+	// 解码到 out（至少 len 字节），返回解码后的长度；非法的 %XX 原样保留
+	static size_t decode(const char* data, size_t len, char* out) {
+		size_t n = 0;
+		size_t i = 0;
+		while (i < len) {
+			size_t next = findEscape(data + i, len - i); // 两个转义之间的普通字符整段复制
+			memcpy(out + n, data + i, next);
+			n += next;
+			i += next;
+			if (i >= len) break;
+			int hi, lo;
+			if (data[i] == '+') {
+				out[n++] = ' ';
+				i++;
+			} else if (i + 2 < len && (hi = hexValue(data[i + 1])) >= 0 && (lo = hexValue(data[i + 2])) >= 0) {
+				out[n++] = char(hi << 4 | lo);
+				i += 3;
+			} else {
+				out[n++] = data[i++];
+			}
+		}
+		return n;
+	}
+
+	// 不含转义时直接返回原文；否则解码到 arena 中
+	static std::string_view decode(std::string_view text, std::pmr::memory_resource* arena) {
+		size_t pos = findEscape(text.data(), text.size());
+		if (pos == text.size()) return text;
+		char* out = static_cast<char*>(arena->allocate(text.size(), 1));
+		memcpy(out, text.data(), pos);
+		size_t n = pos + decode(text.data() + pos, text.size() - pos, out + pos);
+		return std::string_view(out, n);
+	}
+
+	static std::string decode(std::string_view text) {
+		std::string out(text.size(), '\0');
+		out.resize(decode(text.data(), text.size(), &out[0]));
+		return out;
+	}
+
+private:
+	static int hexValue(char c) {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+};
+
+// 逐个返回 "k=v&k=v" 中的键值对：
+//     char scratch[256];
+//     std::pmr::monotonic_buffer_resource arena(scratch, sizeof(scratch));
+//     FormParser form(req.getBody(), &arena);
+//     std::string_view key, value;
+//     while (form.next(key, value)) { ... }
+// 返回的 string_view 指向原文或 arena，在两者销毁之前有效
+class FormParser {
+public:
+	FormParser(std::string_view text, std::pmr::memory_resource* arena) : text(text), arena(arena) {}
+
+	bool next(std::string_view& key, std::string_view& value) {
+		while (!text.empty()) {
+			size_t amp = text.find('&');
+			std::string_view pair = text.substr(0, amp);
+			text = amp == std::string_view::npos ? std::string_view() : text.substr(amp + 1);
+			if (pair.empty()) continue;
+			size_t eq = pair.find('=');
+			key = UrlDecoder::decode(pair.substr(0, eq), arena);
+			value = eq == std::string_view::npos ? std::string_view() : UrlDecoder::decode(pair.substr(eq + 1), arena);
+			return true;
+		}
+		return false;
+	}
+
+	// 按名称取出若干字段：fields 中每一项为 {名称, 输出}，同名字段出现多次时取第一个
+	struct Field {
+		std::string_view name;
+		std::string_view* value;
+	};
+
+	template <size_t N>
+	void extract(const Field (&fields)[N]) {
+		std::string_view key, value;
+		bool found[N] = {};
+		while (next(key, value)) {
+			for (size_t i = 0; i < N; i++) {
+				if (!found[i] && key == fields[i].name) {
+					*fields[i].value = value;
+					found[i] = true;
+				}
+			}
+		}
+	}
+
+private:
+	std::string_view text; // 尚未解析的部分
+	std::pmr::memory_resource* arena;
+};
+
+#endif
@@ -0,0 +1,457 @@
+/*************************************************************************
+	> File Name: Hpack.h
+	> Author:
+	> Mail:
+	> Created Time: Tue 20 Oct 2026 03:16:52 PM CST
+ ************************************************************************/
+
+// HPACK（RFC 7541）：HTTP/2 的头部压缩，包括静态表、动态表、整数/字符串编码与静态Huffman编码
+#ifndef _HPACK_H
+#define _HPACK_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <cstdint>
+
+typedef std::vector<std::pair<std::string, std::string> > HeaderList;
+
+// HPACK的基础编解码函数与静态表
+class Hpack {
+public:
+	static const size_t kStaticTableSize = 61;
+	static const size_t kEntryOverhead = 32; // 每个表项额外计入的字节数（RFC 7541 4.1）
+
+	struct HeaderField {
+		const char* name;
+		const char* value;
+	};
+
+	// RFC 7541 附录B：静态Huffman编码表（符号0-255的码字与码长，EOS为30位全1）
+	static const uint32_t* huffmanCodes() {
+		static const uint32_t codes[256] = {
+			0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+			0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+			0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+			0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+			0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+			0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+			0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+			0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+			0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+			0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+			0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+			0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+			0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+			0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+			0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+			0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+			0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+			0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+			0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+			0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+			0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+			0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+			0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+			0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+			0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+			0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+			0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+			0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+			0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+			0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+			0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+			0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+		};
+		return codes;
+	}
+
+	static const uint8_t* huffmanLengths() {
+		static const uint8_t lengths[256] = {
+			13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+			28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+			6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+			5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+			13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+			7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+			15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+			6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+			20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+			24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+			22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+			21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+			26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+			19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+			20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+			26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+		};
+		return lengths;
+	}
+
+	// RFC 7541 附录A：静态表，索引从1开始
+	static const HeaderField* staticTable() {
+		static const HeaderField table[kStaticTableSize] = {
+			{":authority", ""},
+			{":method", "GET"},
+			{":method", "POST"},
+			{":path", "/"},
+			{":path", "/index.html"},
+			{":scheme", "http"},
+			{":scheme", "https"},
+			{":status", "200"},
+			{":status", "204"},
+			{":status", "206"},
+			{":status", "304"},
+			{":status", "400"},
+			{":status", "404"},
+			{":status", "500"},
+			{"accept-charset", ""},
+			{"accept-encoding", "gzip, deflate"},
+			{"accept-language", ""},
+			{"accept-ranges", ""},
+			{"accept", ""},
+			{"access-control-allow-origin", ""},
+			{"age", ""},
+			{"allow", ""},
+			{"authorization", ""},
+			{"cache-control", ""},
+			{"content-disposition", ""},
+			{"content-encoding", ""},
+			{"content-language", ""},
+			{"content-length", ""},
+			{"content-location", ""},
+			{"content-range", ""},
+			{"content-type", ""},
+			{"cookie", ""},
+			{"date", ""},
+			{"etag", ""},
+			{"expect", ""},
+			{"expires", ""},
+			{"from", ""},
+			{"host", ""},
+			{"if-match", ""},
+			{"if-modified-since", ""},
+			{"if-none-match", ""},
+			{"if-range", ""},
+			{"if-unmodified-since", ""},
+			{"last-modified", ""},
+			{"link", ""},
+			{"location", ""},
+			{"max-forwards", ""},
+			{"proxy-authenticate", ""},
+			{"proxy-authorization", ""},
+			{"range", ""},
+			{"referer", ""},
+			{"refresh", ""},
+			{"retry-after", ""},
+			{"server", ""},
+			{"set-cookie", ""},
+			{"strict-transport-security", ""},
+			{"transfer-encoding", ""},
+			{"user-agent", ""},
+			{"vary", ""},
+			{"via", ""},
+			{"www-authenticate", ""},
+		};
+		return table;
+	}
+
+	// 整数编码：前缀占 prefixBits 位，firstByte 为第一个字节中前缀以外的标志位
+	static void encodeInteger(std::string& out, uint8_t firstByte, int prefixBits, uint64_t value) {
+		uint64_t limit = (1u << prefixBits) - 1;
+		if (value < limit) {
+			out += static_cast<char>(firstByte | value);
+			return ;
+		}
+		out += static_cast<char>(firstByte | limit);
+		value -= limit;
+		while (value >= 128) {
+			out += static_cast<char>((value & 0x7f) | 0x80);
+			value >>= 7;
+		}
+		out += static_cast<char>(value);
+	}
+
+	static bool decodeInteger(const uint8_t*& p, const uint8_t* end, int prefixBits, uint64_t& value) {
+		if (p >= end) return false;
+		uint64_t limit = (1u << prefixBits) - 1;
+		value = *p++ & limit;
+		if (value < limit) return true;
+		for (int shift = 0; p < end; shift += 7) {
+			if (shift > 28) return false; // 超出合理范围，视为解码错误
+			uint8_t b = *p++;
+			value += static_cast<uint64_t>(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	// 字符串编码：Huffman编码更短时使用Huffman
+	static void encodeString(std::string& out, const std::string& s) {
+		size_t huffLen = huffmanLength(s);
+		if (huffLen < s.size()) {
+			encodeInteger(out, 0x80, 7, huffLen);
+			huffmanEncode(out, s);
+		} else {
+			encodeInteger(out, 0x00, 7, s.size());
+			out += s;
+		}
+	}
+
+	static bool decodeString(const uint8_t*& p, const uint8_t* end, std::string& out) {
+		if (p >= end) return false;
+		bool huffman = *p & 0x80;
+		uint64_t len;
+		if (!decodeInteger(p, end, 7, len) || len > static_cast<uint64_t>(end - p)) return false;
+		out.clear();
+		bool ok = huffman ? huffmanDecode(p, len, out) : (out.assign(reinterpret_cast<const char*>(p), len), true);
+		p += len;
+		return ok;
+	}
+
+	static size_t huffmanLength(const std::string& s) {
+		uint64_t bits = 0;
+		for (unsigned char c : s) bits += huffmanLengths()[c];
+		return (bits + 7) / 8;
+	}
+
+	static void huffmanEncode(std::string& out, const std::string& s) {
+		uint64_t acc = 0;
+		int nbits = 0;
+		for (unsigned char c : s) {
+			acc = (acc << huffmanLengths()[c]) | huffmanCodes()[c];
+			nbits += huffmanLengths()[c];
+			while (nbits >= 8) {
+				nbits -= 8;
+				out += static_cast<char>(acc >> nbits);
+			}
+		}
+		if (nbits > 0) {
+			// 用EOS码字的高位（全1）填充到字节边界
+			out += static_cast<char>((acc << (8 - nbits)) | (0xff >> nbits));
+		}
+	}
+
+	static bool huffmanDecode(const uint8_t* p, size_t len, std::string& out) {
+		const std::vector<HuffmanNode>& tree = huffmanTree();
+		int node = 0;
+		int padBits = 0; // 自上一个完整符号以来读入的位数
+		bool padOnes = true; // 这些位是否全为1
+		for (size_t i = 0; i < len; ++i) {
+			for (int bit = 7; bit >= 0; --bit) {
+				int b = (p[i] >> bit) & 1;
+				node = tree[node].child[b];
+				if (node < 0) return false;
+				padBits++;
+				padOnes = padOnes && b;
+				if (tree[node].symbol >= 0) {
+					if (tree[node].symbol == 256) return false; // 字符串中不允许出现EOS
+					out += static_cast<char>(tree[node].symbol);
+					node = 0;
+					padBits = 0;
+					padOnes = true;
+				}
+			}
+		}
+		return padBits <= 7 && padOnes; // 末尾填充不超过7位且必须为EOS前缀
+	}
+
+private:
+	struct HuffmanNode {
+		int child[2];
+		int symbol;
+	};
+
+	// 由码表构造解码用的二叉树，只在第一次使用时构造
+	static const std::vector<HuffmanNode>& huffmanTree() {
+		static const std::vector<HuffmanNode> tree = [] {
+			std::vector<HuffmanNode> nodes(1, HuffmanNode{{-1, -1}, -1});
+			for (int sym = 0; sym <= 256; ++sym) {
+				uint32_t code = sym < 256 ? huffmanCodes()[sym] : 0x3fffffff;
+				int len = sym < 256 ? huffmanLengths()[sym] : 30;
+				int node = 0;
+				for (int bit = len - 1; bit >= 0; --bit) {
+					int b = (code >> bit) & 1;
+					if (nodes[node].child[b] < 0) {
+						nodes[node].child[b] = nodes.size();
+						nodes.push_back(HuffmanNode{{-1, -1}, -1});
+					}
+					node = nodes[node].child[b];
+				}
+				nodes[node].symbol = sym;
+			}
+			return nodes;
+		}();
+		return tree;
+	}
+};
+
+// 动态表：新表项插入头部，超出容量时从尾部淘汰
+class HpackDynamicTable {
+public:
+	explicit HpackDynamicTable(size_t maxSize = 4096) : maxSize(maxSize), size(0) {}
+
+	void add(const std::string& name, const std::string& value) {
+		size_t entrySize = name.size() + value.size() + Hpack::kEntryOverhead;
+		entries.emplace_front(name, value);
+		size += entrySize;
+		evict();
+	}
+
+	void setMaxSize(size_t newMax) {
+		maxSize = newMax;
+		evict();
+	}
+
+	size_t getMaxSize() const { return maxSize; }
+	size_t count() const { return entries.size(); }
+	size_t bytes() const { return size; } // 按RFC 7541计算的大小，每项的32字节额外开销近似于容器的实际开销
+
+	// index 从0开始（对应HPACK索引 kStaticTableSize + 1 + index）
+	const std::pair<std::string, std::string>& at(size_t index) const { return entries[index]; }
+
+private:
+	std::deque<std::pair<std::string, std::string> > entries;
+	size_t maxSize, size;
+
+	void evict() {
+		while (size > maxSize && !entries.empty()) {
+			size -= entries.back().first.size() + entries.back().second.size() + Hpack::kEntryOverhead;
+			entries.pop_back();
+		}
+	}
+};
+
+// HPACK解码器，每个连接一个（动态表在同一连接的所有头部块之间共享）
+class HpackDecoder {
+public:
+	explicit HpackDecoder(size_t maxTableSize = 4096) : settingsMax(maxTableSize), table(maxTableSize) {}
+
+	size_t memoryUsage() const { return table.bytes(); }
+
+	enum DecodeResult {
+		DECODE_OK,
+		DECODE_ERROR, // 编码错误，连接级的 COMPRESSION_ERROR
+		DECODE_TOO_LARGE // 解码后的头部列表超过 maxListSize
+	};
+
+	// 解码一个完整的头部块。maxListSize 按 RFC 7541 计算的解码后大小（每个字段名称+值+32字节）限制头部列表，
+	// 防止很小的头部块反复引用动态表中的大表项展开成巨大的头部（HPACK炸弹）；超出时立即停止解码，
+	// 动态表已与对端不一致，调用方只能关闭连接
+	DecodeResult decode(const uint8_t* p, size_t len, HeaderList& headers, size_t maxListSize = SIZE_MAX) {
+		const uint8_t* end = p + len;
+		size_t listSize = 0;
+		while (p < end) {
+			uint8_t b = *p;
+			uint64_t index;
+			std::pair<std::string, std::string> field;
+			if (b & 0x80) { // 6.1 索引头部字段
+				if (!Hpack::decodeInteger(p, end, 7, index) || index == 0) return DECODE_ERROR;
+				if (!lookup(index, field)) return DECODE_ERROR;
+			} else if ((b & 0xe0) == 0x20) { // 6.3 动态表大小更新
+				if (!Hpack::decodeInteger(p, end, 5, index) || index > settingsMax) return DECODE_ERROR;
+				table.setMaxSize(index);
+				continue;
+			} else {
+				// 6.2 字面量：带增量索引（01）、不索引（0000）、永不索引（0001）
+				bool incremental = (b & 0xc0) == 0x40;
+				int prefix = incremental ? 6 : 4;
+				if (!Hpack::decodeInteger(p, end, prefix, index)) return DECODE_ERROR;
+				if (index > 0) {
+					if (!lookup(index, field)) return DECODE_ERROR;
+				} else if (!Hpack::decodeString(p, end, field.first)) {
+					return DECODE_ERROR;
+				}
+				if (!Hpack::decodeString(p, end, field.second)) return DECODE_ERROR;
+				if (incremental) table.add(field.first, field.second);
+			}
+			listSize += field.first.size() + field.second.size() + Hpack::kEntryOverhead;
+			if (listSize > maxListSize) return DECODE_TOO_LARGE;
+			headers.push_back(std::move(field));
+		}
+		return DECODE_OK;
+	}
+
+private:
+	size_t settingsMax; // 我方 SETTINGS_HEADER_TABLE_SIZE
+	HpackDynamicTable table;
+
+	bool lookup(uint64_t index, std::pair<std::string, std::string>& field) {
+		if (index <= Hpack::kStaticTableSize) {
+			const Hpack::HeaderField& f = Hpack::staticTable()[index - 1];
+			field.first = f.name;
+			field.second = f.value;
+			return true;
+		}
+		index -= Hpack::kStaticTableSize + 1;
+		if (index >= table.count()) return false;
+		field = table.at(index);
+		return true;
+	}
+};
+
+// HPACK编码器：完全匹配的字段用索引表示，其余字段以带增量索引的字面量发送，
+// 敏感字段（Cookie、认证信息）使用永不索引的字面量
+class HpackEncoder {
+public:
+	HpackEncoder() : table(4096), pendingSizeUpdate(false) {}
+
+	size_t memoryUsage() const { return table.bytes(); }
+
+	// 对端通过 SETTINGS_HEADER_TABLE_SIZE 修改了动态表上限
+	void setMaxTableSize(size_t size) {
+		if (size == table.getMaxSize()) return;
+		table.setMaxSize(size);
+		pendingSizeUpdate = true; // 在下一个头部块开头告知对端
+	}
+
+	// 编码一组头部（名称必须为小写）
+	void encode(const HeaderList& headers, std::string& out) {
+		if (pendingSizeUpdate) {
+			Hpack::encodeInteger(out, 0x20, 5, table.getMaxSize());
+			pendingSizeUpdate = false;
+		}
+		for (const auto& field : headers) {
+			size_t nameIndex = 0;
+			size_t fullIndex = find(field.first, field.second, nameIndex);
+			if (fullIndex) {
+				Hpack::encodeInteger(out, 0x80, 7, fullIndex);
+				continue;
+			}
+			bool sensitive = field.first == "set-cookie" || field.first == "cookie" || field.first == "authorization";
+			if (sensitive) {
+				Hpack::encodeInteger(out, 0x10, 4, nameIndex);
+			} else {
+				Hpack::encodeInteger(out, 0x40, 6, nameIndex);
+			}
+			if (!nameIndex) Hpack::encodeString(out, field.first);
+			Hpack::encodeString(out, field.second);
+			if (!sensitive) table.add(field.first, field.second);
+		}
+	}
+
+private:
+	HpackDynamicTable table;
+	bool pendingSizeUpdate;
+
+	// 查找完全匹配的表项，返回其索引（没有则返回0），nameIndex 返回名称匹配的索引
+	size_t find(const std::string& name, const std::string& value, size_t& nameIndex) {
+		for (size_t i = 0; i < Hpack::kStaticTableSize; ++i) {
+			const Hpack::HeaderField& f = Hpack::staticTable()[i];
+			if (name != f.name) continue;
+			if (value == f.value) return i + 1;
+			if (!nameIndex) nameIndex = i + 1;
+		}
+		for (size_t i = 0; i < table.count(); ++i) {
+			const auto& entry = table.at(i);
+			if (entry.first != name) continue;
+			size_t index = Hpack::kStaticTableSize + 1 + i;
+			if (entry.second == value) return index;
+			if (!nameIndex) nameIndex = index;
+		}
+		return 0;
+	}
+};
+
+#endif
@@ -0,0 +1,633 @@
+/*************************************************************************
+	> File Name: Http2.h
+	> Author:
+	> Mail:
+	> Created Time: Tue 20 Oct 2026 04:05:18 PM CST
+ ************************************************************************/
+
+// HTTP/2（RFC 9113）连接状态机：帧解析、HPACK头部编解码、流的多路复用、流量控制与SETTINGS协商
+// 每个连接一个 Http2Session，由处理该连接的工作线程独占使用，不需要加锁
+#ifndef _HTTP2_H
+#define _HTTP2_H
+
+#include <string>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+#include "Logger.h"
+#include "Hpack.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+// 服务端通告给客户端的SETTINGS参数
+struct Http2Options {
+	uint32_t maxConcurrentStreams = 100; // 每个连接同时打开的流数上限
+	uint32_t initialWindowSize = 1 << 20; // 每个流的初始接收窗口（字节），默认的64KB对大请求体偏小
+	uint32_t connectionWindowSize = 1 << 20; // 连接级接收窗口（字节）
+	uint32_t maxFrameSize = 16384; // 允许客户端发送的最大帧负载
+	uint32_t headerTableSize = 4096; // HPACK解码端动态表上限
+	uint32_t maxHeaderListSize = 65536; // 单个请求头部块的大小上限，压缩后与解码后（按RFC 7541计算）都不能超过
+	size_t maxBodyBytes = 16 * 1024 * 1024; // 单个请求体的上限，超出回复413并重置流
+};
+
+class Http2Session {
+public:
+	// 帧类型
+	enum FrameType {
+		DATA = 0x0, HEADERS = 0x1, PRIORITY = 0x2, RST_STREAM = 0x3, SETTINGS = 0x4,
+		PUSH_PROMISE = 0x5, PING = 0x6, GOAWAY = 0x7, WINDOW_UPDATE = 0x8, CONTINUATION = 0x9
+	};
+
+	// 帧标志位
+	enum FrameFlag {
+		FLAG_END_STREAM = 0x1, FLAG_ACK = 0x1, FLAG_END_HEADERS = 0x4, FLAG_PADDED = 0x8, FLAG_PRIORITY = 0x20
+	};
+
+	// 错误码
+	enum ErrorCode {
+		NO_ERROR = 0x0, PROTOCOL_ERROR = 0x1, INTERNAL_ERROR = 0x2, FLOW_CONTROL_ERROR = 0x3,
+		STREAM_CLOSED = 0x5, FRAME_SIZE_ERROR = 0x6, REFUSED_STREAM = 0x7, COMPRESSION_ERROR = 0x9,
+		ENHANCE_YOUR_CALM = 0xb
+	};
+
+	static const char* preface() { return "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"; }
+	static const size_t kPrefaceLength = 24;
+
+	// 明文连接上的“先验知识”HTTP/2（h2c）：数据以连接前言开头
+	static bool startsWithPreface(const char* data, size_t len) {
+		return len >= 16 && memcmp(data, preface(), 16) == 0; // "PRI * HTTP/2.0\r\n" 已足以与HTTP/1.1区分
+	}
+
+	explicit Http2Session(const Http2Options& options = Http2Options())
+		: options(options), decoder(options.headerTableSize), prefaceReceived(false), goingAway(false), failed(false),
+		  lastStreamId(0), continuationStream(0), endStreamPending(false), peerInitialWindow(65535), peerMaxFrameSize(16384),
+		  sendWindow(65535), recvWindow(65535), recvConsumed(0) {}
+
+	// 写出服务端的连接前言：SETTINGS帧以及扩大连接级接收窗口的WINDOW_UPDATE
+	void start(std::string& out) {
+		std::string payload;
+		appendSetting(payload, 0x1, options.headerTableSize);
+		appendSetting(payload, 0x2, 0); // 不使用服务端推送
+		appendSetting(payload, 0x3, options.maxConcurrentStreams);
+		appendSetting(payload, 0x4, options.initialWindowSize);
+		appendSetting(payload, 0x5, options.maxFrameSize);
+		appendSetting(payload, 0x6, options.maxHeaderListSize);
+		writeFrame(out, SETTINGS, 0, 0, payload);
+		if (options.connectionWindowSize > 65535) {
+			writeWindowUpdate(out, 0, options.connectionWindowSize - 65535);
+			recvWindow = options.connectionWindowSize;
+		}
+	}
+
+	// 处理收到的字节流，每个完整的请求调用一次 handler（签名为 HttpResponse(const HttpRequest&)），
+	// 待发送的帧追加到 out；返回false表示发生了连接级错误（GOAWAY已写入out），发送完后应关闭连接
+	template <class Handler>
+	bool feed(const char* data, size_t len, std::string& out, Handler&& handler) {
+		if (failed) return false;
+		input.append(data, len);
+		size_t pos = 0;
+		if (!prefaceReceived) {
+			if (input.size() < kPrefaceLength) return true;
+			if (memcmp(input.data(), preface(), kPrefaceLength) != 0) {
+				return connectionError(out, PROTOCOL_ERROR, "invalid connection preface");
+			}
+			prefaceReceived = true;
+			pos = kPrefaceLength;
+		}
+		// 逐帧处理：9字节帧头（24位长度、8位类型、8位标志、31位流ID）加负载
+		while (input.size() - pos >= 9) {
+			const uint8_t* h = reinterpret_cast<const uint8_t*>(input.data() + pos);
+			uint32_t length = (h[0] << 16) | (h[1] << 8) | h[2];
+			uint8_t type = h[3], flags = h[4];
+			uint32_t streamId = readUint32(h + 5) & 0x7fffffff;
+			if (length > options.maxFrameSize) {
+				return connectionError(out, FRAME_SIZE_ERROR, "frame too large");
+			}
+			if (input.size() - pos < 9 + length) break; // 帧尚未完整到达
+			const uint8_t* payload = h + 9;
+			pos += 9 + length;
+			if (!handleFrame(type, flags, streamId, payload, length, out, handler)) {
+				input.clear();
+				return false;
+			}
+		}
+		input.erase(0, pos);
+		return true;
+	}
+
+	// 对端已发送GOAWAY或发生连接级错误，且没有待发送的响应数据
+	bool finished() const {
+		if (!goingAway) return false;
+		for (const auto& entry : streams) {
+			if (!entry.second.pending.empty() || entry.second.source) return false;
+		}
+		return true;
+	}
+
+	// 连接的发送缓冲区发完后调用：在流量控制窗口允许的范围内继续从流式响应的产生器取数据，
+	// 返回是否写出了数据。没有流式响应或窗口已用完时什么都不做
+	bool pump(std::string& out) {
+		size_t before = out.size();
+		flushPending(out);
+		return out.size() > before;
+	}
+
+	// 没有打开的流，也没有缓存不完整的帧
+	bool idle() const {
+		return streams.empty() && input.empty();
+	}
+
+	// 连接级状态占用的内存：输入缓冲、HPACK动态表以及每个打开的流
+	size_t memoryUsage() const {
+		size_t bytes = sizeof(*this) + input.capacity() + decoder.memoryUsage() + encoder.memoryUsage();
+		for (const auto& entry : streams) {
+			const Stream& stream = entry.second;
+			bytes += sizeof(entry) + 32 + stream.headerBlock.capacity() + stream.body.capacity() + stream.pending.capacity();
+		}
+		return bytes;
+	}
+
+	// 服务端主动关闭（例如过载）：GOAWAY告知客户端尚未处理的流可以在新连接上重试
+	void shutdown(std::string& out) {
+		writeGoAway(out, NO_ERROR);
+		goingAway = true;
+	}
+
+private:
+	// 每个流的状态；请求处理完且响应数据全部发出后从表中移除
+	struct Stream {
+		std::string headerBlock; // 尚未解码的头部块（HEADERS + CONTINUATION）
+		HttpRequest request{std::pmr::new_delete_resource()}; // 可能跨越多次读取，不能使用请求内存池
+		std::string body;
+		bool headersDone = false; // 请求头部已接收完
+		bool responded = false; // 已调用handler并写出响应头
+		int64_t sendWindow = 0; // 该流的发送窗口
+		int64_t recvWindow = 0; // 该流的接收窗口：客户端还可以发送的字节数
+		std::string pending; // 受流量控制限制尚未发出的响应体
+		HttpResponse::BodyProducer source; // 流式响应体尚未取出的部分，pending 发完后再取
+	};
+
+	Http2Options options;
+	HpackDecoder decoder;
+	HpackEncoder encoder;
+	std::string input; // 尚未构成完整帧的输入数据
+	bool prefaceReceived, goingAway, failed; // failed 表示发生了连接级错误
+	uint32_t lastStreamId; // 客户端已使用的最大流ID
+	uint32_t continuationStream; // 正在等待CONTINUATION帧的流，为0表示没有
+	bool endStreamPending; // 被CONTINUATION拆分的HEADERS帧是否带有END_STREAM
+	uint32_t peerInitialWindow, peerMaxFrameSize; // 客户端SETTINGS中的参数
+	int64_t sendWindow, recvWindow; // 连接级的发送/接收窗口
+	uint32_t recvConsumed; // 连接级已接收但尚未归还的字节数
+	std::map<uint32_t, Stream> streams;
+	static const size_t kStreamChunkBytes = 16384; // 每次向流式响应的产生器取的数据量
+	static const size_t kStreamOutputLimit = 64 * 1024; // 流式响应在连接的发送缓冲区中最多积压的字节数
+
+	static uint32_t readUint32(const uint8_t* p) {
+		return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+	}
+
+	static void appendUint32(std::string& out, uint32_t v) {
+		out += static_cast<char>(v >> 24);
+		out += static_cast<char>(v >> 16);
+		out += static_cast<char>(v >> 8);
+		out += static_cast<char>(v);
+	}
+
+	static void appendSetting(std::string& out, uint16_t id, uint32_t value) {
+		out += static_cast<char>(id >> 8);
+		out += static_cast<char>(id);
+		appendUint32(out, value);
+	}
+
+	static void writeFrameHeader(std::string& out, size_t length, uint8_t type, uint8_t flags, uint32_t streamId) {
+		out += static_cast<char>(length >> 16);
+		out += static_cast<char>(length >> 8);
+		out += static_cast<char>(length);
+		out += static_cast<char>(type);
+		out += static_cast<char>(flags);
+		appendUint32(out, streamId & 0x7fffffff);
+	}
+
+	static void writeFrame(std::string& out, uint8_t type, uint8_t flags, uint32_t streamId, const std::string& payload) {
+		writeFrameHeader(out, payload.size(), type, flags, streamId);
+		out += payload;
+	}
+
+	static void writeWindowUpdate(std::string& out, uint32_t streamId, uint32_t increment) {
+		writeFrameHeader(out, 4, WINDOW_UPDATE, 0, streamId);
+		appendUint32(out, increment);
+	}
+
+	static void writeRstStream(std::string& out, uint32_t streamId, ErrorCode code) {
+		writeFrameHeader(out, 4, RST_STREAM, 0, streamId);
+		appendUint32(out, code);
+	}
+
+	// 连接级错误：发送GOAWAY，之后不再处理任何帧
+	bool connectionError(std::string& out, ErrorCode code, const char* reason) {
+		LOG_WARNING("HTTP/2 connection error %d: %s", code, reason);
+		writeGoAway(out, code);
+		goingAway = failed = true;
+		for (auto& entry : streams) {
+			entry.second.pending.clear();
+			entry.second.source = nullptr;
+		}
+		return false;
+	}
+
+	void writeGoAway(std::string& out, ErrorCode code) {
+		writeFrameHeader(out, 8, GOAWAY, 0, 0);
+		appendUint32(out, lastStreamId);
+		appendUint32(out, code);
+	}
+
+	// 流级错误：只重置该流，连接继续可用
+	void streamError(std::string& out, uint32_t streamId, ErrorCode code) {
+		writeRstStream(out, streamId, code);
+		streams.erase(streamId);
+	}
+
+	template <class Handler>
+	bool handleFrame(uint8_t type, uint8_t flags, uint32_t streamId, const uint8_t* payload, uint32_t length,
+		std::string& out, Handler& handler) {
+		// 头部块被CONTINUATION拆分时，中间不能插入其他帧
+		if (continuationStream && (type != CONTINUATION || streamId != continuationStream)) {
+			return connectionError(out, PROTOCOL_ERROR, "expected CONTINUATION");
+		}
+		switch (type) {
+			case DATA: return onData(flags, streamId, payload, length, out, handler);
+			case HEADERS: return onHeaders(flags, streamId, payload, length, out, handler);
+			case CONTINUATION: return onContinuation(flags, streamId, payload, length, out, handler);
+			case SETTINGS: return onSettings(flags, streamId, payload, length, out);
+			case WINDOW_UPDATE: return onWindowUpdate(streamId, payload, length, out);
+			case PING:
+				if (streamId != 0) return connectionError(out, PROTOCOL_ERROR, "PING on stream");
+				if (length != 8) return connectionError(out, FRAME_SIZE_ERROR, "bad PING length");
+				if (!(flags & FLAG_ACK)) {
+					writeFrame(out, PING, FLAG_ACK, 0, std::string(reinterpret_cast<const char*>(payload), 8));
+				}
+				return true;
+			case RST_STREAM:
+				if (streamId == 0) return connectionError(out, PROTOCOL_ERROR, "RST_STREAM on stream 0");
+				if (length != 4) return connectionError(out, FRAME_SIZE_ERROR, "bad RST_STREAM length");
+				streams.erase(streamId);
+				return true;
+			case PRIORITY:
+				if (streamId == 0) return connectionError(out, PROTOCOL_ERROR, "PRIORITY on stream 0");
+				if (length != 5) streamError(out, streamId, FRAME_SIZE_ERROR);
+				return true; // 响应按请求完成的顺序发送，不使用优先级
+			case GOAWAY:
+				goingAway = true; // 已排队的响应数据仍会发送完
+				return true;
+			case PUSH_PROMISE:
+				return connectionError(out, PROTOCOL_ERROR, "PUSH_PROMISE from client");
+			default:
+				return true; // 忽略未知类型的帧
+		}
+	}
+
+	// 去掉PADDED标志带来的填充，失败表示填充长度非法
+	static bool stripPadding(uint8_t flags, const uint8_t*& payload, uint32_t& length) {
+		if (!(flags & FLAG_PADDED)) return true;
+		if (length < 1) return false;
+		uint8_t padLength = payload[0];
+		if (padLength >= length) return false;
+		payload += 1;
+		length -= 1 + padLength;
+		return true;
+	}
+
+	template <class Handler>
+	bool onHeaders(uint8_t flags, uint32_t streamId, const uint8_t* payload, uint32_t length,
+		std::string& out, Handler& handler) {
+		if (streamId == 0 || streamId % 2 == 0) return connectionError(out, PROTOCOL_ERROR, "bad stream id");
+		if (!stripPadding(flags, payload, length)) return connectionError(out, PROTOCOL_ERROR, "bad padding");
+		if (flags & FLAG_PRIORITY) {
+			if (length < 5) return connectionError(out, FRAME_SIZE_ERROR, "bad HEADERS length");
+			payload += 5; // 流依赖与权重，不使用
+			length -= 5;
+		}
+		auto it = streams.find(streamId);
+		if (it == streams.end()) {
+			if (streamId <= lastStreamId) return connectionError(out, STREAM_CLOSED, "HEADERS on closed stream");
+			lastStreamId = streamId;
+			size_t open = 0;
+			for (const auto& entry : streams) {
+				if (!entry.second.responded) open++;
+			}
+			if (open >= options.maxConcurrentStreams) {
+				// 仍需解码头部块以保持HPACK动态表同步，然后拒绝该流
+				if (!(flags & FLAG_END_HEADERS)) return connectionError(out, REFUSED_STREAM, "too many streams");
+				HeaderList ignored;
+				if (!decodeHeaders(payload, length, ignored, out)) return false;
+				writeRstStream(out, streamId, REFUSED_STREAM);
+				return true;
+			}
+			it = streams.emplace(streamId, Stream()).first;
+			it->second.sendWindow = peerInitialWindow;
+			it->second.recvWindow = options.initialWindowSize;
+		} else if (!it->second.headersDone || it->second.responded || !(flags & FLAG_END_STREAM)) {
+			return connectionError(out, PROTOCOL_ERROR, "unexpected HEADERS");
+		}
+		Stream& stream = it->second;
+		stream.headerBlock.append(reinterpret_cast<const char*>(payload), length);
+		if (stream.headerBlock.size() > options.maxHeaderListSize) {
+			return connectionError(out, ENHANCE_YOUR_CALM, "header block too large");
+		}
+		if (!(flags & FLAG_END_HEADERS)) {
+			continuationStream = streamId;
+			endStreamPending = flags & FLAG_END_STREAM;
+			return true;
+		}
+		return headerBlockDone(streamId, flags & FLAG_END_STREAM, out, handler);
+	}
+
+	template <class Handler>
+	bool onContinuation(uint8_t flags, uint32_t streamId, const uint8_t* payload, uint32_t length,
+		std::string& out, Handler& handler) {
+		if (!continuationStream) return connectionError(out, PROTOCOL_ERROR, "unexpected CONTINUATION");
+		Stream& stream = streams[streamId];
+		stream.headerBlock.append(reinterpret_cast<const char*>(payload), length);
+		if (stream.headerBlock.size() > options.maxHeaderListSize) {
+			return connectionError(out, ENHANCE_YOUR_CALM, "header block too large");
+		}
+		if (!(flags & FLAG_END_HEADERS)) return true;
+		continuationStream = 0;
+		return headerBlockDone(streamId, endStreamPending, out, handler);
+	}
+
+	// 解码一个头部块（HEADERS 与 CONTINUATION 拼接而成），失败时已经发出GOAWAY
+	bool decodeHeaders(const uint8_t* block, size_t length, HeaderList& headers, std::string& out) {
+		switch (decoder.decode(block, length, headers, options.maxHeaderListSize)) {
+			case HpackDecoder::DECODE_OK: return true;
+			case HpackDecoder::DECODE_TOO_LARGE: return connectionError(out, ENHANCE_YOUR_CALM, "decoded header list too large");
+			default: return connectionError(out, COMPRESSION_ERROR, "HPACK decoding failed");
+		}
+	}
+
+	// 头部块接收完整：解码并转换为HttpRequest（请求头或尾部字段）
+	template <class Handler>
+	bool headerBlockDone(uint32_t streamId, bool endStream, std::string& out, Handler& handler) {
+		Stream& stream = streams[streamId];
+		HeaderList headers;
+		bool ok = decodeHeaders(reinterpret_cast<const uint8_t*>(stream.headerBlock.data()),
+			stream.headerBlock.size(), headers, out);
+		stream.headerBlock.clear();
+		if (!ok) return false;
+		if (!stream.headersDone) {
+			std::string method, path;
+			for (const auto& field : headers) {
+				if (field.first.empty()) {
+					streamError(out, streamId, PROTOCOL_ERROR);
+					return true;
+				}
+				if (field.first == ":method") method = field.second;
+				else if (field.first == ":path") path = field.second;
+				else if (field.first == ":authority") stream.request.addHeader("host", field.second);
+				else if (field.first[0] != ':') stream.request.addHeader(field.first, field.second);
+			}
+			if (method.empty() || path.empty()) {
+				streamError(out, streamId, PROTOCOL_ERROR);
+				return true;
+			}
+			stream.request.setMethod(method);
+			stream.request.setPath(path);
+			stream.request.setVersion("HTTP/2");
+			stream.headersDone = true;
+			std::string_view contentLength = stream.request.getHeader("content-length");
+			if (!contentLength.empty() && std::strtoull(std::string(contentLength).c_str(), nullptr, 10) > options.maxBodyBytes) {
+				rejectStream(out, streamId, 413); // 声明的长度已经超出上限，不必等请求体到达
+				return true;
+			}
+		} // 尾部字段（trailers）目前不使用，解码只为保持HPACK状态同步
+		if (endStream) dispatch(streamId, out, handler);
+		return true;
+	}
+
+	template <class Handler>
+	bool onData(uint8_t flags, uint32_t streamId, const uint8_t* payload, uint32_t length,
+		std::string& out, Handler& handler) {
+		if (streamId == 0) return connectionError(out, PROTOCOL_ERROR, "DATA on stream 0");
+		// 整个帧长度（包括填充）都计入流量控制
+		uint32_t frameLength = length;
+		recvWindow -= frameLength;
+		if (recvWindow < 0) return connectionError(out, FLOW_CONTROL_ERROR, "connection window exceeded");
+		returnConnectionWindow(out, frameLength); // 每个流缓存的请求体都有上限，连接级窗口可以立即归还
+		if (!stripPadding(flags, payload, length)) return connectionError(out, PROTOCOL_ERROR, "bad padding");
+		auto it = streams.find(streamId);
+		if (it == streams.end() || !it->second.headersDone || it->second.responded) {
+			if (streamId > lastStreamId) return connectionError(out, PROTOCOL_ERROR, "DATA on idle stream");
+			writeRstStream(out, streamId, STREAM_CLOSED);
+			return true;
+		}
+		Stream& stream = it->second;
+		stream.recvWindow -= frameLength;
+		if (stream.recvWindow < 0) {
+			streamError(out, streamId, FLOW_CONTROL_ERROR);
+			return true;
+		}
+		if (stream.body.size() + length > options.maxBodyBytes) {
+			rejectStream(out, streamId, 413);
+			return true;
+		}
+		stream.body.append(reinterpret_cast<const char*>(payload), length);
+		if (flags & FLAG_END_STREAM) {
+			dispatch(streamId, out, handler);
+			return true;
+		}
+		// 请求体尚未结束：窗口用掉一半时补充，但只补到 maxBodyBytes 减去已缓存的请求体为止。
+		// 缓存的数据要等请求完整后才交给handler，客户端在途的数据加上已缓存的数据不会超过上限；
+		// 多给1字节，超出上限的请求体会发来这1字节而得到413，不会停在窗口为0处
+		int64_t allowance = int64_t(options.maxBodyBytes) + 1 - int64_t(stream.body.size());
+		int64_t target = std::min<int64_t>(options.initialWindowSize, allowance);
+		if (stream.recvWindow <= int64_t(options.initialWindowSize / 2) && target > stream.recvWindow) {
+			writeWindowUpdate(out, streamId, uint32_t(target - stream.recvWindow));
+			stream.recvWindow = target;
+		}
+		return true;
+	}
+
+	// 响应头发出之前拒绝一个流（请求体超出上限）：写出只有状态码的响应，再以 NO_ERROR 重置流，
+	// 客户端不必再发送剩余的请求体（RFC 9113 8.1）
+	void rejectStream(std::string& out, uint32_t streamId, int status) {
+		HeaderList headers;
+		headers.emplace_back(":status", std::to_string(status));
+		headers.emplace_back("content-length", "0");
+		std::string block;
+		encoder.encode(headers, block);
+		writeFrameHeader(out, block.size(), HEADERS, FLAG_END_HEADERS | FLAG_END_STREAM, streamId);
+		out += block;
+		streamError(out, streamId, NO_ERROR);
+	}
+
+	void returnConnectionWindow(std::string& out, uint32_t length) {
+		recvConsumed += length;
+		if (recvConsumed >= options.connectionWindowSize / 2) {
+			writeWindowUpdate(out, 0, recvConsumed);
+			recvWindow += recvConsumed;
+			recvConsumed = 0;
+		}
+	}
+
+	bool onSettings(uint8_t flags, uint32_t streamId, const uint8_t* payload, uint32_t length, std::string& out) {
+		if (streamId != 0) return connectionError(out, PROTOCOL_ERROR, "SETTINGS on stream");
+		if (flags & FLAG_ACK) {
+			if (length != 0) return connectionError(out, FRAME_SIZE_ERROR, "SETTINGS ACK with payload");
+			return true;
+		}
+		if (length % 6 != 0) return connectionError(out, FRAME_SIZE_ERROR, "bad SETTINGS length");
+		for (uint32_t i = 0; i < length; i += 6) {
+			uint16_t id = (payload[i] << 8) | payload[i + 1];
+			uint32_t value = readUint32(payload + i + 2);
+			switch (id) {
+				case 0x1: // HEADER_TABLE_SIZE：编码端动态表不超过对端允许的大小
+					encoder.setMaxTableSize(std::min<uint32_t>(value, 4096));
+					break;
+				case 0x2: // ENABLE_PUSH
+					if (value > 1) return connectionError(out, PROTOCOL_ERROR, "bad ENABLE_PUSH");
+					break;
+				case 0x4: { // INITIAL_WINDOW_SIZE：按差值调整所有已打开流的发送窗口
+					if (value > 0x7fffffff) return connectionError(out, FLOW_CONTROL_ERROR, "bad INITIAL_WINDOW_SIZE");
+					int64_t delta = int64_t(value) - peerInitialWindow;
+					for (auto& entry : streams) entry.second.sendWindow += delta;
+					peerInitialWindow = value;
+					break;
+				}
+				case 0x5: // MAX_FRAME_SIZE
+					if (value < 16384 || value > 16777215) return connectionError(out, PROTOCOL_ERROR, "bad MAX_FRAME_SIZE");
+					peerMaxFrameSize = value;
+					break;
+				default: // MAX_CONCURRENT_STREAMS、MAX_HEADER_LIST_SIZE 与未知参数：服务端不需要
+					break;
+			}
+		}
+		writeFrameHeader(out, 0, SETTINGS, FLAG_ACK, 0);
+		flushPending(out); // 窗口可能变大了
+		return true;
+	}
+
+	bool onWindowUpdate(uint32_t streamId, const uint8_t* payload, uint32_t length, std::string& out) {
+		if (length != 4) return connectionError(out, FRAME_SIZE_ERROR, "bad WINDOW_UPDATE length");
+		uint32_t increment = readUint32(payload) & 0x7fffffff;
+		if (streamId == 0) {
+			if (increment == 0) return connectionError(out, PROTOCOL_ERROR, "zero WINDOW_UPDATE");
+			sendWindow += increment;
+			if (sendWindow > 0x7fffffff) return connectionError(out, FLOW_CONTROL_ERROR, "window overflow");
+		} else {
+			auto it = streams.find(streamId);
+			if (it == streams.end()) return true; // 流已结束，忽略
+			if (increment == 0) {
+				streamError(out, streamId, PROTOCOL_ERROR);
+				return true;
+			}
+			it->second.sendWindow += increment;
+			if (it->second.sendWindow > 0x7fffffff) {
+				streamError(out, streamId, FLOW_CONTROL_ERROR);
+				return true;
+			}
+		}
+		flushPending(out);
+		return true;
+	}
+
+	// 请求接收完整：交给handler处理，写出响应头，响应体进入流量控制队列
+	template <class Handler>
+	void dispatch(uint32_t streamId, std::string& out, Handler& handler) {
+		Stream& stream = streams[streamId];
+		stream.responded = true;
+		stream.request.setBody(stream.body);
+		stream.body.clear();
+		HttpResponse response = handler(stream.request);
+
+		HeaderList headers;
+		headers.emplace_back(":status", std::to_string(response.getStatusCode()));
+		for (const auto& header : response.getHeaders()) {
+			std::string name(header.first);
+			for (auto& c : name) c = tolower(c); // HTTP/2要求头部名称为小写
+			// 逐跳头部在HTTP/2中被禁止，长度由帧边界给出
+			if (name == "connection" || name == "keep-alive" || name == "transfer-encoding" || name == "content-length") continue;
+			headers.emplace_back(name, std::string(header.second));
+		}
+		if (response.hasBody() && !response.isStreaming()) headers.emplace_back("content-length", std::to_string(response.getBody().size()));
+		std::string block;
+		encoder.encode(headers, block);
+
+		bool endStream = response.getBody().empty() && !response.isStreaming();
+		// 头部块超过对端的最大帧长度时拆分为 HEADERS + CONTINUATION
+		size_t offset = 0;
+		do {
+			size_t chunk = std::min<size_t>(block.size() - offset, peerMaxFrameSize);
+			uint8_t type = offset == 0 ? HEADERS : CONTINUATION;
+			uint8_t flags = (offset + chunk == block.size() ? FLAG_END_HEADERS : 0) |
+				(offset == 0 && endStream ? FLAG_END_STREAM : 0);
+			writeFrameHeader(out, chunk, type, flags, streamId);
+			out.append(block, offset, chunk);
+			offset += chunk;
+		} while (offset < block.size());
+
+		if (endStream) {
+			streams.erase(streamId);
+			return ;
+		}
+		stream.pending.assign(response.getBody().data(), response.getBody().size());
+		stream.source = response.takeStream();
+		flushPending(out);
+	}
+
+	// 在连接和流的发送窗口允许的范围内发出排队的响应体。流式响应在 pending 发完后才向产生器取下一段，
+	// 发送缓冲区中已经积压了 kStreamOutputLimit 字节时不再取，等连接把数据发出去后由 pump 继续
+	void flushPending(std::string& out) {
+		for (auto it = streams.begin(); it != streams.end() && sendWindow > 0; ) {
+			Stream& stream = it->second;
+			bool failed = false;
+			while (stream.sendWindow > 0 && sendWindow > 0) {
+				if (stream.pending.empty()) {
+					if (!stream.source || out.size() >= kStreamOutputLimit) break;
+					if (!pull(stream)) {
+						failed = true;
+						break;
+					}
+					if (stream.pending.empty()) { // 产生器结束时没有更多数据：用空的DATA帧结束流
+						writeFrameHeader(out, 0, DATA, FLAG_END_STREAM, it->first);
+						break;
+					}
+				}
+				size_t chunk = std::min<size_t>(stream.pending.size(), peerMaxFrameSize);
+				chunk = std::min<size_t>(chunk, std::min(stream.sendWindow, sendWindow));
+				bool last = chunk == stream.pending.size() && !stream.source;
+				writeFrameHeader(out, chunk, DATA, last ? FLAG_END_STREAM : 0, it->first);
+				out.append(stream.pending, 0, chunk);
+				stream.pending.erase(0, chunk);
+				stream.sendWindow -= chunk;
+				sendWindow -= chunk;
+				if (last) break;
+			}
+			if (failed) {
+				writeRstStream(out, it->first, INTERNAL_ERROR); // 响应头已经发出，只能重置该流
+				it = streams.erase(it);
+			} else if (stream.responded && stream.pending.empty() && !stream.source) {
+				it = streams.erase(it); // 响应已全部发出，流关闭
+			} else {
+				++it;
+			}
+		}
+	}
+
+	// 从产生器取数据，凑够一个最小帧长或产生器结束为止；产生器抛出异常时返回false
+	bool pull(Stream& stream) {
+		try {
+			bool more = true;
+			while (more && stream.pending.size() < kStreamChunkBytes) more = stream.source(stream.pending);
+			if (!more) stream.source = nullptr;
+			return true;
+		} catch (const std::exception& e) {
+			LOG_ERROR("HTTP/2 stream producer failed: %s", e.what());
+			return false;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,313 @@
+/*************************************************************************
+	> File Name: HttpRequest.h
+	> Author: 
+	> Mail: 
+	> Created Time: Sat 24 May 2025 04:31:47 PM CST
+ ************************************************************************/
+
+// http_requset.h
+#pragma once
+#ifndef _HTTPREQUEST_H
+#define _HTTPREQUEST_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory_resource>
+#include <charconv>
+#include <strings.h>
+
+#include "Logger.h"
+#include "FormData.h"
+#include "Arena.h"
+#include "Probes.h"
+#include "Profiler.h"
+
+// 定义HttpRequset 类用于解析和存储HTTP请求
+class HttpRequest {
+public:
+	// 枚举类型，定义HTTP请求的方法
+	enum Method {
+		GET, POST, HEAD, PUT, DELETE, TRACE, OPTIONS, CONNECT, PATCH, UNKNOW
+	};
+
+	// 枚举类型，定义解析HTTP请求的不同阶段
+	enum ParseState {
+		REQUEST_LINE, HEADERS, BODY, FINISH
+	};
+
+	// 字符串与请求头表从 mr 分配，默认为当前请求的内存池（见 Arena）
+	explicit HttpRequest(std::pmr::memory_resource* mr = Arena::resource())
+		: method(UNKNOW), state(REQUEST_LINE), path(mr), query(mr), version(mr), headers(mr), body(mr), user(mr) {}
+
+	/*
+	POST /login HTTP/1.1
+	Host: localhost:7007
+	Content-Type: application/x-222-form-urlencoded
+	Content-Length: 30
+
+	username=testname&password=test1
+	*/
+	// 解析整个HTTP请求的函数
+	bool parse(std::string_view request) {
+		PROFILE_SCOPE(PARSE);
+		PROBE2(parse_start, request.data(), request.size());
+		size_t pos = 0;
+		bool result = true;
+
+		// 按行读取请求，并根据当前解析状态处理每行，遇到空行（请求头结束）为止
+		while (pos < request.size()) {
+			size_t eol = request.find('\n', pos);
+			if (eol == std::string_view::npos) eol = request.size();
+			std::string_view line = request.substr(pos, eol - pos);
+			pos = eol + 1;
+			if (!line.empty() && line.back() == '\r') line.remove_suffix(1); // 去掉行尾的\r
+			if (line.empty()) break;
+			if (state == REQUEST_LINE) {
+				result = parseRequestLine(line);
+			} else if (state == HEADERS) {
+				result = parseHeader(line);
+			}
+			if (!result) {
+				break; //如果解析失败，则跳出循环
+			}
+		}
+
+		if (method == POST) {
+			size_t end = request.find("\r\n\r\n");
+			body = end == std::string_view::npos ? std::string_view() : request.substr(end + 4);
+		}
+		PROBE3(parse_done, int(result), path.data(), path.size());
+		return result;
+	}
+
+	// 从完整的请求头（到空行为止）中取出请求体的长度，用于在读缓冲区中划出一个完整的请求。
+	// 没有 Content-Length 时为0；请求体使用 chunked 编码时 chunked 为true（长度由 ChunkedDecoder 逐块确定）。
+	// 长度非法、chunked 以外的传输编码、或同时出现 Transfer-Encoding 与 Content-Length（请求走私）时返回false
+	static bool bodyLength(std::string_view head, size_t& length, bool& chunked) {
+		length = 0;
+		chunked = false;
+		bool hasLength = false;
+		size_t pos = head.find('\n'); // 跳过请求行
+		while (pos != std::string_view::npos && pos + 1 < head.size()) {
+			size_t eol = head.find('\n', pos + 1);
+			std::string_view line = head.substr(pos + 1, eol == std::string_view::npos ? eol : eol - pos - 1);
+			pos = eol;
+			size_t colon = line.find(':');
+			if (colon == std::string_view::npos) continue;
+			std::string_view name = line.substr(0, colon);
+			bool isEncoding = name.size() == 17 && strncasecmp(name.data(), "transfer-encoding", 17) == 0;
+			if (!isEncoding && (name.size() != 14 || strncasecmp(name.data(), "content-length", 14) != 0)) continue;
+			std::string_view value = line.substr(colon + 1);
+			while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+			while (!value.empty() && (value.back() == '\r' || value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+			if (isEncoding) {
+				if (chunked || value.size() != 7 || strncasecmp(value.data(), "chunked", 7) != 0) return false;
+				chunked = true;
+				continue;
+			}
+			size_t parsed = 0;
+			auto result = std::from_chars(value.data(), value.data() + value.size(), parsed);
+			if (value.empty() || result.ec != std::errc() || result.ptr != value.data() + value.size()) return false;
+			if (hasLength && length != parsed) return false; // 多个互相矛盾的 Content-Length
+			length = parsed;
+			hasLength = true;
+		}
+		return !(chunked && hasLength);
+	}
+
+	// 逐个解析表单形式的请求体，含转义的字段解码到 arena 中（见 FormParser）
+	FormParser formParams(std::pmr::memory_resource* arena = Arena::resource()) const {
+		return FormParser(method == POST ? std::string_view(body) : std::string_view(), arena);
+	}
+
+	// 逐个解析查询字符串（路径中 '?' 之后的部分）
+	FormParser queryParams(std::pmr::memory_resource* arena = Arena::resource()) const {
+		return FormParser(query, arena);
+	}
+
+	// 解析表单形式的请求体，返回解码后的键值对字典（会复制每个键和值，热点路径请使用 formParams）
+	std::unordered_map<std::string, std::string> parseFormBody() const {
+		std::unordered_map<std::string, std::string> params;
+		std::pmr::unsynchronized_pool_resource arena;
+		FormParser form = formParams(&arena);
+		std::string_view key, value;
+		while (form.next(key, value)) {
+			params.emplace(key, value); // 同名字段取第一个
+		}
+		return params;
+	}
+
+	// 获取HTTP请求方法的字符串表示
+	std::string getMethodString() const {
+		switch (method) {
+			case GET: return "GET";
+			case POST: return "POST";
+			case OPTIONS: return "OPTIONS"; // CORS预检请求
+			// 其他方法
+			default: return "UNKNOW";
+		}
+		return "UNKNOW";
+	}
+
+	// 获取请求路径的函数（不含查询字符串）。以下返回的 string_view 在请求对象销毁前有效
+	std::string_view getPath() const {
+		return path;
+	}
+
+	// 获取未解码的查询字符串，没有时为空
+	std::string_view getQuery() const {
+		return query;
+	}
+
+	// 协议版本，例如 "HTTP/1.1"（HTTP/2请求为空）
+	std::string_view getVersion() const {
+		return version;
+	}
+
+	std::string_view getBody() const {
+		return body;
+	}
+
+	// 获取请求头的值，名称不区分大小写；不存在时返回空
+	std::string_view getHeader(std::string_view name) const {
+		std::pmr::string key(name, headers.get_allocator().resource());
+		for (auto& c : key) c = tolower(c);
+		auto it = headers.find(key);
+		return it == headers.end() ? std::string_view() : std::string_view(it->second);
+	}
+
+	// 认证通过后由 Router 设置的用户名；未认证时为空
+	std::string_view getUser() const {
+		return user;
+	}
+
+	void setUser(std::string_view u) {
+		user = u;
+	}
+
+	// 请求是否直接来自可信的对端（TraceOptions::trustedAddresses），由服务器按连接的对端地址设置
+	bool isTrusted() const {
+		return trusted;
+	}
+
+	void setTrusted(bool t) {
+		trusted = t;
+	}
+
+	// 获取Cookie的值；不存在时返回空
+	std::string_view getCookie(std::string_view name) const {
+		std::string_view cookies = getHeader("cookie");
+		size_t pos = 0;
+		while (pos < cookies.size()) {
+			size_t end = cookies.find(';', pos);
+			if (end == std::string_view::npos) end = cookies.size();
+			size_t start = cookies.find_first_not_of(' ', pos);
+			size_t eq = cookies.find('=', start);
+			if (start < end && eq < end && cookies.substr(start, eq - start) == name) {
+				return cookies.substr(eq + 1, end - eq - 1);
+			}
+			pos = end + 1;
+		}
+		return std::string_view();
+	}
+
+	// 以下设置函数供不经过文本解析的请求来源使用（例如HTTP/2的HEADERS帧）
+	void setMethod(std::string_view method_str) {
+		if (method_str == "GET") method = GET;
+		else if (method_str == "POST") method = POST;
+		else if (method_str == "OPTIONS") method = OPTIONS;
+		else method = UNKNOW;
+		state = FINISH;
+	}
+
+	void setPath(std::string_view p) {
+		splitTarget(p);
+	}
+
+	void setVersion(std::string_view v) {
+		version = v;
+	}
+
+	// 名称统一存为小写；同名请求头重复出现时以逗号合并（Cookie 以分号合并）
+	void addHeader(std::string_view name, std::string_view value) {
+		std::pmr::string key(name, headers.get_allocator().resource());
+		for (auto& c : key) c = tolower(c);
+		auto it = headers.find(key);
+		if (it == headers.end()) {
+			headers.emplace(std::move(key), value);
+		} else {
+			it->second += (key == "cookie" ? "; " : ", ");
+			it->second += value;
+		}
+	}
+
+	void setBody(std::string_view b) {
+		body = b;
+	}
+
+	// 其他成员函数和变量...
+
+	
+private:
+	Method method;
+	ParseState state; // 请求解析状态
+	std::pmr::string path, query, version;
+	std::pmr::unordered_map<std::pmr::string, std::pmr::string> headers; // 请求头
+	std::pmr::string body;
+	std::pmr::string user; // 认证得到的用户名，不来自请求文本
+	bool trusted = false;
+
+	// 解析请求行的函数
+	bool parseRequestLine(std::string_view line) {
+		std::string_view method_str = nextToken(line);
+		if (method_str == "GET") method = GET;
+		else if (method_str == "POST") method = POST;
+		else if (method_str == "OPTIONS") method = OPTIONS;
+		else method = UNKNOW;
+
+		splitTarget(nextToken(line)); // 解析请求路径
+		version = nextToken(line); // 解析HTTP协议版本
+		state = HEADERS;
+		return true;
+	}
+
+	// 取出 line 开头以空格分隔的一段，并将其从 line 中去掉
+	static std::string_view nextToken(std::string_view& line) {
+		size_t start = line.find_first_not_of(' ');
+		if (start == std::string_view::npos) {
+			line = std::string_view();
+			return line;
+		}
+		size_t end = line.find(' ', start);
+		std::string_view token = line.substr(start, end == std::string_view::npos ? end : end - start);
+		line = end == std::string_view::npos ? std::string_view() : line.substr(end);
+		return token;
+	}
+
+	// 把请求目标拆分为路径与查询字符串，路由只按路径匹配
+	void splitTarget(std::string_view target) {
+		size_t pos = target.find('?');
+		if (pos == std::string_view::npos) {
+			path = target;
+			query.clear();
+		} else {
+			path = target.substr(0, pos);
+			query = target.substr(pos + 1);
+		}
+	}
+
+	// 解析请求头的函数
+	bool parseHeader(std::string_view line) {
+		size_t pos = line.find(": ");
+		if (pos == std::string_view::npos) {
+			return false; // 如果格式不正确，则解析失败
+		}
+		std::pmr::string key(line.substr(0, pos), headers.get_allocator().resource());
+		for (auto& c : key) c = tolower(c); // 请求头名称不区分大小写，统一存为小写
+		headers[std::move(key)] = line.substr(pos + 2); // 存储键值对到headers字典
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*************************************************************************
+	> File Name: HttpResponse.h
+	> Author: 
+	> Mail: 
+	> Created Time: Sat 24 May 2025 04:32:07 PM CST
+ ************************************************************************/
+
+//http_response.h
+#pragma once
+#ifndef _HTTPRESPONSE_H
+#define _HTTPRESPONSE_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory_resource>
+#include <charconv>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <strings.h>
+
+#include "Arena.h"
+
+class HttpResponse {
+public:
+	using HeaderMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+
+	// 流式响应体的产生器：每次调用向 chunk 追加下一段数据，返回false表示已经结束（本次追加的数据仍会发送）。
+	// 请求处理完之后才会被调用（可能在另一个工作线程中），不能引用请求对象或请求内存池中的数据
+	using BodyProducer = std::function<bool(std::string& chunk)>;
+
+	// 响应头与响应体从 mr 分配，默认为当前请求的内存池（见 Arena）；
+	// 需要保存到请求结束之后的响应应使用堆，或用下面的构造函数复制一份
+	explicit HttpResponse(int code = 200, std::pmr::memory_resource* mr = Arena::resource())
+		: statusCode(code), headers(mr), body(mr) {}
+
+	// 把响应复制到 mr 中
+	HttpResponse(const HttpResponse& other, std::pmr::memory_resource* mr)
+		: statusCode(other.statusCode), headers(other.headers, mr), body(other.body, mr), stream(other.stream) {}
+
+	// 默认的复制使用全局堆（pmr容器的复制不继承内存池），移动则保留原内存池
+	HttpResponse(const HttpResponse&) = default;
+	HttpResponse(HttpResponse&&) = default;
+	HttpResponse& operator=(const HttpResponse&) = default;
+	HttpResponse& operator=(HttpResponse&&) = default;
+
+	void setStatusCode(int code) {
+		statusCode = code;
+	}
+
+	void setHeader(std::string_view name, std::string_view value) {
+		std::pmr::string key(name, headers.get_allocator().resource());
+		auto it = headers.find(key);
+		if (it == headers.end()) {
+			headers.emplace(std::move(key), value);
+		} else {
+			it->second = value;
+		}
+	}
+
+	void setBody(std::string_view b) {
+		body = b;
+	}
+
+	// 以流式方式发送响应体：HTTP/1.1 使用 chunked 编码，发送缓冲区发完（套接字可写）时才向 producer 取下一段，
+	// 每个响应在内存中只保留一段数据。producer 可以是任何 bool(std::string&) 的可调用对象，包括 Generator<std::string>
+	template <class Producer>
+	void setStream(Producer producer) {
+		body.clear();
+		if constexpr (std::is_copy_constructible_v<Producer>) {
+			stream = std::move(producer);
+		} else { // 只能移动的产生器（例如生成器协程）放到共享的堆对象里
+			stream = [shared = std::make_shared<Producer>(std::move(producer))](std::string& chunk) { return (*shared)(chunk); };
+		}
+	}
+
+	bool isStreaming() const {
+		return static_cast<bool>(stream);
+	}
+
+	// 取出产生器交给连接，之后响应对象本身不再是流式的
+	BodyProducer takeStream() {
+		return std::exchange(stream, nullptr);
+	}
+
+	int getStatusCode() const {
+		return statusCode;
+	}
+
+	std::string_view getBody() const {
+		return body;
+	}
+
+	const HeaderMap& getHeaders() const {
+		return headers;
+	}
+
+	// 按名称查找响应头（不区分大小写），没有时返回空
+	std::string_view getHeader(std::string_view name) const {
+		for (const auto& header: headers) {
+			if (header.first.size() == name.size() && strncasecmp(header.first.data(), name.data(), name.size()) == 0) return header.second;
+		}
+		return std::string_view();
+	}
+
+	// 响应占用的大致字节数（响应头与响应体），用于缓存的内存统计
+	size_t byteSize() const {
+		size_t bytes = sizeof(*this) + body.size();
+		for (const auto& header: headers) {
+			bytes += header.first.size() + header.second.size();
+		}
+		return bytes;
+	}
+
+	// 把响应序列化追加到 out 末尾（连接的发送缓冲区复用容量，不产生新的分配）
+	void appendTo(std::string& out) const {
+		appendHead(out);
+		out += body;
+	}
+
+	// 只追加状态行与响应头；chunked 为true时以 Transfer-Encoding: chunked 代替 Content-Length，响应体由调用方分块写入。
+	// 流式响应不使用 chunked 编码时（HTTP/1.0）没有 Content-Length，以关闭连接表示响应体结束
+	void appendHead(std::string& out, bool chunked = false) const {
+		char number[24];
+		out += "HTTP/1.1 ";
+		out.append(number, std::to_chars(number, number + sizeof(number), statusCode).ptr);
+		out += ' ';
+		out += getStatusMessage();
+		out += "\r\n";
+		// 添加其他响应头
+		for (const auto& header: headers) {
+			out += header.first;
+			out += ": ";
+			out += header.second;
+			out += "\r\n";
+		}
+		// 连接保持打开时客户端依靠Content-Length判断响应体的结束位置（1xx、204与304响应没有响应体）
+		if (chunked) {
+			out += "Transfer-Encoding: chunked\r\n";
+		} else if (hasBody() && !stream && !headers.count(std::pmr::string("Content-Length", headers.get_allocator().resource()))) {
+			out += "Content-Length: ";
+			out.append(number, std::to_chars(number, number + sizeof(number), body.size()).ptr);
+			out += "\r\n";
+		}
+		// 添加空行分割响应头和响应体
+		out += "\r\n";
+	}
+
+	// 按状态码是否带有响应体
+	bool hasBody() const {
+		return statusCode >= 200 && statusCode != 204 && statusCode != 304;
+	}
+
+	//将响应转换为字符串
+	std::string toString() const {
+		std::string out;
+		appendTo(out);
+		return out;
+	}
+
+	// 创建一个包含错误信息的响应 ///
+	static HttpResponse makeErrorResponse(int code, std::string_view message) {
+		HttpResponse response(code);
+		response.setBody(message);
+		return response;
+	}
+
+	// 创建一个包含成功信息的响应 ///
+	static HttpResponse makeOkResponse(std::string_view message) {
+		HttpResponse response(200);
+		response.setBody(message);
+		return response;
+	}
+
+private:
+	int statusCode; // 响应状态码
+	HeaderMap headers; //响应头信息
+	std::pmr::string body; // 响应体
+	BodyProducer stream; // 流式响应体的产生器，为空表示响应体就是 body
+
+	const char* getStatusMessage() const {
+		switch (statusCode) {
+			case 101: return "Switching Protocols";
+			case 200: return "OK";
+			case 204: return "No Content";
+			case 304: return "Not Modified";
+			case 400: return "Bad Request";
+			case 401: return "Unauthorized";
+			case 404: return "Not Found";
+			case 413: return "Payload Too Large";
+			case 429: return "Too Many Requests";
+			case 431: return "Request Header Fields Too Large";
+			case 500: return "Internal Server Error";
+			case 503: return "Service Unavailable";
+			//其他
+
+			default: return "Unknown";
+		}
+
+	}
+};
+
+#endif
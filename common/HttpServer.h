@@ -0,0 +1,1655 @@
+/*************************************************************************
+	> File Name: HttpServer.h
+	> Author:
+	> Mail:
+	> Created Time: Sat 24 May 2025 04:32:24 PM CST
+ ************************************************************************/
+
+// #pragma once 是预处理命令，确保头文件在多次包含时只会编译一次，防止重复定义的问题
+#ifndef _HTTPSERVER_H
+#define _HTTPSERVER_H
+
+#include <stdlib.h> //引入标准库，用于通用工具函数
+#include <sys/socket.h> //引入socket编程接口
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <netinet/in.h> // 引入网络字节序转换函数
+#include <arpa/inet.h>
+#include <unistd.h> //引入UNIX标准函数库
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+#include "Logger.h"  //自定义日志模块
+#include "ThreadPool.h"  //引入线程池模块，用于并发处理客户端连接请求
+#include "Router.h" //引入路由模块，根据HTTP请求的方法和路径分发到不同的处理器
+#include "HttpRequest.h"  //引入HTTP请求解析类，用于解析客户端发送过来的请求数据
+#include "HttpResponse.h"  //引入HTTP响应构建类，用于构建服务端返回给客户端的响应数据
+#include "Database.h"  //引入库，提供与数据库交互的功能
+#include "DbExecutor.h"  //数据库执行器：SQLite调用在专用线程中执行
+#include "Transport.h"  //传输层策略（PlainTransport），TLS策略见TlsTransport.h
+#include "Overload.h"  //过载保护：准入控制、连接数上限与限流
+#include "Http2.h"  //HTTP/2帧处理与HPACK
+#include "WebSocket.h"  //WebSocket升级与帧处理
+#include "Timer.h"  //时间轮定时器
+#include "Buffer.h"  //按块分配、可增长的读缓冲区
+#include "Listener.h"  //监听地址：TCP（IPv4/IPv6）与Unix域套接字
+#include "Coroutine.h"  //协程处理函数
+#include "Compression.h"  //gzip/deflate响应压缩
+#include "Chunked.h"  //chunked传输编码
+#include "Multipart.h"  //流式上传
+#include "Trace.h"  //请求生命周期追踪
+#include "Probes.h"  //USDT静态探针
+#include "Profiler.h"  //热路径分段剖析（编译时打开）
+
+// HttpServer 通过模板参数 Transport 在编译期选择明文或TLS传输，
+// 两种服务器共用同一套事件循环、连接管理与请求处理逻辑
+template <class Transport>
+class HttpServer {
+public:
+	// 构造函数，初始化成员变量并传入参数（端口号，epoll的最大监听事件数以及数据库的引用），服务器自己创建数据库执行器。
+	// 其余参数原样转发给传输层策略的构造函数（例如TLS的证书与私钥路径）
+	template <class... TransportArgs>
+	HttpServer(int port, int max_events, Database& db, TransportArgs&&... transportArgs)
+		: epollfd(-1), max_events(max_events), port(port), idle_fd(-1), timer_fd(-1), event_fd(-1), db(db),
+		  ownedExecutor(new DbExecutor(db)), dbExecutor(*ownedExecutor),
+		  transport(std::forward<TransportArgs>(transportArgs)...) {
+		setOverloadOptions(OverloadOptions());
+	}
+
+	// 同一进程中的多个服务器共用一个数据库时必须共用它的执行器：一个 Database 只有一个SQLite连接，
+	// 两个执行器各自合并读事务会在同一个连接上交错 BEGIN/COMMIT。executor 必须比服务器活得久
+	template <class... TransportArgs>
+	HttpServer(int port, int max_events, DbExecutor& executor, TransportArgs&&... transportArgs)
+		: epollfd(-1), max_events(max_events), port(port), idle_fd(-1), timer_fd(-1), event_fd(-1), db(executor.getDatabase()),
+		  dbExecutor(executor), transport(std::forward<TransportArgs>(transportArgs)...) {
+		setOverloadOptions(OverloadOptions());
+	}
+
+	~HttpServer() {
+		if (epollfd != -1) close(epollfd);
+		for (const Listener& listener : listeners) {
+			if (listener.fd == -1) continue;
+			close(listener.fd);
+			if (listener.owned) listener.address.unlinkPath();
+		}
+		if (idle_fd != -1) close(idle_fd);
+		if (timer_fd != -1) close(timer_fd);
+		if (event_fd != -1) close(event_fd);
+	}
+
+	// 设置过载保护参数，需在 start() 之前调用
+	void setOverloadOptions(const OverloadOptions& options) {
+		overloadOptions = options;
+		admission.reset(new CoDelAdmission(options));
+		rateLimiter.reset(new RateLimiter(options));
+	}
+
+	// 设置通告给HTTP/2客户端的SETTINGS参数，需在 start() 之前调用
+	void setHttp2Options(const Http2Options& options) {
+		http2Options = options;
+	}
+
+	// 设置响应压缩的默认级别、最小长度与类型白名单，单个路由的级别用 Router::setCompressionLevel 设置
+	void setCompressionOptions(const CompressionOptions& options) {
+		compressionOptions = options;
+	}
+
+	// 设置请求追踪的采样比例与每个线程保留的记录数（进程内所有服务器共用）
+	void setTraceOptions(const TraceOptions& options) {
+		Tracer::setOptions(options);
+	}
+
+	// 设置数据库执行器的队列上限与读请求合并数（共用的执行器对所有服务器生效）
+	void setDbExecutorOptions(const DbExecutorOptions& options) {
+		dbExecutor.setOptions(options);
+	}
+
+	// 开发时从 dir 目录读取UI页面（修改后刷新即生效），不使用编译时嵌入的页面
+	void setAssetDirectory(const std::string& dir) {
+		router.getAssets().setOverrideDirectory(dir);
+	}
+
+	// 设置WebSocket参数，需在 start() 之前调用
+	void setWebSocketOptions(const WebSocketOptions& options) {
+		webSocketOptions = options;
+	}
+
+	// 设置登录会话参数，需在 start() 之前调用
+	void setSessionOptions(const SessionOptions& options) {
+		router.getSessions().setOptions(options);
+	}
+
+	// 设置无状态登录令牌的参数与密钥（"kid:secret,kid:secret"，第一个用于签发），需在 setupRoutes() 之前调用。
+	// 多个进程或主机使用相同的密钥即可互相校验对方签发的令牌
+	void setTokenOptions(const TokenOptions& options, const std::string& keys) {
+		router.getTokenSigner().setOptions(options);
+		router.getTokenSigner().loadKeys(keys);
+	}
+
+	// 添加监听地址，需在 start() 之前调用；可以多次调用同时监听多个地址（例如Unix域套接字与TCP端口），
+	// 调用过 listenOn 或 adoptListener 之后不再监听构造函数中的端口
+	void listenOn(const ListenAddress& address) {
+		Listener listener;
+		listener.address = address;
+		listeners.push_back(listener);
+	}
+
+	// 使用已经创建好的监听套接字（例如多进程模型中由主进程创建、SO_REUSEPORT的套接字），需在 start() 之前调用。
+	// 套接字的所有权交给服务器，start() 不再创建与绑定该套接字
+	void adoptListener(int fd) {
+		Listener listener;
+		listener.fd = fd;
+		listener.owned = false;
+		listeners.push_back(listener);
+	}
+
+	// 平滑退出：停止接受新连接，关闭空闲连接，其余连接处理完当前请求后关闭（WebSocket连接在下一次心跳时发送关闭帧），
+	// 全部关闭后 start() 返回。只做异步信号安全的操作，可以在信号处理函数中调用
+	void drain() {
+		draining = true;
+		if (event_fd != -1) {
+			uint64_t one = 1;
+			ssize_t n = write(event_fd, &one, sizeof(one)); // 唤醒事件循环
+			(void)n;
+		}
+	}
+
+	// 启动服务器方法，设置套接字、epoll，启动线程池并进入循环等待处理客户端连接；drain() 之后所有连接关闭时返回
+	void start() {
+		setupServerSockets(); // 创建并配置监听套接字
+		setupEpoll(); // 创建并配置epoll实例
+		setupLoopFds(); // 定时器与跨线程通知
+		idle_fd = open("/dev/null", O_RDONLY | O_CLOEXEC); // 预留一个fd，用于在fd耗尽时接受并关闭连接
+		pool.reset(new ThreadPool(16)); // 创建一个拥有16个工作线程的线程池以应对高并发场景
+		const SessionOptions& sessionOptions = router.getSessions().getOptions();
+		if (!sessionOptions.snapshotPath.empty()) {
+			router.getSessions().load(sessionOptions.snapshotPath); // 恢复重启前的登录会话
+		}
+		timers.schedule(&maintenanceTimer, kMaintenanceTicks);
+		Profiler::calibrate();
+		Profiler::installSignals(); // SIGUSR1 输出剖析表、SIGUSR2 清零（未打开剖析时什么都不做）
+
+		// 初始化epoll_event数组，用于存放epoll_wait返回的就绪事件
+		std::vector<struct epoll_event> events(max_events);
+
+		// 主循环，不断等待新的连接请求或已连接套接字上的读写事件
+		while (true) {
+			int nfds = epoll_wait(epollfd, events.data(), max_events, -1); // 等待epoll事件发生
+
+			// 遍历所有就绪事件
+			for (int i = 0; i < nfds; ++i) {
+				// 监听套接字的 data.ptr 指向 listeners 中对应的元素，定时器与通知fd的 data.ptr 指向对应的成员，
+				// 其余事件的 data.ptr 指向对应的 Connection
+				void* ptr = events[i].data.ptr;
+				if (Listener* listener = findListener(ptr)) {
+					acceptConnection(*listener);
+				} else if (ptr == &timer_fd) {
+					onTimerTick();
+				} else if (ptr == &event_fd) {
+					onNotify();
+				} else {
+					schedule(static_cast<Connection*>(ptr));
+				}
+			}
+			reapConnections(); // 本批事件都处理完后，才能释放其中可能引用到的已关闭连接
+			if (draining) {
+				if (!listeners.empty()) stopAccepting();
+				// 处理完请求后挂回空闲链表的连接立即关闭；刚接受、还没发来请求的连接再等一会儿，
+				// 否则退出前一刻接受的连接会在请求到达之前被关闭
+				closeIdleConnections(0, std::chrono::steady_clock::now() - drainStarted < std::chrono::seconds(kDrainGraceSeconds));
+				if (overloadStats.activeConnections == 0) break;
+			} else if (overloadOptions.memoryBudgetBytes > 0 && memory.total() > overloadOptions.memoryBudgetBytes) {
+				size_t closed = closeIdleConnections(overloadOptions.memoryBudgetBytes);
+				overloadStats.memoryShed += closed;
+				if (closed) LOG_WARNING("Memory budget exceeded, closed %zu idle connections", closed);
+			}
+		}
+		reapConnections();
+		if (!sessionOptions.snapshotPath.empty()) {
+			router.getSessions().save(sessionOptions.snapshotPath); // 新进程从快照恢复登录会话
+		}
+		LOG_INFO("%s server drained", Transport::name());
+	}
+	// 设置服务器路由映射表的方法
+	void setupRoutes() {
+		// 添加根路由处理器，返回简单的Hello World!响应
+		router.addRoute("GET", "/", [](const HttpRequest& req) {
+			HttpResponse response;
+			response.setStatusCode(200);
+			response.setBody("Helloworld!");
+			return response;
+		});
+		router.markIdempotent("GET", "/");
+
+		// 以文本形式导出过载保护与响应缓存的计数器；允许其他来源的监控页面跨域读取
+		auto metrics = Pipeline<Cors>().wrap([this](const HttpRequest&) {
+			const ResponseCache::Stats& cache = router.getCacheStats();
+			const SessionStore::Stats& sessions = router.getSessions().getStats();
+			std::ostringstream oss;
+			oss << "connections_accepted_total " << overloadStats.accepted << "\n"
+				<< "connections_active " << overloadStats.activeConnections << "\n"
+				<< "connections_rejected_total " << overloadStats.rejectedConnections << "\n"
+				<< "connections_fd_exhausted_total " << overloadStats.fdExhausted << "\n"
+				<< "connections_shed_memory_total " << overloadStats.memoryShed << "\n"
+				<< "requests_shed_total " << overloadStats.shedRequests << "\n"
+				<< "requests_rate_limited_total " << overloadStats.rateLimited << "\n"
+				<< "admission_overloaded " << admission->isOverloaded() << "\n"
+				<< "cache_hits_total " << cache.hits << "\n"
+				<< "cache_misses_total " << cache.misses << "\n"
+				<< "cache_stale_total " << cache.stale << "\n"
+				<< "cache_coalesced_total " << cache.coalesced << "\n"
+				<< "cache_evictions_total " << cache.evictions << "\n"
+				<< "http2_connections_total " << http2Connections << "\n"
+				<< "http2_streams_total " << http2Streams << "\n"
+				<< "sessions_active " << router.getSessions().size() << "\n"
+				<< "session_lookups_hit_total " << sessions.hits << "\n"
+				<< "session_lookups_miss_total " << sessions.misses << "\n"
+				<< "sessions_expired_total " << sessions.expired << "\n"
+				<< "sessions_evicted_total " << sessions.evicted << "\n"
+				<< "websocket_upgrades_total " << webSocketUpgrades << "\n"
+				<< "websocket_connections_active " << webSocketActive << "\n"
+				<< "async_requests_suspended_total " << asyncSuspended << "\n"
+				<< "async_requests_pending " << asyncPending << "\n"
+				<< "responses_streamed_total " << streamedResponses << "\n"
+				<< "requests_chunked_total " << chunkedRequests << "\n"
+				<< "uploads_total " << uploads << "\n"
+				<< "upload_bytes_total " << uploadBytes << "\n"
+				<< "upload_bytes_spliced_total " << uploadBytesSpliced << "\n"
+				<< "read_buffer_bytes_allocated " << BufferPool::chunksAllocated() * BufferPool::kChunkSize << "\n";
+			memory.writeMetrics(oss);
+			dbExecutor.writeMetrics(oss);
+			Compressor::writeMetrics(oss);
+			Tracer::writeMetrics(oss);
+			{
+				std::lock_guard<std::mutex> lock(idleMutex);
+				oss << "memory_budget_bytes " << overloadOptions.memoryBudgetBytes << "\n"
+					<< "connection_struct_bytes " << sizeof(Connection) << "\n"
+					<< "connections_idle " << idleCount << "\n"
+					<< "idle_connection_bytes_avg " << (idleCount ? idleBytes / idleCount : 0) << "\n";
+			}
+			transport.writeMetrics(oss);
+			HttpResponse response;
+			response.setHeader("Content-Type", "text/plain");
+			response.setBody(oss.str());
+			return response;
+		});
+		router.addRoute("GET", "/metrics", metrics);
+		router.addRoute("OPTIONS", "/metrics", metrics); // 预检请求由 Cors 直接回复
+		router.setCompressionLevel("GET", "/metrics", 1); // 监控频繁抓取，用最快的压缩级别
+
+		// 导出被追踪请求的记录（Chrome trace-event JSON，用 chrome://tracing 或 ui.perfetto.dev 打开）；
+		// ?id=<X-Trace-Id> 只导出一个请求。记录中有请求路径与对端地址，只对可信对端开放
+		router.addRoute("GET", "/debug/trace", [](const HttpRequest& req) {
+			std::string_view id;
+			req.queryParams().extract({{"id", &id}});
+			std::ostringstream oss;
+			Tracer::dump(oss, id.empty() ? 0 : strtoull(std::string(id).c_str(), nullptr, 16));
+			HttpResponse response;
+			response.setHeader("Content-Type", "application/json");
+			response.setBody(oss.str());
+			return response;
+		});
+		router.markTrustedOnly("GET", "/debug/trace");
+
+		// 上传示例：multipart/form-data 的文件部分边接收边写入 uploads/ 下的临时文件，其他类型的请求体整体作为一个文件
+		// （明文连接上经 splice 写入）。回复每个部分的名称、文件名与大小；示例不保留文件，请求结束后临时文件被删除
+		UploadHandler upload;
+		upload.onPart = [](const HttpRequest&, UploadPart& part) {
+			LOG_INFO("Upload part '%s' (%s): %zu bytes", part.name.c_str(), part.filename.c_str(), part.size);
+		};
+		upload.onComplete = [](const HttpRequest&, std::vector<UploadPart>& parts) {
+			std::ostringstream oss;
+			for (const UploadPart& part : parts) {
+				oss << part.name << "\t" << part.filename << "\t" << part.size << "\n";
+			}
+			HttpResponse response = HttpResponse::makeOkResponse(oss.str());
+			response.setHeader("Content-Type", "text/plain; charset=utf-8");
+			return response;
+		};
+		router.addUploadRoute("/upload", upload);
+
+		// 设置与数据库相关的路由，数据库调用经执行器在专用线程中执行
+		router.setupDatabaseRoutes(dbExecutor);
+		LOG_INFO("%s routes setup completed.", Transport::name());
+	}
+
+private:
+	struct Connection;
+
+	// 挂起中的协程请求：原始请求复制到堆上，请求对象与协程中的临时对象分配在自己的内存池中，
+	// 协程因此可以在任意工作线程中恢复。co_await 的操作完成后 post 经事件循环重新调度连接，
+	// 连接在协程完成之前不会被释放（closeConnection 推迟到协程完成后）
+	struct PendingRequest : Resumer {
+		HttpServer* server;
+		Connection* conn;
+		Arena arena;
+		std::string raw;
+		std::optional<HttpRequest> request;
+		Task<HttpResponse> task;
+		std::atomic<void*> ready{nullptr}; // 可以恢复的协程
+		uint64_t trace = 0; // 正在追踪的请求，协程每次恢复时设为当前线程的追踪ID
+		uint64_t requestStart = 0, handlerStart = 0; // 被追踪时：开始解析请求、开始执行处理函数的时间
+
+		PendingRequest(HttpServer* server, Connection* conn, std::string_view raw)
+			: server(server), conn(conn), arena(4096), raw(raw) {}
+
+		void post(std::coroutine_handle<> handle) override {
+			ready.store(handle.address(), std::memory_order_release);
+			conn->wakeups++; // 通知送达之前连接对象不能释放
+			server->notifyLoop(conn, nullptr);
+		}
+	};
+
+	// 正在接收 chunked 请求体的请求：请求头之后直接追加解码出的请求体，收完后 raw 就是一个普通的请求
+	struct ChunkedRequest {
+		std::string raw;
+		ChunkedDecoder decoder;
+
+		ChunkedRequest(std::string_view head, size_t maxBody, size_t maxTrailer) : raw(head), decoder(maxBody, maxTrailer) {}
+	};
+
+	// 正在接收的上传请求（见 Multipart.h）：请求头解析后保存在这里，请求体边到达边交给 UploadReceiver，
+	// 读缓冲区不保留请求体
+	struct UploadState {
+		HttpRequest request{std::pmr::new_delete_resource()}; // 跨越多次处理，不能分配在请求内存池中
+		std::optional<UploadReceiver> receiver;
+		size_t remaining = 0; // Content-Length 请求体中尚未收到的字节数
+		std::unique_ptr<ChunkedDecoder> chunked; // chunked 请求体的解码器
+		int pipe[2] = {-1, -1}; // splice 使用的管道，第一次 splice 时创建
+
+		~UploadState() {
+			if (pipe[0] != -1) {
+				::close(pipe[0]);
+				::close(pipe[1]);
+			}
+		}
+	};
+
+	// 每个客户端连接的状态，由epoll事件的 data.ptr 携带
+	struct Connection {
+		int fd;
+		std::string clientIp; // 对端IP，用于按IP限流
+		bool trusted = false; // 对端是否可信（TraceOptions::trustedAddresses）
+		std::chrono::steady_clock::time_point queuedAt; // 最近一次交给线程池的时间
+		std::chrono::steady_clock::time_point dequeuedAt; // 工作线程开始处理的时间
+		uint64_t acceptedAt = 0, handshakeStart = 0, handshakeEnd = 0; // 接受连接与TLS握手的时间（Tracer::now()）
+		bool connectionTraced = false; // 连接建立的阶段已经记入某个被追踪的请求
+		uint64_t traceId = 0; // 发送缓冲区中有被追踪请求的响应，发送记为该请求的 write 段
+		typename Transport::Session session; // 传输层状态（TLS连接为SSL对象）
+		bool handshaked = !Transport::needsHandshake; // 传输层握手是否已完成
+		std::string output; // 尚未发送完的响应数据
+		size_t outputOffset = 0; // output 中已发送的字节数
+		ChainBuffer input; // 已读到但尚未处理的数据（不完整的请求、0-RTT中推迟的请求），空闲时不占内存
+		std::unique_ptr<Http2Session> http2; // 协商为HTTP/2后的帧处理状态，为空表示HTTP/1.1
+		std::unique_ptr<WebSocketSession> ws; // 升级为WebSocket后的状态，连接释放前不会被重置
+		std::atomic<int> scheduled{0}; // 已触发但尚未处理的次数，大于0时有且只有一个工作线程在处理该连接
+		std::atomic<bool> closed{false}; // 已关闭，等待事件循环线程释放
+		TimerNode timer; // 心跳定时器，只由事件循环线程访问
+		ConnectionMemory memory; // 上次计入合计的内存用量
+		Connection* idlePrev = nullptr; // 空闲链表中的前后连接，由 idleMutex 保护
+		Connection* idleNext = nullptr;
+		bool parked = false; // 是否在空闲链表中
+		bool served = false; // 是否读到过客户端的数据
+		std::unique_ptr<PendingRequest> pending; // 挂起中的协程请求，完成前连接暂停读取
+		bool closeAfterResume = false; // 协程挂起期间发送失败，协程完成后关闭
+		std::atomic<int> wakeups{0}; // 通知队列中尚未处理的协程恢复通知
+		std::unique_ptr<ChunkedRequest> chunkedRequest; // 请求体尚未收全的 chunked 请求
+		std::unique_ptr<UploadState> upload; // 请求体尚未收全的上传请求
+		HttpResponse::BodyProducer stream; // 正在发送的流式响应体，发送缓冲区发完后才取下一段
+		bool streamChunked = false; // 流式响应使用 chunked 编码；为false时（HTTP/1.0）发送完后关闭连接
+		bool closeAfterStream = false; // 流式响应以关闭连接结束，发送缓冲区发完后关闭
+	};
+
+    // 成员变量：服务器套接字文件描述符、epoll实例的文件描述符、epoll最大监听事件数、监听端口号
+	// 一个监听套接字，start() 之后不再增删，epoll事件的 data.ptr 指向它
+	struct Listener {
+		int fd = -1;
+		ListenAddress address; // listenOn 添加的地址，由服务器创建
+		bool owned = true; // 由服务器创建（关闭时删除Unix域套接字文件）；adoptListener 传入的为false
+		std::string name; // 用于日志
+	};
+
+    // 成员变量：监听套接字、epoll实例的文件描述符、epoll最大监听事件数、未指定监听地址时监听的端口号
+	std::vector<Listener> listeners;
+    int epollfd, max_events, port;
+	int idle_fd; // 预留的空闲fd，accept遇到EMFILE时释放它来接受并关闭新连接
+	int timer_fd; // 驱动时间轮的timerfd
+	int event_fd; // 其他线程通知事件循环的eventfd
+    Router router; // Router对象用于处理HTTP请求的路由分发
+    Database& db; // 数据库引用，用于访问和操作数据库 ///
+	std::unique_ptr<DbExecutor> ownedExecutor; // 由本服务器创建的执行器，共用其他执行器时为空
+	DbExecutor& dbExecutor; // 执行数据库调用的专用线程与提交队列
+	Transport transport; // 传输层策略对象（TLS策略持有SSL上下文）
+	OverloadOptions overloadOptions; // 过载保护参数
+	OverloadStats overloadStats; // 过载保护计数器
+	std::unique_ptr<CoDelAdmission> admission; // 基于排队时延的准入控制
+	std::unique_ptr<RateLimiter> rateLimiter; // 按客户端IP的令牌桶限流
+	Http2Options http2Options; // HTTP/2的SETTINGS参数
+	std::atomic<uint64_t> http2Connections{0}, http2Streams{0}; // HTTP/2连接数与请求（流）数
+	TimerWheel timers; // 只由事件循环线程访问
+	static const int kTickMs = 100; // 时间轮的tick
+	static const int kMaintenanceTicks = 1000 / kTickMs;
+	static const int kReadChunks = 4; // 一次readv最多填入的内存块数
+	static const size_t kMaxHeaderBytes = 64 * 1024; // 请求头的上限，超出返回431
+	static const size_t kMaxBodyBytes = 16 * 1024 * 1024; // 请求体的上限，超出返回413
+	static const size_t kStreamChunkBytes = 16384; // 每次向流式响应的产生器取的数据量
+	static const size_t kSpliceBytes = 65536; // 每次 splice 的上限，不超过管道的默认容量
+	TimerNode maintenanceTimer; // 周期性维护任务（会话过期与快照）
+	int secondsSinceSnapshot = 0;
+	std::atomic<bool> snapshotRunning{false};
+	std::atomic<bool> draining{false}; // drain() 之后为true
+	std::chrono::steady_clock::time_point drainStarted; // 停止接受新连接的时间
+	static constexpr int kDrainGraceSeconds = 2; // 平滑退出时等待新连接发来第一个请求的时间
+	WebSocketOptions webSocketOptions; // WebSocket参数
+	CompressionOptions compressionOptions; // 响应压缩参数
+	std::atomic<uint64_t> webSocketUpgrades{0}, webSocketActive{0};
+	std::atomic<uint64_t> asyncSuspended{0}, asyncPending{0}; // 挂起过的协程请求数、当前挂起中的协程请求数
+	std::atomic<uint64_t> streamedResponses{0}, chunkedRequests{0}; // 流式发送的响应数、chunked 编码的请求数
+	std::atomic<uint64_t> uploads{0}, uploadBytes{0}, uploadBytesSpliced{0}; // 上传请求数、上传请求体字节数（其中经 splice 写入文件的部分）
+	std::mutex notifyMutex;
+	std::vector<std::pair<Connection*, WebSocketPtr> > notifyQueue; // 有消息待发送的WebSocket连接
+	MemoryAccounting memory; // 所有连接的内存合计
+	std::mutex idleMutex;
+	Connection* idleHead = nullptr; // 空闲连接链表，表头是最久没有活动的连接
+	Connection* idleTail = nullptr;
+	size_t idleCount = 0, idleBytes = 0; // 空闲连接数及其内存合计
+	std::mutex graveyardMutex;
+	std::vector<Connection*> graveyard; // 已关闭、等待事件循环线程释放的连接
+	std::unique_ptr<ThreadPool> pool; // 处理连接的工作线程，最后声明以便最先析构（工作线程会用到上面的成员）
+
+    // 设置监听套接字：没有指定地址时监听构造函数中的端口；创建地址对应的套接字，接管的套接字只需设为非阻塞
+	void setupServerSockets() {
+		if (listeners.empty()) listenOn(ListenAddress::tcp(port));
+		for (Listener& listener : listeners) {
+			if (listener.fd == -1) {
+				listener.fd = listener.address.open(false);
+				listener.name = listener.address.toString();
+				LOG_INFO("%s server listening on %s", Transport::name(), listener.name.c_str());
+			} else {
+				listener.name = ListenAddress::describe(listener.fd);
+				LOG_INFO("%s server listening on %s (inherited socket)", Transport::name(), listener.name.c_str());
+			}
+			// 设置监听套接字为非阻塞模式
+			setNonBlocking(listener.fd);
+		}
+	}
+
+	Listener* findListener(void* ptr) {
+		for (Listener& listener : listeners) {
+			if (ptr == &listener) return &listener;
+		}
+		return nullptr;
+	}
+
+	void setupEpoll() {
+		// 创建epoll实例
+		epollfd = epoll_create1(0); // 创建一个新的epoll实例
+		if (epollfd == -1) {
+			LOG_ERROR("epoll_create1 failed");
+			throw std::runtime_error("epoll_create1 failed");
+		}
+		LOG_INFO("Epoll instance created with fd %d", epollfd);
+		// 初始化epoll_event结构体，注册对每个监听套接字的EPOLLIN | EPOLLET事件监听
+		for (Listener& listener : listeners) {
+			struct epoll_event event = {};
+			// 配置监听套接字的epoll事件
+			event.events = EPOLLIN | EPOLLET; // 监听可读事件并启用边缘触发
+			event.data.ptr = &listener; // 指向监听套接字，accept时据此区分
+			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, listener.fd, &event) == -1) {
+				LOG_ERROR("Failed to add listener %s to epoll", listener.name.c_str());
+				throw std::runtime_error("epoll_ctl failed");
+			}
+		}
+		LOG_INFO("Server sockets added to epoll instance");
+	}
+
+	// 创建驱动时间轮的timerfd与跨线程通知用的eventfd，并加入epoll
+	void setupLoopFds() {
+		timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (timer_fd == -1 || event_fd == -1) {
+			LOG_ERROR("timerfd/eventfd creation failed: %s", strerror(errno));
+			throw std::runtime_error("timerfd/eventfd failed");
+		}
+		struct itimerspec spec = {};
+		spec.it_interval.tv_nsec = kTickMs * 1000000L;
+		spec.it_value = spec.it_interval;
+		timerfd_settime(timer_fd, 0, &spec, nullptr);
+
+		int fds[] = {timer_fd, event_fd};
+		for (int& fd : fds) {
+			struct epoll_event event = {};
+			event.events = EPOLLIN; // 水平触发，读出计数后才会清除
+			event.data.ptr = (fd == timer_fd) ? static_cast<void*>(&timer_fd) : static_cast<void*>(&event_fd);
+			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &event) == -1) {
+				LOG_ERROR("Failed to add timer/event fd to epoll");
+				throw std::runtime_error("epoll_ctl failed");
+			}
+		}
+	}
+
+	// 把连接交给工作线程处理。同一连接可能同时被epoll事件、定时器和推送触发，
+	// 只有计数从0变为1的那次触发会入队，正在处理该连接的工作线程结束前会把期间的触发一并处理掉
+	void schedule(Connection* conn) {
+		if (conn->closed) return;
+		if (conn->scheduled.fetch_add(1) != 0) return;
+		conn->queuedAt = std::chrono::steady_clock::now(); // 记录入队时间，用于计算排队时延
+		pool->post([conn, this]() {
+			conn->dequeuedAt = std::chrono::steady_clock::now();
+			bool shed = this->admission->shouldShed(conn->dequeuedAt - conn->queuedAt);
+			if (shed && !conn->ws && !conn->pending && !conn->stream) {
+				this->shedConnection(conn); // 排队过久，快速返回503（已建立的WebSocket连接与发送到一半的流式响应不受影响）
+				return ;
+			}
+			int pending = conn->scheduled.load();
+			while (true) {
+				this->handleConnection(conn);
+				if (conn->closed) return; // 连接已交给事件循环线程释放，计数不再归零，也就不会再被调度
+				int remaining = conn->scheduled.fetch_sub(pending) - pending;
+				if (remaining == 0) return;
+				pending = remaining;
+			}
+		});
+	}
+
+	// 时间轮前进，到期的WebSocket连接标记需要心跳后交给工作线程
+	void onTimerTick() {
+		uint64_t expirations = 0;
+		if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+		timers.advance(expirations, [this](TimerNode* node) {
+			if (node == &maintenanceTimer) {
+				runMaintenance();
+				timers.schedule(node, kMaintenanceTicks);
+				return ;
+			}
+			Connection* conn = static_cast<Connection*>(node->owner);
+			if (conn->closed) return;
+			conn->ws->pingDue = true;
+			timers.schedule(node, pingTicks());
+			schedule(conn);
+		});
+	}
+
+	// 每秒执行一次的维护任务：清理过期会话，按配置的间隔把会话快照交给工作线程写盘
+	void runMaintenance() {
+		Profiler::poll();
+		SessionStore& sessions = router.getSessions();
+		sessions.expire();
+		const SessionOptions& options = sessions.getOptions();
+		if (options.snapshotPath.empty() || ++secondsSinceSnapshot < options.snapshotIntervalSeconds) return;
+		secondsSinceSnapshot = 0;
+		if (snapshotRunning.exchange(true)) return; // 上一次快照还没写完
+		pool->enqueue([this, &sessions]() {
+			sessions.save(sessions.getOptions().snapshotPath);
+			snapshotRunning = false;
+		});
+	}
+
+	uint64_t pingTicks() const {
+		return uint64_t(webSocketOptions.pingIntervalSeconds) * 1000 / kTickMs;
+	}
+
+	// 任意线程：通知事件循环该WebSocket连接有消息要发送（channel 为空时为协程请求可以恢复）
+	void notifyLoop(Connection* conn, const WebSocketPtr& channel) {
+		bool wasEmpty;
+		{
+			std::lock_guard<std::mutex> lock(notifyMutex);
+			wasEmpty = notifyQueue.empty();
+			notifyQueue.emplace_back(conn, channel);
+		}
+		if (wasEmpty) {
+			uint64_t one = 1;
+			if (write(event_fd, &one, sizeof(one)) < 0) LOG_ERROR("eventfd write failed: %s", strerror(errno));
+		}
+	}
+
+	// 事件循环线程：处理通知队列。连接只在事件循环线程中释放，
+	// 因此这里看到通道仍然打开（或协程请求仍挂起）时，连接一定还没有被释放
+	void onNotify() {
+		uint64_t count;
+		if (read(event_fd, &count, sizeof(count)) < 0) return;
+		std::vector<std::pair<Connection*, WebSocketPtr> > pending;
+		{
+			std::lock_guard<std::mutex> lock(notifyMutex);
+			pending.swap(notifyQueue);
+		}
+		for (auto& entry : pending) {
+			Connection* conn = entry.first;
+			if (!entry.second) {
+				conn->wakeups--; // 协程可以恢复（连接已关闭时 schedule 直接返回）
+				schedule(conn);
+				continue;
+			}
+			if (!entry.second->isOpen()) continue;
+			if (!conn->timer.scheduled() && webSocketOptions.pingIntervalSeconds > 0) {
+				timers.schedule(&conn->timer, pingTicks()); // 刚完成升级的连接：启动心跳
+			}
+			schedule(conn);
+		}
+	}
+
+	// 事件循环线程：释放已关闭的连接
+	void reapConnections() {
+		std::vector<Connection*> dead;
+		{
+			std::lock_guard<std::mutex> lock(graveyardMutex);
+			if (graveyard.empty()) return;
+			dead.swap(graveyard);
+		}
+		std::vector<Connection*> later;
+		for (Connection* conn : dead) {
+			if (conn->wakeups > 0) {
+				later.push_back(conn); // 还有协程恢复通知未处理，下一轮再释放
+				continue;
+			}
+			timers.cancel(&conn->timer);
+			delete conn;
+		}
+		if (!later.empty()) {
+			std::lock_guard<std::mutex> lock(graveyardMutex);
+			graveyard.insert(graveyard.end(), later.begin(), later.end());
+		}
+	}
+
+	// 事件循环线程：平滑退出时不再接受新连接。新连接由同一地址上其他进程的套接字接受
+	void stopAccepting() {
+		for (Listener& listener : listeners) {
+			epoll_ctl(epollfd, EPOLL_CTL_DEL, listener.fd, nullptr);
+			close(listener.fd);
+			if (listener.owned) listener.address.unlinkPath();
+		}
+		listeners.clear();
+		drainStarted = std::chrono::steady_clock::now();
+		LOG_INFO("%s server draining %llu connections", Transport::name(),
+			(unsigned long long)overloadStats.activeConnections.load());
+	}
+
+	// 事件循环线程：从最久没有活动的空闲连接开始关闭，直到内存合计不超过 budget；返回关闭的连接数。
+	// 只关闭能把调度计数从0改为1的连接：这样就取得了连接的处理权，不会与工作线程同时访问它。
+	// keepFresh 为true时跳过还没发来任何数据的连接
+	size_t closeIdleConnections(size_t budget, bool keepFresh = false) {
+		std::vector<Connection*> victims;
+		{
+			std::lock_guard<std::mutex> lock(idleMutex);
+			size_t total = memory.total();
+			Connection* conn = idleHead;
+			while (conn && (total > budget || budget == 0)) {
+				Connection* next = conn->idleNext;
+				int expected = 0;
+				if ((!keepFresh || conn->served) && conn->scheduled.compare_exchange_strong(expected, 1)) {
+					unlinkIdle(conn);
+					total -= std::min(total, conn->memory.total());
+					victims.push_back(conn);
+				}
+				conn = next;
+			}
+		}
+		for (Connection* conn : victims) closeConnection(conn);
+		return victims.size();
+	}
+
+	// 统计连接当前占用的内存，并把变化量计入合计
+	void accountMemory(Connection* conn) {
+		ConnectionMemory now;
+		now.connection = sizeof(Connection);
+		now.tls = transport.memoryUsage(conn->session);
+		now.readBuffer = conn->input.memoryUsage();
+		now.writeQueue = conn->output.capacity() > std::string().capacity() ? conn->output.capacity() : 0;
+		if (conn->ws) {
+			now.writeQueue += conn->ws->queueMemory();
+			now.parser += conn->ws->parserMemory();
+		}
+		if (conn->http2) now.parser += conn->http2->memoryUsage();
+		if (conn->pending) now.parser += sizeof(PendingRequest) + conn->pending->raw.capacity() + conn->pending->arena.bytesRetained();
+		if (conn->chunkedRequest) now.parser += sizeof(ChunkedRequest) + conn->chunkedRequest->raw.capacity();
+		if (conn->upload) now.parser += sizeof(UploadState);
+		memory.update(conn->memory, now);
+	}
+
+	// 连接在等待对端的下一个请求，没有未处理的输入，也没有未发出的输出
+	// （WebSocket连接、挂起协程请求、正在接收 chunked 请求体或上传、发送流式响应的连接不算空闲）
+	bool isIdle(Connection* conn) const {
+		return !conn->ws && !conn->pending && !conn->chunkedRequest && !conn->upload && !conn->stream && conn->input.empty() && conn->output.empty() &&
+			(!conn->http2 || conn->http2->idle());
+	}
+
+	// 把空闲连接挂到空闲链表的末尾，内存超出预算时按进入链表的先后关闭
+	void park(Connection* conn) {
+		std::lock_guard<std::mutex> lock(idleMutex);
+		conn->idlePrev = idleTail;
+		conn->idleNext = nullptr;
+		if (idleTail) idleTail->idleNext = conn;
+		else idleHead = conn;
+		idleTail = conn;
+		conn->parked = true;
+		idleCount++;
+		idleBytes += conn->memory.total();
+	}
+
+	// 连接重新开始处理时从空闲链表中取下
+	void unpark(Connection* conn) {
+		std::lock_guard<std::mutex> lock(idleMutex);
+		if (conn->parked) unlinkIdle(conn);
+	}
+
+	// 调用方需持有 idleMutex
+	void unlinkIdle(Connection* conn) {
+		if (conn->idlePrev) conn->idlePrev->idleNext = conn->idleNext;
+		else idleHead = conn->idleNext;
+		if (conn->idleNext) conn->idleNext->idlePrev = conn->idlePrev;
+		else idleTail = conn->idlePrev;
+		conn->idlePrev = conn->idleNext = nullptr;
+		conn->parked = false;
+		idleCount--;
+		idleBytes -= conn->memory.total();
+	}
+
+	// 接收新连接的方法，为连接创建传输层状态并放入epoll监听列表中
+	void acceptConnection(Listener& listener) {
+		struct sockaddr_storage client_addr; // IPv4、IPv6或Unix域套接字的对端地址
+		socklen_t client_addrlen = sizeof(client_addr);
+		int client_fd;
+
+		// 循环接受所有到达的连接请求（边缘触发，必须一直accept到EAGAIN）
+		while (true) {
+			client_addrlen = sizeof(client_addr);
+			client_fd = accept(listener.fd, (struct sockaddr *)&client_addr, &client_addrlen);
+			if (client_fd < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+				if (errno == EINTR || errno == ECONNABORTED) continue;
+				if ((errno == EMFILE || errno == ENFILE) && idle_fd != -1) {
+					// fd耗尽：连接会一直留在backlog中，边缘触发下不会再次通知。
+					// 释放预留fd，接受并立即关闭该连接，再重新预留
+					// （fd耗尽时即使backlog为空accept也返回EMFILE，需以这里的accept结果判断是否继续）
+					close(idle_fd);
+					int fd = accept(listener.fd, nullptr, nullptr);
+					if (fd >= 0) close(fd);
+					idle_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+					if (fd < 0) break;
+					overloadStats.fdExhausted++;
+					LOG_WARNING("File descriptors exhausted, dropped a new connection");
+					continue;
+				}
+				LOG_ERROR("Accept failed: %s", strerror(errno)); // 如果接受连接失败，记录错误日志
+				break;
+			}
+			if (overloadStats.activeConnections >= (uint64_t)overloadOptions.maxConnections) {
+				close(client_fd); // 超过连接数上限，直接关闭
+				overloadStats.rejectedConnections++;
+				continue;
+			}
+			LOG_INFO("Accepted new connection, fd: %d", client_fd); // 日志记录新连接的文件描述符
+			PROBE1(accept, client_fd);
+            setNonBlocking(client_fd); // 将新接受的客户端套接字设置为非阻塞模式
+
+			Connection* conn = new Connection();
+			conn->fd = client_fd;
+			conn->timer.owner = conn;
+			conn->acceptedAt = Tracer::now();
+			conn->clientIp = ListenAddress::peerName(client_addr, client_addrlen); // Unix域套接字上的连接都来自本机代理，记为 "unix"
+			conn->trusted = Tracer::getOptions().trusts(conn->clientIp);
+			if (!transport.open(conn->session, client_fd)) {
+				close(client_fd);
+				delete conn;
+				continue;
+			}
+			overloadStats.accepted++;
+			overloadStats.activeConnections++;
+			accountMemory(conn);
+			park(conn); // 在客户端发来第一批数据之前也算空闲
+
+			// 握手和请求处理都交给工作线程，这里只等待客户端的第一批数据
+			struct epoll_event event = {};
+			event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+			event.data.ptr = conn;
+			if (epoll_ctl(epollfd, EPOLL_CTL_ADD, client_fd, &event) != 0) {
+				LOG_ERROR("Epoll_ctl ADD failed: %s", strerror(errno));
+				closeConnection(conn);
+			}
+		}
+	}
+
+	// 重新注册连接的事件（EPOLLONESHOT在每次触发后需要重新激活）
+	void rearm(Connection* conn, IoStatus waitFor) {
+		struct epoll_event event = {};
+		event.events = (waitFor == IO_WANT_WRITE ? EPOLLOUT : EPOLLIN) | EPOLLET | EPOLLONESHOT;
+		event.data.ptr = conn;
+		if (epoll_ctl(epollfd, EPOLL_CTL_MOD, conn->fd, &event) != 0) {
+			LOG_ERROR("Epoll_ctl MOD failed for fd %d: %s", conn->fd, strerror(errno));
+			closeConnection(conn);
+		}
+	}
+
+	// 释放传输层状态并关闭客户端连接；Connection 对象交给事件循环线程释放，
+	// 因为它可能仍被本批epoll事件、时间轮或通知队列引用
+	void closeConnection(Connection* conn) {
+		if (conn->pending) {
+			conn->closeAfterResume = true; // 协程还会经 post 访问连接，完成后再关闭
+			return ;
+		}
+		if (conn->ws) {
+			conn->ws->closed();
+			webSocketActive--;
+		}
+		unpark(conn);
+		conn->input.clear(); // 内存块还给当前线程的池
+		conn->chunkedRequest.reset();
+		conn->upload.reset(); // 未收完的上传删除临时文件
+		conn->stream = nullptr;
+		transport.close(conn->session);
+		memory.remove(conn->memory);
+		close(conn->fd); // 关闭fd时内核会自动将其从epoll中移除
+		LOG_INFO("Closed connection on fd %d", conn->fd);
+		overloadStats.activeConnections--;
+		conn->closed = true;
+		std::lock_guard<std::mutex> lock(graveyardMutex);
+		graveyard.push_back(conn);
+	}
+
+	// 过载时快速拒绝：读掉已到达的请求，尽力回复503后关闭连接，不进入路由与数据库
+	void shedConnection(Connection* conn) {
+		overloadStats.shedRequests++;
+		if (conn->http2) {
+			conn->http2->shutdown(conn->output); // HTTP/2连接上以GOAWAY代替503
+			size_t n = 0;
+			transport.write(conn->session, conn->output.data() + conn->outputOffset,
+				conn->output.size() - conn->outputOffset, n);
+		} else if (conn->handshaked) {
+			char buffer[4096];
+			size_t n = 0;
+			transport.read(conn->session, buffer, sizeof(buffer), n);
+			HttpResponse response = HttpResponse::makeErrorResponse(503, "Service Unavailable");
+			response.setHeader("Retry-After", std::to_string(overloadOptions.retryAfterSeconds));
+			response.setHeader("Connection", "close");
+			std::string response_str = response.toString();
+			transport.write(conn->session, response_str.data(), response_str.size(), n);
+		}
+		closeConnection(conn); // TLS握手尚未完成时直接关闭，省去握手的开销
+	}
+
+	// 发送连接中尚未发送的响应数据；全部发送完返回true，
+	// 需要等待可写或连接已关闭时返回false（此时连接已被重新注册或释放）
+	bool flushOutput(Connection* conn) {
+		uint64_t writeStart = conn->traceId ? Tracer::now() : 0;
+		while (conn->outputOffset < conn->output.size()) {
+			size_t n = 0;
+			IoStatus status;
+			{
+				PROFILE_SCOPE(WRITE);
+				status = transport.write(conn->session, conn->output.data() + conn->outputOffset,
+					conn->output.size() - conn->outputOffset, n);
+			}
+			if (status == IO_OK) {
+				conn->outputOffset += n;
+				PROBE2(write, conn->fd, n);
+				continue;
+			}
+			if (writeStart) Tracer::record("write", writeStart, Tracer::now(), Transport::name(), conn->traceId); // 套接字写满，剩余部分之后再记
+			if (status == IO_WANT_READ || status == IO_WANT_WRITE) {
+				rearm(conn, status);
+			} else {
+				LOG_ERROR("Failed to send response on fd %d", conn->fd);
+				closeConnection(conn);
+			}
+			return false;
+		}
+		if (conn->output.capacity() > 65536) {
+			std::string().swap(conn->output); // 大响应发完后归还内存，空闲连接只占很少的内存
+		} else {
+			conn->output.clear();
+		}
+		conn->outputOffset = 0;
+		if (writeStart) {
+			Tracer::record("write", writeStart, Tracer::now(), Transport::name(), conn->traceId);
+			conn->traceId = 0;
+		}
+		return true;
+	}
+
+	// 处理一个完整的HTTP/1.1请求，包括解析请求、路由处理，并将响应追加到连接的发送缓冲区。
+	// 调用方需处于 Arena::Scope 之内：请求、响应与处理函数中的临时对象都分配在工作线程的请求内存池中，
+	// 响应写入发送缓冲区后整体回收。
+	// 协程路由的处理函数挂起时返回false，响应在协程完成后写入；allowSuspend 为false时在当前线程中等待协程完成
+	bool processRequest(Connection* conn, std::string_view buffer, bool allowSuspend = true) {
+		uint64_t parseStart = Tracer::now();
+		HttpRequest request;
+		if (!request.parse(buffer)) {
+			LOG_ERROR("Failed to parse HTTP request");
+			return true;
+		}
+		request.setTrusted(conn->trusted);
+		TraceScope trace(beginTrace(conn, request, parseStart));
+		if (WebSocket::isUpgradeRequest(request)) {
+			upgradeWebSocket(conn, request);
+			return true;
+		}
+		if (rateLimited(conn, request)) {
+			tooManyRequests().appendTo(conn->output);
+			return true;
+		}
+		const Router::AsyncHandlerFunc* handler = allowSuspend ? router.findAsyncRoute(request) : nullptr;
+		if (handler) return startAsync(conn, *handler, buffer, parseStart);
+		// 将HttpResponse对象转换为字符串形式，并发送给客户端
+		uint64_t routeStart = Tracer::current() ? Tracer::now() : 0;
+		HttpResponse response = router.routeRequest(request);
+		if (routeStart) Tracer::record("route", routeStart, Tracer::now(), request.getPath());
+		tagTrace(conn, response);
+		writeResponse(conn, request, response);
+		endTrace(request, parseStart);
+		DBG(BLUE "response_str: \n%s" NONE"\n" , conn->output.c_str()); ///
+		return true;
+	}
+
+	// 开始执行协程路由的处理函数。请求复制到连接的挂起状态中重新解析，协程中的分配都落在挂起状态的内存池里，
+	// 与工作线程的请求内存池无关；协程直接完成时写出响应并返回true
+	bool startAsync(Connection* conn, const Router::AsyncHandlerFunc& handler, std::string_view buffer, uint64_t requestStart) {
+		conn->pending.reset(new PendingRequest(this, conn, buffer));
+		PendingRequest& pending = *conn->pending;
+		pending.trace = Tracer::current();
+		if (pending.trace) {
+			pending.requestStart = requestStart;
+			pending.handlerStart = Tracer::now();
+		}
+		{
+			Arena::Scope scope(pending.arena, false);
+			pending.request.emplace();
+			pending.request->parse(pending.raw);
+			pending.request->setTrusted(conn->trusted);
+			PROFILE_SCOPE(HANDLER);
+			pending.task = handler(*pending.request);
+			pending.task.start(&pending);
+		}
+		if (finishAsync(conn)) return true;
+		asyncSuspended++;
+		asyncPending++;
+		return false;
+	}
+
+	// 恢复已经可以继续执行的协程；协程完成（响应已写入发送缓冲区）时返回true
+	bool resumeAsync(Connection* conn) {
+		PendingRequest& pending = *conn->pending;
+		void* address = pending.ready.exchange(nullptr, std::memory_order_acquire);
+		if (address) {
+			Arena::Scope scope(pending.arena, false);
+			TraceScope trace(pending.trace); // 协程中提交的数据库请求记入同一个追踪
+			PROFILE_SCOPE(HANDLER);
+			std::coroutine_handle<>::from_address(address).resume();
+		}
+		if (!finishAsync(conn)) return false;
+		asyncPending--;
+		return true;
+	}
+
+	// 协程已完成时写出响应（数据库队列已满时回复503，处理函数抛出其他异常时回复500）并释放挂起状态
+	bool finishAsync(Connection* conn) {
+		PendingRequest& pending = *conn->pending;
+		if (!pending.task.done()) return false;
+		{
+			Arena::Scope scope(pending.arena, false);
+			TraceScope trace(pending.trace);
+			if (pending.trace) Tracer::record("handler", pending.handlerStart, Tracer::now(), pending.request->getPath());
+			try {
+				HttpResponse response = pending.task.result();
+				tagTrace(conn, response);
+				writeResponse(conn, *pending.request, response);
+				endTrace(*pending.request, pending.requestStart);
+			} catch (const DbExecutor::Overloaded&) {
+				overloadStats.shedRequests++;
+				HttpResponse response = HttpResponse::makeErrorResponse(503, "Service Unavailable"); // 数据库队列已满
+				response.setHeader("Retry-After", std::to_string(overloadOptions.retryAfterSeconds));
+				response.appendTo(conn->output);
+			} catch (const std::exception& e) {
+				LOG_ERROR("Async handler for %s failed: %s", std::string(pending.request->getPath()).c_str(), e.what());
+				HttpResponse::makeErrorResponse(500, "Internal Server Error").appendTo(conn->output);
+			}
+		}
+		conn->pending.reset();
+		return true;
+	}
+
+	// WebSocket握手：校验请求并回复101，之后该连接上的数据按WebSocket帧处理
+	void upgradeWebSocket(Connection* conn, const HttpRequest& request) {
+		const WebSocketHandler* handler = router.findWebSocketRoute(std::string(request.getPath()));
+		if (!handler) {
+			conn->output += HttpResponse::makeErrorResponse(404, "NotFound").toString();
+			return ;
+		}
+		std::string key(request.getHeader("sec-websocket-key"));
+		if (request.getHeader("sec-websocket-version") != "13" || key.size() != 24) {
+			HttpResponse response = HttpResponse::makeErrorResponse(400, "Bad WebSocket handshake");
+			response.setHeader("Sec-WebSocket-Version", "13");
+			conn->output += response.toString();
+			return ;
+		}
+		HttpResponse response(101);
+		response.setHeader("Upgrade", "websocket");
+		response.setHeader("Connection", "Upgrade");
+		response.setHeader("Sec-WebSocket-Accept", WebSocket::acceptKey(key));
+		conn->output += response.toString();
+
+		conn->ws.reset(new WebSocketSession(handler, webSocketOptions, [this, conn](const WebSocketPtr& channel) {
+			notifyLoop(conn, channel);
+		}));
+		webSocketUpgrades++;
+		webSocketActive++;
+		conn->ws->opened(request);
+		notifyLoop(conn, conn->ws->getChannel()); // 由事件循环线程为该连接启动心跳定时器
+	}
+
+	// 对一个已解析的请求生成响应（HTTP/2使用）：先限流，再交给路由，协程路由在当前线程中等待完成
+	HttpResponse respond(Connection* conn, HttpRequest& request) {
+		uint64_t requestStart = Tracer::now();
+		request.setTrusted(conn->trusted);
+		TraceScope trace(beginTrace(conn, request, 0));
+		if (rateLimited(conn, request)) return tooManyRequests();
+		// 根据HttpRequest对象通过Router对象获取对应的HttpResponse对象
+		HttpResponse response = router.routeRequest(request);
+		if (Tracer::current()) Tracer::record("route", requestStart, Tracer::now(), request.getPath());
+		int level = 0;
+		Compressor::Encoding encoding = chooseEncoding(request, response, level);
+		if (encoding != Compressor::IDENTITY) {
+			TraceSpan span("compress");
+			Compressor::compressBody(response, encoding, level); // HTTP/2由帧划分长度，整体压缩
+		}
+		tagTrace(conn, response);
+		endTrace(request, requestStart);
+		return response;
+	}
+
+	// 决定是否追踪该请求（可信对端的 X-Trace: 1 时必定追踪，其他客户端不能借此填满追踪缓冲区），追踪时补记决定采样之前经过的阶段：
+	// 接受连接与TLS握手（每个连接只记一次）、在线程池中排队、解析请求（parseStart 为0时不记）
+	uint64_t beginTrace(Connection* conn, const HttpRequest& request, uint64_t parseStart) {
+		uint64_t trace = Tracer::start(request.isTrusted() ? request.getHeader("x-trace") : std::string_view());
+		if (!trace) return 0;
+		if (!conn->connectionTraced) {
+			conn->connectionTraced = true;
+			Tracer::record("accept", conn->acceptedAt, conn->acceptedAt, conn->clientIp, trace);
+			if (conn->handshakeEnd) Tracer::record("handshake", conn->handshakeStart, conn->handshakeEnd, Transport::name(), trace);
+		}
+		if (conn->dequeuedAt >= conn->queuedAt) {
+			Tracer::record("queue", Tracer::toNanos(conn->queuedAt), Tracer::toNanos(conn->dequeuedAt), std::string_view(), trace);
+		}
+		if (parseStart) Tracer::record("parse", parseStart, Tracer::now(), std::string_view(), trace);
+		return trace;
+	}
+
+	// 被追踪的请求：响应带上 X-Trace-Id，用它在 /debug/trace?id= 中筛选；响应的发送记为该请求的 write 段
+	void tagTrace(Connection* conn, HttpResponse& response) {
+		uint64_t trace = Tracer::current();
+		if (!trace) return ;
+		response.setHeader("X-Trace-Id", Tracer::idString(trace));
+		conn->traceId = trace;
+	}
+
+	// 记录请求从开始解析到响应写入发送缓冲区的整段时间，附上请求行
+	void endTrace(const HttpRequest& request, uint64_t requestStart) {
+		if (!Tracer::current()) return ;
+		std::string detail = request.getMethodString();
+		detail += ' ';
+		detail += request.getPath();
+		Tracer::record("request", requestStart, Tracer::now(), detail);
+	}
+
+	// 按 Accept-Encoding 与路由的压缩级别选择编码，不压缩时返回 IDENTITY。
+	// 会被压缩的响应都带上 Vary，中间缓存据此区分压缩与未压缩的版本
+	Compressor::Encoding chooseEncoding(const HttpRequest& request, HttpResponse& response, int& level) {
+		if (!Compressor::eligible(response, compressionOptions)) return Compressor::IDENTITY;
+		level = router.compressionLevel(request);
+		if (level < 0) level = compressionOptions.level;
+		if (level == 0) return Compressor::IDENTITY;
+		response.setHeader("Vary", "Accept-Encoding");
+		return Compressor::negotiate(request.getHeader("accept-encoding"));
+	}
+
+	// 写出HTTP/1.1响应，需要时压缩：大的响应体以 chunked 编码边压缩边写入发送缓冲区（HTTP/1.0客户端不支持，整体压缩）
+	void writeResponse(Connection* conn, const HttpRequest& request, HttpResponse& response) {
+		PROFILE_SCOPE(SERIALIZE);
+		if (response.isStreaming()) {
+			startStream(conn, request, response);
+			return ;
+		}
+		int level = 0;
+		Compressor::Encoding encoding = chooseEncoding(request, response, level);
+		if (encoding == Compressor::IDENTITY) {
+			response.appendTo(conn->output);
+		} else if (response.getBody().size() >= compressionOptions.chunkedThreshold && request.getVersion() == "HTTP/1.1") {
+			TraceSpan span("compress");
+			Compressor::appendChunked(response, encoding, level, conn->output);
+		} else {
+			TraceSpan span("compress");
+			Compressor::compressBody(response, encoding, level);
+			response.appendTo(conn->output);
+		}
+	}
+
+	// 开始发送流式响应：先写出响应头，响应体由 sendOutput 在发送缓冲区发完后逐段向产生器取。
+	// HTTP/1.1 使用 chunked 编码；HTTP/1.0 不支持，以关闭连接表示响应体结束
+	void startStream(Connection* conn, const HttpRequest& request, HttpResponse& response) {
+		bool chunked = request.getVersion() == "HTTP/1.1";
+		if (!chunked) response.setHeader("Connection", "close");
+		response.appendHead(conn->output, chunked);
+		conn->stream = response.takeStream();
+		conn->streamChunked = chunked;
+		streamedResponses++;
+	}
+
+	// 向产生器取下一段流式响应体写入发送缓冲区，凑够 kStreamChunkBytes 或产生器结束为止，结束时写出结束块。
+	// 产生器抛出异常时响应头已经发出、无法再回复错误，返回false，由调用方关闭连接
+	bool produceStream(Connection* conn) {
+		thread_local std::string chunk;
+		chunk.clear();
+		bool more = true;
+		try {
+			while (more && chunk.size() < kStreamChunkBytes) more = conn->stream(chunk);
+		} catch (const std::exception& e) {
+			LOG_ERROR("Stream producer failed on fd %d: %s", conn->fd, e.what());
+			conn->stream = nullptr;
+			return false;
+		}
+		if (conn->streamChunked) appendChunk(conn->output, chunk);
+		else conn->output += chunk;
+		if (!more) {
+			conn->stream = nullptr;
+			if (conn->streamChunked) appendLastChunk(conn->output);
+			else conn->closeAfterStream = true;
+		}
+		if (chunk.capacity() > 4 * kStreamChunkBytes) std::string().swap(chunk); // 产生器一次给出了很大的一段，用完归还
+		return true;
+	}
+
+	// 发送积压的响应，并在发送缓冲区发完（套接字可写）时继续取流式响应体，每个连接只缓存一段；
+	// 流式响应结束后接着处理流水线中排在它后面的请求。全部发完返回true；
+	// 需要等待可写、协程请求挂起或连接已关闭时返回false（此时连接已被重新注册或释放）
+	bool sendOutput(Connection* conn) {
+		while (flushOutput(conn)) {
+			if (conn->closeAfterStream) {
+				closeConnection(conn); // HTTP/1.0的流式响应已发完
+				return false;
+			}
+			if (conn->http2) {
+				if (conn->http2->pump(conn->output)) continue;
+				return true;
+			}
+			if (!conn->stream) return true;
+			if (!produceStream(conn)) {
+				closeConnection(conn);
+				return false;
+			}
+			if (conn->stream || conn->closeAfterStream || conn->input.empty()) continue;
+			if (!processRequests(conn)) {
+				if (flushOutput(conn)) closeConnection(conn);
+				return false;
+			}
+			if (conn->pending) {
+				flushOutput(conn);
+				return false;
+			}
+		}
+		return false;
+	}
+
+	// 按客户端IP限流，超出配额时返回true
+	bool rateLimited(Connection* conn, HttpRequest& request) {
+		const std::string* clientIp = &conn->clientIp;
+		std::string realIp;
+		if (overloadOptions.trustRealIpHeader && !request.getHeader("x-real-ip").empty() && trustsProxy(conn->clientIp)) {
+			realIp = request.getHeader("x-real-ip"); // 位于nginx之后时对端总是nginx，以它转发的真实IP为准
+			clientIp = &realIp;
+		}
+		if (rateLimiter->allow(*clientIp)) return false;
+		overloadStats.rateLimited++;
+		return true;
+	}
+
+	bool trustsProxy(const std::string& peer) const {
+		for (const std::string& proxy : overloadOptions.trustedProxies) {
+			if (proxy == peer) return true;
+		}
+		return false;
+	}
+
+	HttpResponse tooManyRequests() const {
+		HttpResponse response = HttpResponse::makeErrorResponse(429, "Too Many Requests");
+		response.setHeader("Retry-After", std::to_string(overloadOptions.retryAfterSeconds));
+		return response;
+	}
+
+	// 为连接启用HTTP/2，并写出服务端的SETTINGS
+	void startHttp2(Connection* conn) {
+		conn->http2.reset(new Http2Session(http2Options));
+		conn->http2->start(conn->output);
+		http2Connections++;
+	}
+
+	// 处理读缓冲区中的数据：HTTP/1.1按完整的请求逐个取出处理，不完整的请求留在缓冲区中等待后续数据；
+	// WebSocket与HTTP/2连接的数据全部交给帧状态机（它们自己缓存不完整的帧）。
+	// 返回false表示应在发送完剩余数据后关闭连接
+	bool onInput(Connection* conn) {
+		ChainBuffer& input = conn->input;
+		if (!conn->ws && !conn->http2) {
+			char prefix[16];
+			size_t n = input.size() < sizeof(prefix) ? input.size() : sizeof(prefix);
+			input.copyTo(prefix, n);
+			if (Http2Session::startsWithPreface(prefix, n)) {
+				startHttp2(conn); // 明文连接上的先验知识HTTP/2（h2c）
+			} else if (!processRequests(conn)) {
+				return false;
+			}
+		}
+		if (!conn->ws && !conn->http2) return true;
+		bool open = true; // 升级为WebSocket之后缓冲区中剩下的数据已经是帧
+		input.forEachSegment([this, conn, &open](const char* data, size_t len) {
+			if (open) open = onData(conn, data, len);
+		});
+		input.clear();
+		return open;
+	}
+
+	// 从读缓冲区中依次取出完整的HTTP/1.1请求处理（支持流水线）；请求非法时写入错误响应并返回false。
+	// 协程请求挂起或开始发送流式响应时停止，后续请求留在缓冲区中，等它的响应写出后再处理，保证响应顺序
+	bool processRequests(Connection* conn) {
+		ChainBuffer& input = conn->input;
+		while (!input.empty() && !conn->ws && !conn->pending && !conn->stream) {
+			if (conn->chunkedRequest) {
+				if (!decodeChunked(conn)) return false;
+				if (conn->chunkedRequest) return true; // 请求体尚未收全
+				continue;
+			}
+			if (conn->upload) {
+				if (!feedUpload(conn)) return false;
+				if (conn->upload) return true; // 请求体尚未收全
+				continue;
+			}
+			size_t headerEnd = input.find("\r\n\r\n");
+			if (headerEnd == ChainBuffer::npos) {
+				if (input.size() > kMaxHeaderBytes) return rejectRequest(conn, 431, "Request Header Fields Too Large");
+				return true; // 请求头尚未收全
+			}
+			if (headerEnd + 4 > kMaxHeaderBytes) return rejectRequest(conn, 431, "Request Header Fields Too Large");
+			Arena::Scope scope(Arena::forThisThread());
+			std::string_view head = input.contiguous(headerEnd + 4, Arena::resource());
+			size_t bodyLength = 0;
+			bool chunked = false;
+			if (!HttpRequest::bodyLength(head, bodyLength, chunked)) return rejectRequest(conn, 400, "Bad Request");
+			if ((chunked || bodyLength > 0) && head.compare(0, 5, "POST ") == 0) {
+				bool open = true;
+				if (beginUpload(conn, head, bodyLength, chunked, open)) {
+					if (!open) return false;
+					continue;
+				}
+			}
+			if (chunked) {
+				// 请求体的长度要逐块解码才知道：请求头复制出来，之后到达的数据边解码边追加在后面，读缓冲区不必保留整个请求
+				conn->chunkedRequest.reset(new ChunkedRequest(head, kMaxBodyBytes, kMaxHeaderBytes));
+				input.consume(head.size());
+				chunkedRequests++;
+				continue;
+			}
+			if (bodyLength > kMaxBodyBytes) return rejectRequest(conn, 413, "Payload Too Large");
+			size_t total = head.size() + bodyLength;
+			if (input.size() < total) return true; // 请求体尚未收全，已收到的部分留在内存块中
+			processRequest(conn, bodyLength == 0 ? head : input.contiguous(total, Arena::resource()));
+			input.consume(total);
+		}
+		return true;
+	}
+
+	// 把读缓冲区中的数据交给 chunked 解码器，已用掉的数据立即从缓冲区中移除；请求体收全后处理该请求。
+	// 块格式非法或请求体超出上限时回复错误并返回false
+	bool decodeChunked(Connection* conn) {
+		ChunkedRequest& request = *conn->chunkedRequest;
+		ChunkedDecoder::Status status = ChunkedDecoder::NEED_MORE;
+		size_t used = 0;
+		conn->input.forEachSegment([&request, &status, &used](const char* data, size_t len) {
+			if (status != ChunkedDecoder::NEED_MORE) return ;
+			size_t consumed = 0;
+			status = request.decoder.feed(data, len, request.raw, consumed);
+			used += consumed;
+		});
+		conn->input.consume(used);
+		if (status == ChunkedDecoder::BAD) return rejectRequest(conn, 400, "Bad Request");
+		if (status == ChunkedDecoder::TOO_LARGE) return rejectRequest(conn, 413, "Payload Too Large");
+		if (status == ChunkedDecoder::NEED_MORE) return true;
+		std::unique_ptr<ChunkedRequest> complete = std::move(conn->chunkedRequest);
+		Arena::Scope scope(Arena::forThisThread());
+		processRequest(conn, complete->raw);
+		return true;
+	}
+
+	// 上传路由的请求：请求体不在读缓冲区中攒齐，而是交给 UploadReceiver 边到达边处理（文件部分直接写入磁盘），
+	// 内存占用与请求体大小无关，上限由路由的 UploadOptions 决定。
+	// 不是上传路由时返回false，按普通请求处理；open 为false表示已回复错误，应在发送完后关闭连接
+	bool beginUpload(Connection* conn, std::string_view head, size_t bodyLength, bool chunked, bool& open) {
+		std::unique_ptr<UploadState> upload(new UploadState());
+		bool allowed = true;
+		bool parsed = upload->request.parse(head);
+		upload->request.setTrusted(conn->trusted);
+		const UploadRoute* route = parsed ? router.findUploadRoute(upload->request, allowed) : nullptr;
+		if (!route) return false;
+		if (!allowed) {
+			HttpResponse response = HttpResponse::makeErrorResponse(401, "Not logged in");
+			response.setHeader("WWW-Authenticate", "Bearer");
+			open = rejectRequest(conn, response);
+			return true;
+		}
+		if (rateLimited(conn, upload->request)) {
+			open = rejectRequest(conn, tooManyRequests());
+			return true;
+		}
+		if (!chunked && bodyLength > route->options.maxBodyBytes) {
+			open = rejectRequest(conn, 413, "Payload Too Large");
+			return true;
+		}
+		upload->receiver.emplace(*route, upload->request);
+		if (!upload->receiver->start(chunked ? size_t(-1) : bodyLength)) {
+			open = rejectRequest(conn, upload->receiver->errorCode(), upload->receiver->errorMessage().c_str());
+			return true;
+		}
+		if (strcasecmp(std::string(upload->request.getHeader("expect")).c_str(), "100-continue") == 0 && upload->request.getVersion() == "HTTP/1.1") {
+			conn->output += "HTTP/1.1 100 Continue\r\n\r\n"; // 上传请求已被接受，客户端不必等待超时再发请求体
+		}
+		upload->remaining = bodyLength;
+		if (chunked) upload->chunked.reset(new ChunkedDecoder(route->options.maxBodyBytes, kMaxHeaderBytes));
+		conn->input.consume(head.size());
+		conn->upload = std::move(upload);
+		uploads++;
+		return true;
+	}
+
+	// 把读缓冲区中属于上传请求体的数据交给 UploadReceiver，用掉的数据立即从缓冲区中移除；请求体收全后写出响应。
+	// 请求体格式非法、超出上限或写盘失败时回复错误并返回false
+	bool feedUpload(Connection* conn) {
+		UploadState& upload = *conn->upload;
+		ChunkedDecoder::Status status = ChunkedDecoder::NEED_MORE;
+		bool ok = true;
+		size_t used = 0;
+		conn->input.forEachSegment([this, &upload, &status, &ok, &used](const char* data, size_t len) {
+			if (!ok || status != ChunkedDecoder::NEED_MORE || (!upload.chunked && upload.remaining == 0)) return ;
+			if (upload.chunked) {
+				thread_local std::string decoded;
+				decoded.clear();
+				size_t consumed = 0;
+				status = upload.chunked->feed(data, len, decoded, consumed);
+				used += consumed;
+				uploadBytes += decoded.size();
+				ok = upload.receiver->feed(decoded.data(), decoded.size());
+				return ;
+			}
+			size_t n = len < upload.remaining ? len : upload.remaining;
+			ok = upload.receiver->feed(data, n);
+			upload.remaining -= n;
+			used += n;
+			uploadBytes += n;
+		});
+		conn->input.consume(used);
+		if (!ok) return rejectRequest(conn, upload.receiver->errorCode(), upload.receiver->errorMessage().c_str());
+		if (status == ChunkedDecoder::BAD) return rejectRequest(conn, 400, "Bad Request");
+		if (status == ChunkedDecoder::TOO_LARGE) return rejectRequest(conn, 413, "Payload Too Large");
+		if (upload.chunked ? status == ChunkedDecoder::DONE : upload.remaining == 0) finishUpload(conn);
+		return true;
+	}
+
+	// 明文连接上非 multipart 的上传：读缓冲区为空时，请求体经管道用 splice 从套接字直接移入文件，数据不经过用户态。
+	// 请求体收全返回 IO_OK；套接字暂无数据返回 IO_WANT_READ；写盘失败时返回 IO_ERROR 且 receiver 中记录了错误
+	IoStatus spliceUpload(Connection* conn) {
+		UploadState& upload = *conn->upload;
+		if (upload.pipe[0] == -1 && pipe2(upload.pipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+			LOG_ERROR("pipe2 failed: %s", strerror(errno));
+			upload.pipe[0] = upload.pipe[1] = -1;
+			return IO_ERROR;
+		}
+		while (upload.remaining > 0) {
+			size_t n = 0;
+			IoStatus status = transport.splice(conn->session, upload.pipe[1], upload.remaining < kSpliceBytes ? upload.remaining : kSpliceBytes, n);
+			if (status != IO_OK) return status;
+			conn->served = true;
+			if (!upload.receiver->spliceFrom(upload.pipe[0], n)) return IO_ERROR;
+			upload.remaining -= n;
+			uploadBytes += n;
+			uploadBytesSpliced += n;
+		}
+		return IO_OK;
+	}
+
+	// 上传请求体已全部收到：交给处理函数生成响应并写出，释放上传状态（处理函数没有移走的临时文件随之删除）
+	void finishUpload(Connection* conn) {
+		std::unique_ptr<UploadState> upload = std::move(conn->upload);
+		Arena::Scope scope(Arena::forThisThread());
+		if (!upload->receiver->finish()) {
+			HttpResponse::makeErrorResponse(upload->receiver->errorCode(), upload->receiver->errorMessage()).appendTo(conn->output);
+			return ;
+		}
+		HttpResponse response = upload->receiver->complete();
+		writeResponse(conn, upload->request, response);
+	}
+
+	// 回复错误并在发送完后关闭连接：请求的边界已无法确定，连接上后续的数据不能再解析
+	bool rejectRequest(Connection* conn, int code, const char* message) {
+		LOG_WARNING("Rejecting request on fd %d: %d %s", conn->fd, code, message);
+		return rejectRequest(conn, HttpResponse::makeErrorResponse(code, message));
+	}
+
+	bool rejectRequest(Connection* conn, HttpResponse response) {
+		response.setHeader("Connection", "close");
+		response.appendTo(conn->output);
+		conn->input.clear();
+		return false;
+	}
+
+	// 处理WebSocket或HTTP/2连接上的一段数据；
+	// 返回false表示连接已出错或对端已关闭（GOAWAY），发送完剩余数据后应关闭连接
+	bool onData(Connection* conn, const char* data, size_t len) {
+		if (conn->ws) {
+			bool open = conn->ws->onData(data, len, conn->output);
+			return conn->ws->pump(conn->output) && open; // 回调中推送的消息随本次回复一起发出
+		}
+		// 同一连接上的多个流由当前工作线程按到达顺序依次处理
+		bool ok = conn->http2->feed(data, len, conn->output, [this, conn](HttpRequest& request) {
+			http2Streams++;
+			return respond(conn, request);
+		});
+		return ok && !conn->http2->finished();
+	}
+
+	// 处理握手期间收到的0-RTT早期数据：幂等路由立即处理，其余请求推迟到握手完成之后，
+	// 避免被重放的早期数据触发登录、注册等有副作用的操作
+	void processEarlyData(Connection* conn, const std::string& early) {
+		// HTTP/2的早期数据是二进制帧，无法逐个请求判断幂等性，全部推迟；
+		// 只有恰好是一个完整请求的早期数据才会立即处理，避免流水线中夹带非幂等请求
+		if (!transport.negotiatedHttp2(conn->session) && conn->input.empty()) {
+			Arena::Scope scope(Arena::forThisThread());
+			HttpRequest request;
+			size_t headerEnd = early.find("\r\n\r\n");
+			size_t bodyLength = 0;
+			bool chunked = false;
+			if (headerEnd != std::string::npos && HttpRequest::bodyLength(std::string_view(early).substr(0, headerEnd + 4), bodyLength, chunked) &&
+				!chunked && headerEnd + 4 + bodyLength == early.size() && request.parse(early) && router.isIdempotent(request)) {
+				processRequest(conn, early, false); // 握手尚未完成，不挂起
+				return ;
+			}
+		}
+		conn->input.append(early.data(), early.size()); // 保持请求顺序：前面已有推迟的请求时后续请求也一并推迟
+	}
+
+	// 工作线程处理连接的入口：处理期间连接不在空闲链表中；处理完后重新统计内存，
+	// 空闲的连接归还发送缓冲区后挂回空闲链表（读缓冲区此时已为空，TLS记录层缓冲区由OpenSSL释放）
+	void handleConnection(Connection* conn) {
+		unpark(conn);
+		serviceConnection(conn);
+		if (conn->closed) return;
+		bool idle = isIdle(conn);
+		if (idle && draining) {
+			closeConnection(conn); // 平滑退出中：请求已处理完，不再保持连接
+			return ;
+		}
+		if (idle && conn->output.capacity() > std::string().capacity()) std::string().swap(conn->output);
+		accountMemory(conn);
+		if (idle) park(conn);
+	}
+
+	// 处理客户端连接上的事件：推进握手、发送积压的响应、读取请求并处理
+	void serviceConnection(Connection* conn) {
+		if (!conn->handshaked) {
+			if (!conn->handshakeStart) {
+				conn->handshakeStart = Tracer::now();
+				PROBE1(handshake_start, conn->fd);
+			}
+			IoStatus status = transport.handshake(conn->session);
+			std::string early;
+			if (status != IO_ERROR && status != IO_CLOSED && transport.takeEarlyData(conn->session, early)) {
+				processEarlyData(conn, early);
+			}
+			if (status == IO_WANT_READ || status == IO_WANT_WRITE) {
+				// 握手未完成，先发出早期请求的响应，再等待更多数据
+				if (flushOutput(conn)) rearm(conn, status);
+				return ;
+			}
+			PROBE2(handshake_done, conn->fd, int(status == IO_OK));
+			if (status != IO_OK) {
+				LOG_ERROR("Handshake failed for fd: %d", conn->fd);
+				closeConnection(conn);
+				return ;
+			}
+			conn->handshaked = true;
+			conn->handshakeEnd = Tracer::now();
+			if (transport.negotiatedHttp2(conn->session)) startHttp2(conn); // ALPN选定了h2
+			bool open = true;
+			if (!conn->input.empty()) {
+				open = onInput(conn); // 握手已完成，处理推迟的请求
+			}
+			if (!open) {
+				if (flushOutput(conn)) closeConnection(conn);
+				return ;
+			}
+		}
+
+		// 挂起中的协程请求：恢复可以继续执行的协程，完成后写出响应，再处理流水线中后续的请求。
+		// 挂起期间不读取新数据，只发送之前请求的响应
+		if (conn->pending) {
+			if (!resumeAsync(conn)) {
+				if (!conn->closeAfterResume) flushOutput(conn);
+				return ;
+			}
+			if (conn->closeAfterResume) {
+				closeConnection(conn);
+				return ;
+			}
+			if (!sendOutput(conn)) return ;
+			if (!processRequests(conn)) {
+				if (flushOutput(conn)) closeConnection(conn);
+				return ;
+			}
+			if (conn->pending) {
+				flushOutput(conn);
+				return ;
+			}
+		}
+
+		// 先把上次未发完的响应（以及流式响应的后续数据）发送出去
+		if (!sendOutput(conn)) return ;
+		if (draining && conn->ws) conn->ws->getChannel()->close(WebSocket::GOING_AWAY); // 平滑退出中：通知对端
+		// WebSocket连接：上次的数据发完后才取出其他线程推送的消息，对端读得慢时消息积压在通道的发送队列中，
+		// 超出上限后丢弃，而不是无限制地堆在发送缓冲区里；同时处理到期的心跳
+		if (conn->ws) {
+			bool open = conn->ws->pump(conn->output);
+			if (!flushOutput(conn)) return ;
+			if (!open) {
+				closeConnection(conn);
+				return ;
+			}
+		}
+		if (conn->http2 && conn->http2->finished()) {
+			closeConnection(conn); // HTTP/2连接已结束，剩余的响应数据已发完
+			return ;
+		}
+
+		// 循环读取客户端请求数据，直到无数据可读。数据直接读进连接的读缓冲区，
+		// 一个请求跨越多次读取或一次读到多个请求都能正确处理
+		while (true) {
+			if constexpr (Transport::canSplice) {
+				if (conn->upload && conn->input.empty() && !conn->upload->chunked && conn->upload->receiver->storesRawFile()) {
+					IoStatus status = spliceUpload(conn);
+					if (status == IO_OK) {
+						finishUpload(conn);
+						if (!sendOutput(conn)) return ;
+						continue;
+					}
+					if (status == IO_WANT_READ) {
+						rearm(conn, status);
+						return ;
+					}
+					if (status == IO_ERROR && conn->upload->receiver->errorCode()) { // 写盘失败或超出上限
+						rejectRequest(conn, conn->upload->receiver->errorCode(), conn->upload->receiver->errorMessage().c_str());
+						if (flushOutput(conn)) closeConnection(conn);
+						return ;
+					}
+					closeConnection(conn);
+					return ;
+				}
+			}
+			struct iovec iov[kReadChunks];
+			int count = conn->input.prepare(iov, kReadChunks);
+			size_t bytes_read = 0; // 读取的字节数
+			IoStatus status;
+			{
+				PROFILE_SCOPE(READ);
+				status = transport.readv(conn->session, iov, count, bytes_read);
+			}
+			conn->input.commit(status == IO_OK ? bytes_read : 0); // 没用上的内存块立即还回池中
+			if (status == IO_OK) {
+				PROBE2(read, conn->fd, bytes_read);
+				conn->served = true;
+				bool open = onInput(conn);
+				if (!sendOutput(conn)) return ;
+				if (!open) {
+					closeConnection(conn);
+					return ;
+				}
+				if (conn->pending) return ; // 协程挂起：暂停读取，协程可以恢复时由事件循环重新调度
+				continue;
+			}
+			if (status == IO_WANT_READ || status == IO_WANT_WRITE) {
+				rearm(conn, status); // 数据已读完，等待下一次事件
+				return ;
+			}
+			// 对端关闭连接或发生错误
+			if (status == IO_ERROR) {
+				LOG_ERROR("Error reading from socket %d", conn->fd);
+			}
+			closeConnection(conn);
+			return ;
+		}
+	}
+
+	// 设置文件描述符为非阻塞模式的方法
+	void setNonBlocking(int sock) {
+		int opts = fcntl(sock, F_GETFL, 0); //获取文件描述符的状态标志
+		if (opts == -1) {
+			LOG_ERROR("fcntl(F_GETFL) failed on socket %d: %s", sock, strerror(errno)); ////
+			throw std::runtime_error("fcntl F_GETFL failed"); // 获取失败，抛出异常
+		}
+		opts |= O_NONBLOCK; // 设置非阻塞标志
+		if (fcntl(sock, F_SETFL, opts) < 0) {
+			LOG_ERROR("fcntl(F_SETFL) failed on socket %d: %s", sock, strerror(errno));
+			throw std::runtime_error("fcntl F_SETFL failed"); // 设置失败，抛出异常
+		}
+		LOG_INFO("Set socket %d to non-blocking", sock);
+		return ;
+	}
+};
+
+
+#endif
@@ -0,0 +1,211 @@
+/*************************************************************************
+	> File Name: Listener.h
+	> Author:
+	> Mail:
+	> Created Time: Sun 25 Oct 2026 10:05:27 AM CST
+ ************************************************************************/
+
+// 监听地址：服务器与主进程用它创建监听套接字，可以同时监听多个地址。格式：
+//   "8080"                   所有IPv4地址的8080端口
+//   "127.0.0.1:8080"         指定的IPv4地址
+//   "[::]:8080"、"[::1]:8080" IPv6地址（只接受IPv6连接，需要IPv4时另外监听IPv4地址）
+//   "unix:/run/app.sock"     文件系统中的Unix域套接字，可以用 ";mode=0660" 指定文件权限（默认0666，与回环TCP端口一样本机可访问）
+//   "unix:@app"              抽象命名空间中的Unix域套接字，不占用文件，最后一个持有者关闭后自动消失
+// nginx与应用在同一台机器上时，经Unix域套接字转发不经过TCP协议栈（没有握手、拥塞控制与回环网卡），每一跳更便宜
+#ifndef _LISTENER_H
+#define _LISTENER_H
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "Logger.h"
+
+struct ListenAddress {
+	enum Family { TCP4, TCP6, UNIX };
+
+	Family family = TCP4;
+	std::string host; // TCP：绑定的地址，为空表示所有地址
+	int port = 0;
+	std::string path; // UNIX：套接字路径，以@开头表示抽象命名空间
+	mode_t mode = 0666; // UNIX：文件系统中套接字文件的权限
+
+	// 所有IPv4地址上的TCP端口
+	static ListenAddress tcp(int port) {
+		ListenAddress address;
+		address.port = port;
+		return address;
+	}
+
+	// 解析一个地址，格式错误时抛出异常
+	static ListenAddress parse(const std::string& spec) {
+		ListenAddress address;
+		if (spec.compare(0, 5, "unix:") == 0) {
+			address.family = UNIX;
+			address.path = spec.substr(5);
+			size_t option = address.path.find(";mode=");
+			if (option != std::string::npos) {
+				address.mode = mode_t(strtol(address.path.c_str() + option + 6, nullptr, 8));
+				address.path.erase(option);
+			}
+			if (address.path.empty() || address.path.size() >= sizeof(((struct sockaddr_un*)nullptr)->sun_path)) {
+				LOG_ERROR("Invalid unix socket path in listen address '%s'", spec.c_str());
+				throw std::runtime_error("invalid listen address");
+			}
+			return address;
+		}
+		std::string port = spec;
+		if (!spec.empty() && spec[0] == '[') {
+			size_t close = spec.find("]:");
+			if (close == std::string::npos) {
+				LOG_ERROR("Invalid IPv6 listen address '%s' (expected [addr]:port)", spec.c_str());
+				throw std::runtime_error("invalid listen address");
+			}
+			address.family = TCP6;
+			address.host = spec.substr(1, close - 1);
+			port = spec.substr(close + 2);
+		} else if (spec.find(':') != std::string::npos) {
+			address.host = spec.substr(0, spec.find(':'));
+			port = spec.substr(spec.find(':') + 1);
+		}
+		char* end = nullptr;
+		long value = strtol(port.c_str(), &end, 10);
+		if (port.empty() || *end || value <= 0 || value > 65535) {
+			LOG_ERROR("Invalid port in listen address '%s'", spec.c_str());
+			throw std::runtime_error("invalid listen address");
+		}
+		address.port = int(value);
+		return address;
+	}
+
+	// 解析以逗号分隔的多个地址
+	static std::vector<ListenAddress> parseList(const std::string& specs) {
+		std::vector<ListenAddress> addresses;
+		size_t pos = 0;
+		while (pos <= specs.size()) {
+			size_t end = specs.find(',', pos);
+			if (end == std::string::npos) end = specs.size();
+			if (end > pos) addresses.push_back(parse(specs.substr(pos, end - pos)));
+			pos = end + 1;
+		}
+		return addresses;
+	}
+
+	bool isUnix() const { return family == UNIX; }
+	bool isAbstract() const { return family == UNIX && path[0] == '@'; }
+
+	// 规范形式，用于日志以及升级时按地址匹配继承来的套接字
+	std::string toString() const {
+		if (family == UNIX) return "unix:" + path;
+		if (family == TCP6) return "[" + (host.empty() ? std::string("::") : host) + "]:" + std::to_string(port);
+		return (host.empty() ? std::string("0.0.0.0") : host) + ":" + std::to_string(port);
+	}
+
+	// 创建、绑定并开始监听（CLOEXEC），失败时抛出异常。reusePort 为true时设置SO_REUSEPORT，
+	// 由内核在多个进程的套接字之间分配连接；Unix域套接字不支持，由调用方共用同一个套接字
+	int open(bool reusePort) const {
+		struct sockaddr_storage storage = {};
+		socklen_t length = 0;
+		int domain = build(storage, length);
+		int fd = socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd == -1) {
+			LOG_ERROR("socket creation for %s failed: %s", toString().c_str(), strerror(errno));
+			throw std::runtime_error("socket failed");
+		}
+		int opt = 1;
+		if (family != UNIX) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)); // 允许快速重启服务器并重用相同端口
+			if (reusePort) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+		}
+		if (family == TCP6) setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt));
+		if (family == UNIX && !isAbstract()) unlink(path.c_str()); // 上次运行留下的套接字文件
+		if (bind(fd, (struct sockaddr*)&storage, length) < 0 ||
+			(family == UNIX && !isAbstract() && chmod(path.c_str(), mode) < 0) || listen(fd, SOMAXCONN) < 0) {
+			LOG_ERROR("Bind/listen on %s failed: %s", toString().c_str(), strerror(errno));
+			close(fd);
+			throw std::runtime_error("bind failed");
+		}
+		return fd;
+	}
+
+	// 删除文件系统中的套接字文件（抽象命名空间与TCP地址无需处理）
+	void unlinkPath() const {
+		if (family == UNIX && !isAbstract()) unlink(path.c_str());
+	}
+
+	// 已经打开的监听套接字的地址，用于日志
+	static std::string describe(int fd) {
+		struct sockaddr_storage storage = {};
+		socklen_t length = sizeof(storage);
+		if (getsockname(fd, (struct sockaddr*)&storage, &length) < 0) return "fd " + std::to_string(fd);
+		return peerName(storage, length, true);
+	}
+
+	// accept 得到的对端地址：IP地址（用于按IP限流），Unix域套接字返回 "unix"；withPort 为true时带上端口
+	static std::string peerName(const struct sockaddr_storage& storage, socklen_t length, bool withPort = false) {
+		char ip[INET6_ADDRSTRLEN] = {0};
+		if (storage.ss_family == AF_INET) {
+			const struct sockaddr_in* in = reinterpret_cast<const struct sockaddr_in*>(&storage);
+			inet_ntop(AF_INET, &in->sin_addr, ip, sizeof(ip));
+			return withPort ? std::string(ip) + ":" + std::to_string(ntohs(in->sin_port)) : std::string(ip);
+		}
+		if (storage.ss_family == AF_INET6) {
+			const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(&storage);
+			inet_ntop(AF_INET6, &in6->sin6_addr, ip, sizeof(ip));
+			return withPort ? "[" + std::string(ip) + "]:" + std::to_string(ntohs(in6->sin6_port)) : std::string(ip);
+		}
+		if (storage.ss_family == AF_UNIX && withPort) {
+			const struct sockaddr_un* un = reinterpret_cast<const struct sockaddr_un*>(&storage);
+			size_t size = length > offsetof(struct sockaddr_un, sun_path) ? length - offsetof(struct sockaddr_un, sun_path) : 0;
+			if (size > 0 && un->sun_path[0] == '\0') return "unix:@" + std::string(un->sun_path + 1, size - 1);
+			return "unix:" + std::string(un->sun_path, strnlen(un->sun_path, size));
+		}
+		return "unix";
+	}
+
+private:
+	// 填写 sockaddr，返回地址族
+	int build(struct sockaddr_storage& storage, socklen_t& length) const {
+		if (family == UNIX) {
+			struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&storage);
+			un->sun_family = AF_UNIX;
+			memcpy(un->sun_path, path.data(), path.size());
+			if (isAbstract()) un->sun_path[0] = '\0'; // 抽象命名空间：以\0开头，长度由 length 决定
+			length = socklen_t(offsetof(struct sockaddr_un, sun_path) + path.size() + (isAbstract() ? 0 : 1));
+			return AF_UNIX;
+		}
+		if (family == TCP6) {
+			struct sockaddr_in6* in6 = reinterpret_cast<struct sockaddr_in6*>(&storage);
+			in6->sin6_family = AF_INET6;
+			in6->sin6_port = htons(port);
+			in6->sin6_addr = in6addr_any;
+			if (!host.empty() && inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) != 1) invalidHost();
+			length = sizeof(struct sockaddr_in6);
+			return AF_INET6;
+		}
+		struct sockaddr_in* in = reinterpret_cast<struct sockaddr_in*>(&storage);
+		in->sin_family = AF_INET;
+		in->sin_port = htons(port);
+		in->sin_addr.s_addr = INADDR_ANY;
+		if (!host.empty() && inet_pton(AF_INET, host.c_str(), &in->sin_addr) != 1) invalidHost();
+		length = sizeof(struct sockaddr_in);
+		return AF_INET;
+	}
+
+	void invalidHost() const {
+		LOG_ERROR("Invalid host in listen address %s", toString().c_str());
+		throw std::runtime_error("invalid listen address");
+	}
+};
+
+#endif
@@ -0,0 +1,574 @@
+/*************************************************************************
+	> File Name: Master.h
+	> Author:
+	> Mail:
+	> Created Time: Sat 24 Oct 2026 02:18:40 PM CST
+ ************************************************************************/
+
+// 与nginx相同的多进程模型：主进程创建监听套接字后fork出若干工作进程，自己不处理请求，只负责
+//   工作进程异常退出时重新拉起；
+//   SIGQUIT：通知工作进程平滑退出（不再接受新连接，处理完现有连接后退出），全部退出后主进程退出；
+//   SIGTERM/SIGINT：立即终止；
+//   SIGUSR2：启动新的可执行文件。新主进程通过Unix域套接字（SCM_RIGHTS）从旧主进程接过监听套接字与共享密钥，
+//   工作进程就绪后旧主进程平滑退出（直接启动新的可执行文件也会走同样的交接流程）。
+// 发给工作进程的 SIGUSR1/SIGUSR2 用于输出与清零剖析表（见 Profiler.h，编译时打开剖析才有效，否则忽略），主进程忽略 SIGUSR1。
+// 每个TCP地址为每个工作进程创建一个SO_REUSEPORT套接字，由内核在工作进程之间分配新连接（Unix域套接字不支持，所有工作进程共用一个）。
+// 套接字始终由主进程持有：工作进程崩溃后已排队的连接留给重启后的进程，升级时新旧进程共用同一批套接字，不会拒绝任何连接
+#ifndef _MASTER_H
+#define _MASTER_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/signalfd.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <chrono>
+#include <openssl/rand.h>
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+
+#include "Logger.h"
+#include "Listener.h"
+
+// 多进程模型的配置
+struct MasterOptions {
+	int workers = 1; // 工作进程数，为0时不fork，在当前进程中直接运行（单进程模式，不支持升级）
+	std::string controlSocket = "master.sock"; // 升级时新旧主进程交接监听套接字的Unix域套接字
+	int drainTimeoutSeconds = 30; // 平滑退出时等待工作进程的最长时间，超时后强制结束
+};
+
+class ProcessMaster {
+public:
+	// 工作进程的入口：slot 为工作进程编号，listeners 与 listen() 的调用顺序一一对应；返回值为进程退出码
+	using WorkerMain = std::function<int(int slot, const std::vector<int>& listeners)>;
+
+	ProcessMaster(char* argv[], const MasterOptions& options = MasterOptions())
+		: options(options), signalFd(-1), controlFd(-1), peerFd(-1), handoffFd(-1),
+		  quitting(false), handedOver(false) {
+		for (char** arg = argv; *arg; ++arg) arguments.push_back(*arg);
+		char path[PATH_MAX];
+		executable = (argv[0] && strchr(argv[0], '/') && realpath(argv[0], path)) ? path : "/proc/self/exe";
+	}
+
+	~ProcessMaster() {
+		for (auto& perPort : sockets) {
+			for (int fd : perPort) close(fd);
+		}
+		if (signalFd != -1) close(signalFd);
+		if (peerFd != -1) close(peerFd);
+		if (handoffFd != -1) close(handoffFd);
+		if (controlFd != -1) {
+			close(controlFd);
+			if (!handedOver) unlink(options.controlSocket.c_str());
+		}
+		if (!handedOver && !workerProcess) {
+			for (const auto& address : addresses) address.unlinkPath();
+		}
+	}
+
+	ProcessMaster(const ProcessMaster&) = delete;
+	ProcessMaster& operator=(const ProcessMaster&) = delete;
+
+	// 注册一个监听地址，需在 run() 之前调用
+	void listen(const ListenAddress& address) {
+		addresses.push_back(address);
+	}
+
+	void listen(int port) {
+		listen(ListenAddress::tcp(port));
+	}
+
+	// 由共享密钥派生的子密钥（十六进制）。共享密钥在所有工作进程之间相同，升级时由旧主进程传给新主进程，
+	// 用它配置TLS票据密钥与登录令牌密钥，各工作进程以及升级前后的进程都能互认对方签发的票据与令牌
+	std::string deriveKey(const std::string& label) const {
+		unsigned char mac[EVP_MAX_MD_SIZE];
+		unsigned int length = 0;
+		HMAC(EVP_sha256(), secret.data(), int(secret.size()),
+			reinterpret_cast<const unsigned char*>(label.data()), label.size(), mac, &length);
+		static const char digits[] = "0123456789abcdef";
+		std::string hex;
+		for (unsigned int i = 0; i < length; i++) {
+			hex += digits[mac[i] >> 4];
+			hex += digits[mac[i] & 0xf];
+		}
+		return hex;
+	}
+
+	// 在工作进程中注册收到SIGQUIT（平滑退出）时的回调。回调在信号处理函数中执行，
+	// 只能做异步信号安全的操作（例如 HttpServer::drain）；注册前已收到信号时立即执行
+	static void onQuit(std::function<void()> callback) {
+		sigset_t set, previous;
+		sigemptyset(&set);
+		sigaddset(&set, SIGQUIT);
+		sigprocmask(SIG_BLOCK, &set, &previous);
+		quitCallbacks().push_back(callback);
+		bool requested = quitRequested();
+		sigprocmask(SIG_SETMASK, &previous, nullptr);
+		if (requested) callback();
+	}
+
+	// 运行：单进程模式下直接执行 workerMain；否则fork工作进程并进入主进程的监控循环，返回进程退出码
+	int run(WorkerMain main) {
+		workerMain = std::move(main);
+		bool upgrading = options.workers > 0 && inherit(); // 有正在运行的主进程时从它那里接过监听套接字
+		if (!upgrading) generateSecret();
+		createListeners();
+		if (options.workers == 0) {
+			installWorkerSignals();
+			return workerMain(0, listenersFor(0));
+		}
+		setupSignals();
+		pids.assign(options.workers, -1);
+		spawnedAt.assign(options.workers, Clock::time_point());
+		restartAt.assign(options.workers, Clock::time_point());
+		for (int slot = 0; slot < options.workers; slot++) spawn(slot);
+		if (upgrading) {
+			// 工作进程已经在同一批套接字上接受连接，通知旧主进程平滑退出
+			if (send(handoffFd, "R", 1, MSG_NOSIGNAL) != 1) LOG_ERROR("Failed to notify the old master: %s", strerror(errno));
+			close(handoffFd);
+			handoffFd = -1;
+		}
+		openControlSocket();
+		LOG_INFO("Master %d running %d workers", int(getpid()), options.workers);
+		return loop();
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+	static const uint32_t kMagic = 0x48535551; // 交接协议的版本标识
+	static const size_t kSecretSize = 32;
+
+	// 交接协议的第一条消息，其后每个套接字一条消息：监听地址（ListenAddress::toString）+ SCM_RIGHTS 携带的fd
+	struct Hello {
+		uint32_t magic;
+		uint32_t total; // 监听套接字的总数
+		unsigned char secret[kSecretSize];
+	};
+
+	MasterOptions options;
+	std::vector<std::string> arguments; // 升级时以相同的参数启动新的可执行文件
+	std::string executable;
+	std::vector<ListenAddress> addresses;
+	std::vector<std::vector<int> > sockets; // sockets[地址序号][工作进程编号]
+	std::vector<std::pair<std::string, int> > inherited; // 从旧主进程接过的 (地址, fd)
+	std::string secret;
+	WorkerMain workerMain;
+	std::vector<pid_t> pids; // 每个编号上的工作进程，-1表示没有
+	std::vector<Clock::time_point> spawnedAt, restartAt;
+	int signalFd; // 主进程通过signalfd同步处理信号
+	int controlFd; // 等待新主进程连接的Unix域套接字
+	int peerFd; // 正在与之交接的新主进程
+	int handoffFd; // 升级中的新主进程：与旧主进程的连接
+	sigset_t savedMask;
+	bool quitting, handedOver;
+	bool workerProcess = false; // fork出的工作进程中为true
+	Clock::time_point deadline; // 平滑退出的截止时间
+
+	static volatile sig_atomic_t& quitRequested() {
+		static volatile sig_atomic_t requested = 0;
+		return requested;
+	}
+
+	static std::vector<std::function<void()> >& quitCallbacks() {
+		static std::vector<std::function<void()> > callbacks;
+		return callbacks;
+	}
+
+	static void quitHandler(int) {
+		quitRequested() = 1;
+		for (auto& callback : quitCallbacks()) callback();
+	}
+
+	static void installWorkerSignals() {
+		struct sigaction action = {};
+		action.sa_handler = quitHandler;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGQUIT, &action, nullptr);
+		signal(SIGUSR1, SIG_IGN); // 打开剖析时由 Profiler::installSignals 接管
+		signal(SIGUSR2, SIG_IGN);
+		signal(SIGHUP, SIG_IGN);
+		signal(SIGCHLD, SIG_DFL);
+	}
+
+	void generateSecret() {
+		secret.resize(kSecretSize);
+		if (RAND_bytes(reinterpret_cast<unsigned char*>(&secret[0]), kSecretSize) != 1) {
+			LOG_ERROR("RAND_bytes failed");
+			throw std::runtime_error("RAND_bytes failed");
+		}
+	}
+
+	std::vector<int> listenersFor(int slot) const {
+		std::vector<int> listeners;
+		for (const auto& perPort : sockets) listeners.push_back(perPort[slot]);
+		return listeners;
+	}
+
+	// 每个地址准备 workers 个套接字：优先使用继承来的，不够时新建。
+	// Unix域套接字不支持SO_REUSEPORT，各工作进程持有同一个套接字的副本（dup），从同一个队列accept
+	void createListeners() {
+		size_t perAddress = options.workers > 0 ? options.workers : 1;
+		for (const auto& address : addresses) {
+			size_t count = 0;
+			for (auto& entry : inherited) count += entry.first == address.toString();
+			if (count > perAddress) {
+				// 关闭继承来的套接字会丢掉其中排队的连接，改为增加工作进程
+				LOG_WARNING("Inherited %zu listeners for %s, raising workers to match", count, address.toString().c_str());
+				perAddress = count;
+			}
+		}
+		if (options.workers > 0) options.workers = int(perAddress);
+		for (const auto& address : addresses) {
+			std::vector<int> perAddressSockets;
+			for (auto& entry : inherited) {
+				if (entry.first == address.toString() && entry.second != -1) {
+					perAddressSockets.push_back(entry.second);
+					entry.second = -1;
+				}
+			}
+			while (perAddressSockets.size() < perAddress) {
+				int fd = address.isUnix() && !perAddressSockets.empty() ? fcntl(perAddressSockets[0], F_DUPFD_CLOEXEC, 0)
+					: address.open(true);
+				if (fd == -1) {
+					LOG_ERROR("dup of listener %s failed: %s", address.toString().c_str(), strerror(errno));
+					throw std::runtime_error("dup failed");
+				}
+				perAddressSockets.push_back(fd);
+			}
+			sockets.push_back(perAddressSockets);
+			LOG_INFO("Master listening on %s", address.toString().c_str());
+		}
+		for (auto& entry : inherited) {
+			if (entry.second == -1) continue;
+			LOG_WARNING("Closing inherited listener for unused address %s", entry.first.c_str());
+			close(entry.second);
+		}
+		inherited.clear();
+	}
+
+	// 主进程用signalfd处理信号，工作进程在fork后恢复原来的信号屏蔽字
+	void setupSignals() {
+		sigset_t set;
+		sigemptyset(&set);
+		int signals[] = {SIGCHLD, SIGQUIT, SIGTERM, SIGINT, SIGUSR1, SIGUSR2, SIGHUP};
+		for (int sig : signals) sigaddset(&set, sig);
+		sigprocmask(SIG_BLOCK, &set, &savedMask);
+		signalFd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+		if (signalFd == -1) {
+			LOG_ERROR("signalfd failed: %s", strerror(errno));
+			throw std::runtime_error("signalfd failed");
+		}
+	}
+
+	void spawn(int slot) {
+		fflush(nullptr); // 避免子进程重复输出主进程缓冲区中的内容
+		pid_t master = getpid();
+		pid_t pid = fork();
+		if (pid < 0) {
+			LOG_ERROR("fork failed: %s", strerror(errno));
+			restartAt[slot] = Clock::now() + std::chrono::seconds(1);
+			return ;
+		}
+		if (pid == 0) {
+			workerProcess = true;
+			installWorkerSignals();
+			sigprocmask(SIG_SETMASK, &savedMask, nullptr);
+			prctl(PR_SET_PDEATHSIG, SIGQUIT); // 主进程意外退出时工作进程平滑退出
+			if (getppid() != master) raise(SIGQUIT);
+			int fds[] = {signalFd, controlFd, peerFd, handoffFd};
+			for (int fd : fds) {
+				if (fd != -1) close(fd);
+			}
+			for (auto& perPort : sockets) {
+				for (int other = 0; other < int(perPort.size()); other++) {
+					if (other != slot) close(perPort[other]);
+				}
+			}
+			int code = workerMain(slot, listenersFor(slot));
+			fflush(nullptr);
+			_exit(code);
+		}
+		pids[slot] = pid;
+		spawnedAt[slot] = Clock::now();
+		LOG_INFO("Started worker %d (pid %d)", slot, int(pid));
+	}
+
+	int loop() {
+		while (true) {
+			struct pollfd fds[3];
+			int count = 0;
+			fds[count++] = {signalFd, POLLIN, 0};
+			if (controlFd != -1 && peerFd == -1) fds[count++] = {controlFd, POLLIN, 0};
+			if (peerFd != -1) fds[count++] = {peerFd, POLLIN, 0};
+			if (poll(fds, count, pollTimeout()) < 0 && errno != EINTR) {
+				LOG_ERROR("poll failed: %s", strerror(errno));
+			}
+			for (int i = 0; i < count; i++) {
+				if (!fds[i].revents) continue;
+				if (fds[i].fd == signalFd) handleSignals();
+				else if (fds[i].fd == controlFd) acceptPeer();
+				else if (fds[i].fd == peerFd) handlePeer();
+			}
+			Clock::time_point now = Clock::now();
+			bool alive = false;
+			for (int slot = 0; slot < int(pids.size()); slot++) {
+				if (pids[slot] == -1 && !quitting && now >= restartAt[slot]) spawn(slot);
+				alive = alive || pids[slot] != -1;
+			}
+			if (quitting && !alive) break;
+			if (quitting && now >= deadline) {
+				LOG_WARNING("Workers did not finish within %d seconds, killing them", options.drainTimeoutSeconds);
+				for (pid_t pid : pids) {
+					if (pid != -1) kill(pid, SIGKILL);
+				}
+				deadline = now + std::chrono::hours(24);
+			}
+		}
+		LOG_INFO("Master %d exiting", int(getpid()));
+		return 0;
+	}
+
+	int pollTimeout() const {
+		Clock::time_point now = Clock::now();
+		Clock::time_point next = Clock::time_point::max();
+		for (int slot = 0; slot < int(pids.size()); slot++) {
+			if (pids[slot] == -1 && !quitting && restartAt[slot] < next) next = restartAt[slot];
+		}
+		if (quitting && deadline < next) next = deadline;
+		if (next == Clock::time_point::max()) return -1;
+		if (next <= now) return 0;
+		return int(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count()) + 1;
+	}
+
+	void handleSignals() {
+		struct signalfd_siginfo info;
+		while (read(signalFd, &info, sizeof(info)) == sizeof(info)) {
+			switch (info.ssi_signo) {
+				case SIGCHLD: reapWorkers(); break;
+				case SIGQUIT: beginQuit(true); break;
+				case SIGTERM:
+				case SIGINT: beginQuit(false); break;
+				case SIGUSR2: startNewBinary(); break;
+				default: break; // SIGUSR1/SIGHUP：忽略
+			}
+		}
+	}
+
+	void reapWorkers() {
+		int status = 0;
+		pid_t pid;
+		while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+			int slot = -1;
+			for (int i = 0; i < int(pids.size()); i++) {
+				if (pids[i] == pid) slot = i;
+			}
+			if (slot == -1) {
+				LOG_INFO("Process %d exited with status %d", int(pid), status); // 升级时启动的新主进程
+				continue;
+			}
+			pids[slot] = -1;
+			if (quitting) continue;
+			if (WIFSIGNALED(status)) {
+				LOG_ERROR("Worker %d (pid %d) killed by signal %d, restarting", slot, int(pid), WTERMSIG(status));
+			} else {
+				LOG_ERROR("Worker %d (pid %d) exited with code %d, restarting", slot, int(pid), WEXITSTATUS(status));
+			}
+			// 启动后不到1秒就退出时推迟重启，避免反复崩溃占满CPU
+			Clock::time_point now = Clock::now();
+			restartAt[slot] = now - spawnedAt[slot] < std::chrono::seconds(1) ? now + std::chrono::seconds(1) : now;
+		}
+	}
+
+	// graceful 为true时工作进程处理完现有连接后退出，否则立即终止
+	void beginQuit(bool graceful) {
+		if (quitting && graceful) return;
+		quitting = true;
+		deadline = Clock::now() + (graceful ? std::chrono::seconds(options.drainTimeoutSeconds) : std::chrono::seconds(1));
+		LOG_INFO("Master %d %s", int(getpid()), graceful ? "draining workers" : "terminating workers");
+		for (pid_t pid : pids) {
+			if (pid != -1) kill(pid, graceful ? SIGQUIT : SIGTERM);
+		}
+		// 不再重启工作进程，释放主进程持有的监听套接字：工作进程都停止接受后新连接立即被拒绝，
+		// 而不是排在没有人接受的队列里（升级时新主进程持有同一批套接字，不受影响）
+		for (auto& perPort : sockets) {
+			for (int fd : perPort) close(fd);
+		}
+		sockets.clear();
+	}
+
+	// SIGUSR2：以相同的参数启动（可能已被替换的）可执行文件，由它连接控制套接字完成交接
+	void startNewBinary() {
+		if (quitting || peerFd != -1) return;
+		fflush(nullptr);
+		pid_t pid = fork();
+		if (pid == 0) {
+			sigprocmask(SIG_SETMASK, &savedMask, nullptr);
+			std::vector<char*> argv;
+			for (auto& arg : arguments) argv.push_back(const_cast<char*>(arg.c_str()));
+			argv.push_back(nullptr);
+			execv(executable.c_str(), argv.data());
+			_exit(127);
+		}
+		if (pid < 0) LOG_ERROR("fork for upgrade failed: %s", strerror(errno));
+		else LOG_INFO("Started %s (pid %d) for binary upgrade", executable.c_str(), int(pid));
+	}
+
+	void openControlSocket() {
+		if (options.controlSocket.size() >= sizeof(((struct sockaddr_un*)nullptr)->sun_path)) {
+			LOG_WARNING("Control socket path too long, binary upgrade disabled");
+			return ;
+		}
+		struct sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, options.controlSocket.c_str());
+		controlFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+		unlink(address.sun_path); // 旧主进程（或上次残留）的套接字文件
+		if (controlFd == -1 || bind(controlFd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+			chmod(address.sun_path, 0600) < 0 || ::listen(controlFd, 4) < 0) {
+			LOG_WARNING("Control socket %s unavailable (%s), binary upgrade disabled", address.sun_path, strerror(errno));
+			if (controlFd != -1) close(controlFd);
+			controlFd = -1;
+		}
+	}
+
+	// 旧主进程：接受新主进程的连接，只接受同一用户的进程
+	void acceptPeer() {
+		int fd = accept4(controlFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (fd == -1) return;
+		struct ucred cred = {};
+		socklen_t len = sizeof(cred);
+		if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 || cred.uid != getuid()) {
+			LOG_WARNING("Rejected control connection from uid %d", int(cred.uid));
+			close(fd);
+			return ;
+		}
+		peerFd = fd;
+	}
+
+	// 旧主进程：'U' 请求交接，'R' 表示新主进程的工作进程已就绪
+	void handlePeer() {
+		char request = 0;
+		ssize_t n = recv(peerFd, &request, 1, 0);
+		if (n == 1 && request == 'U') {
+			if (!sendListeners(peerFd)) abortUpgrade();
+			return ;
+		}
+		if (n == 1 && request == 'R') {
+			LOG_INFO("New master took over the listeners");
+			close(peerFd);
+			peerFd = -1;
+			close(controlFd); // 套接字文件已归新主进程所有
+			controlFd = -1;
+			handedOver = true;
+			beginQuit(true);
+			return ;
+		}
+		abortUpgrade();
+	}
+
+	// 新主进程在就绪之前退出：继续服务，并重新创建可能已被新主进程删除的控制套接字
+	void abortUpgrade() {
+		LOG_WARNING("Binary upgrade aborted");
+		close(peerFd);
+		peerFd = -1;
+		if (controlFd != -1) close(controlFd);
+		controlFd = -1;
+		openControlSocket();
+	}
+
+	bool sendListeners(int fd) {
+		size_t total = 0;
+		for (const auto& perAddress : sockets) total += perAddress.size();
+		Hello hello = {};
+		hello.magic = kMagic;
+		hello.total = uint32_t(total);
+		memcpy(hello.secret, secret.data(), kSecretSize);
+		if (send(fd, &hello, sizeof(hello), MSG_NOSIGNAL) != ssize_t(sizeof(hello))) return false;
+		for (size_t i = 0; i < sockets.size(); i++) {
+			std::string name = addresses[i].toString();
+			for (int listener : sockets[i]) {
+				char control[CMSG_SPACE(sizeof(int))] = {};
+				struct iovec iov = {&name[0], name.size()};
+				struct msghdr msg = {};
+				msg.msg_iov = &iov;
+				msg.msg_iovlen = 1;
+				msg.msg_control = control;
+				msg.msg_controllen = sizeof(control);
+				struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+				cmsg->cmsg_level = SOL_SOCKET;
+				cmsg->cmsg_type = SCM_RIGHTS;
+				cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+				memcpy(CMSG_DATA(cmsg), &listener, sizeof(int));
+				if (sendmsg(fd, &msg, MSG_NOSIGNAL) < 0) return false;
+			}
+		}
+		LOG_INFO("Handed %zu listeners to the new master", total);
+		return true;
+	}
+
+	// 新主进程：连接正在运行的主进程并接过监听套接字与共享密钥；没有正在运行的主进程时返回false
+	bool inherit() {
+		if (options.controlSocket.size() >= sizeof(((struct sockaddr_un*)nullptr)->sun_path)) return false;
+		struct sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, options.controlSocket.c_str());
+		int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+		if (fd == -1 || connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+			if (fd != -1) close(fd);
+			return false;
+		}
+		struct timeval timeout = {5, 0};
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		Hello hello = {};
+		if (send(fd, "U", 1, MSG_NOSIGNAL) != 1 || recv(fd, &hello, sizeof(hello), 0) != ssize_t(sizeof(hello)) ||
+			hello.magic != kMagic) {
+			close(fd);
+			LOG_ERROR("Handoff from the running master failed");
+			throw std::runtime_error("listener handoff failed");
+		}
+		secret.assign(reinterpret_cast<char*>(hello.secret), kSecretSize);
+		while (inherited.size() < hello.total) {
+			char name[256];
+			char control[CMSG_SPACE(sizeof(int))];
+			struct iovec iov = {name, sizeof(name)};
+			struct msghdr msg = {};
+			msg.msg_iov = &iov;
+			msg.msg_iovlen = 1;
+			msg.msg_control = control;
+			msg.msg_controllen = sizeof(control);
+			ssize_t n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+			struct cmsghdr* cmsg = n > 0 ? CMSG_FIRSTHDR(&msg) : nullptr;
+			if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(int))) {
+				for (auto& entry : inherited) close(entry.second);
+				close(fd);
+				LOG_ERROR("Malformed listener handoff message");
+				throw std::runtime_error("listener handoff failed");
+			}
+			int listener;
+			memcpy(&listener, CMSG_DATA(cmsg), sizeof(int));
+			inherited.emplace_back(std::string(name, n), listener);
+		}
+		handoffFd = fd;
+		LOG_INFO("Inherited %zu listeners from the running master", inherited.size());
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,164 @@
+/*************************************************************************
+	> File Name: Middleware.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 26 Oct 2026 10:12:48 AM CST
+ ************************************************************************/
+
+// 编译期组合的中间件：Pipeline<A, B, C> 把日志、计时、CORS等横切逻辑套在处理函数外面，
+// 整条链在编译期展开成一个函数（每层的调用都可以内联），不经过逐层的 std::function，也不分配内存；
+// 只有包装好的处理函数在注册路由时放进一个 std::function。不同的路由可以使用不同的组合：
+//   Pipeline<AccessLog, Timing> api;
+//   router.addRoute("GET", "/x", api.wrap([](const HttpRequest& req) { ... }));
+//   router.addAsyncRoute("POST", "/y", api.wrap([](const HttpRequest& req) -> Task<HttpResponse> { ... }));
+// 一层中间件继承 Middleware，按需定义：
+//   State                                          每个请求一份的状态（例如开始时间），放在调用栈或协程帧中
+//   std::optional<HttpResponse> before(req, state)  在处理函数之前执行，返回响应时不再调用后面的层与处理函数
+//   void after(req, response, state)               在处理函数之后按相反的顺序执行，可以修改响应
+// 某层在 before 中直接返回响应时，只有它外面的层会执行 after
+#ifndef _MIDDLEWARE_H
+#define _MIDDLEWARE_H
+
+#include <tuple>
+#include <optional>
+#include <utility>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <type_traits>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Coroutine.h"
+#include "Logger.h"
+
+// 中间件的默认实现：什么都不做
+struct Middleware {
+	struct State {};
+
+	template <class S>
+	std::optional<HttpResponse> before(const HttpRequest&, S&) const { return std::nullopt; }
+
+	template <class S>
+	void after(const HttpRequest&, HttpResponse&, S&) const {}
+};
+
+template <class... Layers>
+class Pipeline {
+public:
+	Pipeline() = default;
+
+	// 需要参数的层（例如 Cors 的来源）；空的 Pipeline<> 只有默认构造函数
+	explicit Pipeline(Layers... layers) requires (sizeof...(Layers) > 0) : layers(std::move(layers)...) {}
+
+	// 包装处理函数：返回 HttpResponse 的用于 addRoute，返回 Task<HttpResponse> 的（协程）用于 addAsyncRoute
+	template <class Handler>
+	auto wrap(Handler handler) const {
+		if constexpr (std::is_same_v<std::invoke_result_t<Handler&, const HttpRequest&>, Task<HttpResponse> >) {
+			// 整条链在同一个协程帧中执行，每一层不会各自再创建协程
+			return [layers = layers, handler = std::move(handler)](const HttpRequest& request) -> Task<HttpResponse> {
+				States states;
+				size_t entered = 0;
+				// co_await 不能放在条件运算符中（GCC 12 在这种写法下会重复析构临时对象），这里仍经过 optional
+				std::optional<HttpResponse> response = runBefore(layers, states, request, entered, Indices());
+				if (!response) response.emplace(co_await handler(request));
+				runAfter(layers, states, request, *response, entered, Indices());
+				co_return std::move(*response);
+			};
+		} else {
+			return [layers = layers, handler = std::move(handler)](const HttpRequest& request) -> HttpResponse {
+				States states;
+				size_t entered = 0;
+				std::optional<HttpResponse> early = runBefore(layers, states, request, entered, Indices());
+				HttpResponse response = early ? std::move(*early) : handler(request); // 通常的路径上直接构造，不经过 optional
+				runAfter(layers, states, request, response, entered, Indices());
+				return response;
+			};
+		}
+	}
+
+private:
+	using States = std::tuple<typename Layers::State...>;
+	using Indices = std::index_sequence_for<Layers...>;
+	static const size_t kCount = sizeof...(Layers);
+
+	std::tuple<Layers...> layers;
+
+	// 依次执行 before，遇到返回响应的层时停止；entered 为 before 没有返回响应的层数
+	template <size_t... I>
+	static std::optional<HttpResponse> runBefore(const std::tuple<Layers...>& layers, States& states, const HttpRequest& request,
+		size_t& entered, std::index_sequence<I...>) {
+		std::optional<HttpResponse> response;
+		(void)((!(response = std::get<I>(layers).before(request, std::get<I>(states))) && ++entered) && ...);
+		return response;
+	}
+
+	// 按相反的顺序对进入过的层执行 after
+	template <size_t... I>
+	static void runAfter(const std::tuple<Layers...>& layers, States& states, const HttpRequest& request, HttpResponse& response,
+		size_t entered, std::index_sequence<I...>) {
+		((kCount - 1 - I < entered ? std::get<kCount - 1 - I>(layers).after(request, response, std::get<kCount - 1 - I>(states)) : void()), ...);
+	}
+};
+
+// 访问日志：方法、路径、状态码与处理耗时
+struct AccessLog : Middleware {
+	struct State {
+		std::chrono::steady_clock::time_point start;
+	};
+
+	std::optional<HttpResponse> before(const HttpRequest&, State& state) const {
+		state.start = std::chrono::steady_clock::now();
+		return std::nullopt;
+	}
+
+	void after(const HttpRequest& request, HttpResponse& response, State& state) const {
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state.start).count();
+		LOG_INFO("%s %.*s -> %d (%.3f ms)", request.getMethodString().c_str(), int(request.getPath().size()), request.getPath().data(),
+			response.getStatusCode(), ms);
+	}
+};
+
+// 在响应中加上 Server-Timing 头（浏览器开发者工具中可见的处理耗时）
+struct Timing : Middleware {
+	struct State {
+		std::chrono::steady_clock::time_point start;
+	};
+
+	std::optional<HttpResponse> before(const HttpRequest&, State& state) const {
+		state.start = std::chrono::steady_clock::now();
+		return std::nullopt;
+	}
+
+	void after(const HttpRequest&, HttpResponse& response, State& state) const {
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - state.start).count();
+		char value[48];
+		snprintf(value, sizeof(value), "app;dur=%.3f", ms);
+		response.setHeader("Server-Timing", value);
+	}
+};
+
+// 跨域访问：响应中加上 Access-Control-Allow-Origin，预检请求（OPTIONS）直接回复204
+struct Cors : Middleware {
+	std::string origin = "*";
+	std::string methods = "GET, POST, OPTIONS";
+
+	Cors() = default;
+	explicit Cors(std::string origin) : origin(std::move(origin)) {}
+
+	std::optional<HttpResponse> before(const HttpRequest& request, State&) const {
+		if (request.getMethodString() != "OPTIONS") return std::nullopt;
+		HttpResponse response(204);
+		response.setHeader("Access-Control-Allow-Methods", methods);
+		response.setHeader("Access-Control-Allow-Headers", "Authorization, Content-Type");
+		response.setHeader("Access-Control-Max-Age", "600");
+		response.setHeader("Access-Control-Allow-Origin", origin);
+		return response;
+	}
+
+	void after(const HttpRequest&, HttpResponse& response, State&) const {
+		response.setHeader("Access-Control-Allow-Origin", origin);
+	}
+};
+
+#endif
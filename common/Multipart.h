@@ -0,0 +1,479 @@
+/*************************************************************************
+	> File Name: Multipart.h
+	> Author:
+	> Mail:
+	> Created Time: Tue 27 Oct 2026 04:36:12 PM CST
+ ************************************************************************/
+
+// 流式上传：multipart/form-data 请求体边到达边解析，文件部分直接写入磁盘，内存占用与上传大小无关。
+//   BoundarySearch   Boyer-Moore-Horspool 查找分隔符（"\r\n--" + boundary），大部分字节被整段跳过
+//   MultipartParser  增量解析器，分隔符跨越两次到达的数据也能识别，只保留不到一个分隔符长度的数据
+//   UploadReceiver   把各部分交给路由的回调：文件写入 UploadOptions::directory 下的临时文件，普通字段保存在内存中
+// 非 multipart 的请求体（例如 application/octet-stream）整体作为一个文件部分保存，
+// 明文连接上这种请求体经管道用 splice(2) 从套接字直接搬到文件，数据不经过用户态（见 HttpServer::spliceUpload）
+#ifndef _MULTIPART_H
+#define _MULTIPART_H
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <strings.h>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Logger.h"
+
+struct UploadOptions {
+	std::string directory = "uploads"; // 文件部分保存的目录，不存在时创建
+	size_t maxBodyBytes = size_t(2) << 30; // 整个请求体的上限
+	size_t maxFileBytes = size_t(1) << 30; // 单个文件的上限
+	size_t maxFieldBytes = 64 * 1024; // 单个普通字段的上限（保存在内存中）
+	size_t maxParts = 64; // 部分数的上限
+	size_t maxPartHeaderBytes = 8 * 1024; // 每个部分头部的上限
+};
+
+// 上传的一个部分
+struct UploadPart {
+	std::string name; // Content-Disposition 中的 name
+	std::string filename; // 客户端给出的文件名（已去掉目录），普通字段为空
+	std::string contentType;
+	std::string value; // 普通字段的内容
+	std::string path; // 文件部分保存到的临时文件；处理函数要保留文件时把它移走（rename）并清空 path，否则请求结束后删除
+	size_t size = 0; // 内容的字节数
+};
+
+// 上传路由的回调，都在处理该连接的工作线程中执行
+struct UploadHandler {
+	std::function<bool(const HttpRequest&, const UploadPart&)> onPartBegin; // 部分的头部解析完时调用，返回false时丢弃该部分
+	std::function<void(const HttpRequest&, UploadPart&)> onPart; // 部分接收完时调用（文件已写完并关闭）
+	std::function<HttpResponse(const HttpRequest&, std::vector<UploadPart>&)> onComplete; // 请求体全部接收完时生成响应
+};
+
+struct UploadRoute {
+	UploadHandler handler;
+	UploadOptions options;
+};
+
+// Boyer-Moore-Horspool：按窗口最后一个字节查表决定右移的距离，不匹配时一次跳过接近整个模式的长度
+class BoundarySearch {
+public:
+	static const size_t npos = size_t(-1);
+
+	explicit BoundarySearch(std::string_view pattern) : pattern(pattern) {
+		for (size_t& s : skip) s = pattern.size();
+		for (size_t i = 0; i + 1 < pattern.size(); i++) skip[static_cast<unsigned char>(pattern[i])] = pattern.size() - 1 - i;
+	}
+
+	// 返回模式在 data 中第一次出现的位置，没有时返回 npos
+	size_t find(const char* data, size_t len) const {
+		const size_t m = pattern.size();
+		if (m == 0 || len < m) return npos;
+		const char last = pattern[m - 1];
+		for (size_t i = 0; i <= len - m; ) {
+			char c = data[i + m - 1];
+			if (c == last && memcmp(data + i, pattern.data(), m - 1) == 0) return i;
+			i += skip[static_cast<unsigned char>(c)];
+		}
+		return npos;
+	}
+
+private:
+	std::string pattern;
+	size_t skip[256];
+};
+
+// multipart/form-data 的增量解析器。Sink 需要提供：
+//   bool partBegin(UploadPart part)               一个部分的头部解析完
+//   bool partData(const char* data, size_t len)   该部分的一段内容
+//   bool partEnd()                                该部分结束
+// 任一回调返回false时解析中止
+class MultipartParser {
+public:
+	MultipartParser(std::string_view boundary, size_t maxHeaderBytes)
+		: delimiter("\r\n--" + std::string(boundary)), searcher(delimiter), maxHeaderBytes(maxHeaderBytes), held("\r\n") {}
+		// 请求体以 "--boundary" 开头，前面补一个CRLF，第一个分隔符与之后的写法相同
+
+	// 从 Content-Type 中取出 boundary，不是 multipart/form-data 或 boundary 非法时返回空
+	static std::string boundaryOf(std::string_view contentType) {
+		std::string_view type = contentType.substr(0, contentType.find(';'));
+		while (!type.empty() && type.back() == ' ') type.remove_suffix(1);
+		if (type.size() != 19 || strncasecmp(type.data(), "multipart/form-data", 19) != 0) return std::string();
+		std::string boundary = parameter(contentType, "boundary");
+		return boundary.size() <= 70 ? boundary : std::string();
+	}
+
+	// 头部参数（例如 Content-Disposition 中的 name、filename），值可以带引号；不存在时返回空
+	static std::string parameter(std::string_view header, std::string_view key) {
+		size_t pos = header.find(';');
+		while (pos != std::string_view::npos) {
+			size_t start = header.find_first_not_of(" \t", pos + 1);
+			if (start == std::string_view::npos) break;
+			size_t eq = header.find('=', start);
+			size_t end = header.find(';', start);
+			if (eq != std::string_view::npos && eq < end) {
+				std::string_view name = header.substr(start, eq - start);
+				while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+				if (name.size() == key.size() && strncasecmp(name.data(), key.data(), key.size()) == 0) {
+					std::string_view value = header.substr(eq + 1);
+					if (!value.empty() && value.front() == '"') { // 引号中可以有分号，按转义规则取到下一个引号
+						std::string result;
+						for (size_t i = 1; i < value.size() && value[i] != '"'; i++) {
+							if (value[i] == '\\' && i + 1 < value.size()) i++;
+							result += value[i];
+						}
+						return result;
+					}
+					value = value.substr(0, value.find(';'));
+					while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+					return std::string(value);
+				}
+			}
+			pos = end;
+		}
+		return std::string();
+	}
+
+	// 解析一段数据；格式非法或回调中止时返回false（malformed() 区分两者）
+	template <class Sink>
+	bool feed(const char* data, size_t len, Sink& sink) {
+		size_t i = 0;
+		while (i < len) {
+			switch (state) {
+				case PREAMBLE:
+				case BODY: {
+					size_t consumed = 0;
+					bool found = false;
+					if (!scan(data + i, len - i, sink, consumed, found)) return false;
+					i += consumed;
+					if (found) {
+						if (state == BODY && !sink.partEnd()) return false;
+						state = AFTER_DELIMITER;
+						marker = 0;
+					}
+					break;
+				}
+				case AFTER_DELIMITER: { // "--" 表示最后一个分隔符，CRLF 之后是下一个部分的头部（之前可以有空白）
+					char c = data[i++];
+					if (marker == 0) {
+						if (c == ' ' || c == '\t') break;
+						if (c != '-' && c != '\r') return fail();
+						marker = c;
+						break;
+					}
+					if (marker == '-' && c == '-') {
+						state = EPILOGUE;
+					} else if (marker == '\r' && c == '\n') {
+						state = HEADERS;
+						headers.clear();
+					} else {
+						return fail();
+					}
+					break;
+				}
+				case HEADERS: { // 头部很短，逐字节找空行
+					headers += data[i++];
+					if (headers.size() > maxHeaderBytes) return fail();
+					if (headers == "\r\n" || (headers.size() >= 4 && headers.compare(headers.size() - 4, 4, "\r\n\r\n") == 0)) {
+						UploadPart part;
+						if (!parseHeaders(part)) return fail();
+						state = BODY;
+						if (!sink.partBegin(std::move(part))) return false;
+					}
+					break;
+				}
+				case EPILOGUE: // 最后一个分隔符之后的数据忽略
+					i = len;
+					break;
+			}
+		}
+		return true;
+	}
+
+	// 是否已经读到最后一个分隔符
+	bool finished() const {
+		return state == EPILOGUE;
+	}
+
+	bool malformed() const {
+		return bad;
+	}
+
+private:
+	enum State { PREAMBLE, AFTER_DELIMITER, HEADERS, BODY, EPILOGUE };
+
+	std::string delimiter;
+	BoundarySearch searcher;
+	size_t maxHeaderBytes;
+	State state = PREAMBLE;
+	std::string held; // 上一段数据末尾可能是分隔符开头的部分，长度小于分隔符
+	std::string headers; // 正在读取的部分头部
+	char marker = 0; // 分隔符之后读到的第一个字符
+	bool bad = false;
+
+	bool fail() {
+		bad = true;
+		return false;
+	}
+
+	// 把确定属于内容的数据交给 sink（序言直接丢弃）
+	template <class Sink>
+	bool emit(Sink& sink, const char* data, size_t len) {
+		return state != BODY || len == 0 || sink.partData(data, len);
+	}
+
+	// 在 held + data 中查找分隔符：找到时交出分隔符之前的内容，consumed 为到分隔符末尾为止用掉的 data 字节数；
+	// 没找到时交出确定不属于分隔符的内容，末尾可能是分隔符开头的几个字节留到 held 中与下一段数据一起判断
+	template <class Sink>
+	bool scan(const char* data, size_t len, Sink& sink, size_t& consumed, bool& found) {
+		const size_t d = delimiter.size();
+		if (!held.empty()) {
+			// 从 held 中开始的分隔符：只需看 held 与 data 开头不到一个分隔符长度的数据
+			std::string window = held;
+			window.append(data, len < d - 1 ? len : d - 1);
+			size_t pos = window.find(delimiter);
+			if (pos != std::string::npos && pos < held.size()) {
+				if (!emit(sink, held.data(), pos)) return false;
+				consumed = pos + d - held.size();
+				held.clear();
+				found = true;
+				return true;
+			}
+			if (len < d) { // data 太短，不可能包含完整的分隔符，与 held 一起保留可能的开头
+				size_t keep = partialSuffix(window.data(), window.size());
+				if (!emit(sink, window.data(), window.size() - keep)) return false;
+				held = window.substr(window.size() - keep);
+				consumed = len;
+				return true;
+			}
+			if (!emit(sink, held.data(), held.size())) return false;
+			held.clear();
+		}
+		size_t pos = searcher.find(data, len);
+		if (pos != BoundarySearch::npos) {
+			if (!emit(sink, data, pos)) return false;
+			consumed = pos + d;
+			found = true;
+			return true;
+		}
+		size_t keep = partialSuffix(data, len);
+		if (!emit(sink, data, len - keep)) return false;
+		held.assign(data + len - keep, keep);
+		consumed = len;
+		return true;
+	}
+
+	// data 末尾与分隔符开头相同的最长部分的长度（小于分隔符长度）
+	size_t partialSuffix(const char* data, size_t len) const {
+		size_t k = len < delimiter.size() - 1 ? len : delimiter.size() - 1;
+		for (; k > 0; k--) {
+			if (memcmp(data + len - k, delimiter.data(), k) == 0) return k;
+		}
+		return 0;
+	}
+
+	// 解析部分的头部：Content-Disposition 中的 name、filename 与 Content-Type
+	bool parseHeaders(UploadPart& part) const {
+		size_t pos = 0;
+		while (pos < headers.size()) {
+			size_t eol = headers.find("\r\n", pos);
+			std::string_view line(headers.data() + pos, eol - pos);
+			pos = eol + 2;
+			if (line.empty()) break;
+			size_t colon = line.find(':');
+			if (colon == std::string_view::npos) return false;
+			std::string_view name = line.substr(0, colon);
+			std::string_view value = line.substr(colon + 1);
+			while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+			if (name.size() == 19 && strncasecmp(name.data(), "content-disposition", 19) == 0) {
+				part.name = parameter(value, "name");
+				part.filename = baseName(parameter(value, "filename"));
+			} else if (name.size() == 12 && strncasecmp(name.data(), "content-type", 12) == 0) {
+				part.contentType = value;
+			}
+		}
+		return true;
+	}
+
+public:
+	// 去掉文件名中的目录（有的浏览器发送完整路径），不允许 "." 与 ".."
+	static std::string baseName(const std::string& filename) {
+		size_t slash = filename.find_last_of("/\\");
+		std::string name = slash == std::string::npos ? filename : filename.substr(slash + 1);
+		return name == "." || name == ".." ? std::string() : name;
+	}
+};
+
+// 接收一个上传请求：解析出的部分交给路由的回调，文件部分写入临时文件。
+// 出错（格式非法、超出上限、写盘失败）后 errorCode()/errorMessage() 为应回复的状态码与原因
+class UploadReceiver {
+public:
+	UploadReceiver(const UploadRoute& route, const HttpRequest& request) : route(route), request(request) {}
+
+	// 删除处理函数没有移走的临时文件
+	~UploadReceiver() {
+		closeFile();
+		for (const UploadPart& part : parts) {
+			if (!part.path.empty()) unlink(part.path.c_str());
+		}
+	}
+
+	UploadReceiver(const UploadReceiver&) = delete;
+	UploadReceiver& operator=(const UploadReceiver&) = delete;
+
+	// 开始接收：multipart/form-data 按 boundary 解析，其他类型的请求体整体作为一个文件部分
+	// （文件名取自请求的 Content-Disposition）。contentLength 未知（chunked）时为 npos
+	bool start(size_t contentLength) {
+		std::string_view type = request.getHeader("content-type");
+		std::string boundary = MultipartParser::boundaryOf(type);
+		if (!boundary.empty()) {
+			parser.emplace(boundary, route.options.maxPartHeaderBytes);
+			return true;
+		}
+		if (type.size() >= 10 && strncasecmp(type.data(), "multipart/", 10) == 0) return fail(400, "Bad multipart boundary");
+		if (contentLength != npos && contentLength > route.options.maxFileBytes) return fail(413, "Upload too large");
+		UploadPart part;
+		part.contentType = type;
+		part.filename = MultipartParser::baseName(MultipartParser::parameter(request.getHeader("content-disposition"), "filename"));
+		return partBegin(std::move(part));
+	}
+
+	// 接收请求体的一段数据
+	bool feed(const char* data, size_t len) {
+		if (errorCode_) return false;
+		if (!parser) return partData(data, len);
+		if (parser->feed(data, len, *this)) return true;
+		return errorCode_ ? false : fail(400, "Malformed multipart body");
+	}
+
+	// 请求体已经全部到达
+	bool finish() {
+		if (errorCode_) return false;
+		if (!parser) return partEnd();
+		return parser->finished() || fail(400, "Incomplete multipart body");
+	}
+
+	// 全部接收完：交给处理函数生成响应
+	HttpResponse complete() {
+		if (route.handler.onComplete) return route.handler.onComplete(request, parts);
+		return HttpResponse::makeOkResponse("Received " + std::to_string(parts.size()) + " parts");
+	}
+
+	// 非 multipart 的请求体正在写入文件，可以由调用方用 splice 直接搬进文件
+	bool storesRawFile() const {
+		return !parser && fd != -1 && !errorCode_;
+	}
+
+	// 把管道中的 n 字节用 splice 移入当前文件
+	bool spliceFrom(int pipe, size_t n) {
+		UploadPart& part = parts.back();
+		if (part.size + n > route.options.maxFileBytes) return fail(413, "Upload too large");
+		while (n > 0) {
+			ssize_t moved = ::splice(pipe, nullptr, fd, nullptr, n, SPLICE_F_MOVE);
+			if (moved < 0 && errno == EINTR) continue;
+			if (moved <= 0) return storageFailed();
+			n -= moved;
+			part.size += moved;
+		}
+		return true;
+	}
+
+	const std::vector<UploadPart>& getParts() const {
+		return parts;
+	}
+
+	int errorCode() const {
+		return errorCode_;
+	}
+
+	const std::string& errorMessage() const {
+		return errorMessage_;
+	}
+
+	// 以下由 MultipartParser 调用
+	bool partBegin(UploadPart part) {
+		if (parts.size() >= route.options.maxParts) return fail(413, "Too many parts");
+		parts.push_back(std::move(part));
+		UploadPart& current = parts.back();
+		skipping = route.handler.onPartBegin && !route.handler.onPartBegin(request, current);
+		if (skipping || (parser && current.filename.empty())) return true; // 普通字段保存在内存中
+		mkdir(route.options.directory.c_str(), 0700);
+		std::string path = route.options.directory + "/upload-XXXXXX";
+		fd = mkostemp(&path[0], O_CLOEXEC);
+		if (fd == -1) return storageFailed();
+		current.path = path;
+		return true;
+	}
+
+	bool partData(const char* data, size_t len) {
+		if (skipping) return true;
+		UploadPart& part = parts.back();
+		part.size += len;
+		if (fd == -1) {
+			if (part.size > route.options.maxFieldBytes) return fail(413, "Form field too large");
+			part.value.append(data, len);
+			return true;
+		}
+		if (part.size > route.options.maxFileBytes) return fail(413, "Upload too large");
+		while (len > 0) {
+			ssize_t written = ::write(fd, data, len);
+			if (written < 0 && errno == EINTR) continue;
+			if (written <= 0) return storageFailed();
+			data += written;
+			len -= written;
+		}
+		return true;
+	}
+
+	bool partEnd() {
+		closeFile();
+		if (skipping) {
+			parts.pop_back(); // 被丢弃的部分不交给处理函数
+			skipping = false;
+			return true;
+		}
+		if (route.handler.onPart) route.handler.onPart(request, parts.back());
+		return true;
+	}
+
+private:
+	static const size_t npos = size_t(-1);
+
+	const UploadRoute& route;
+	const HttpRequest& request;
+	std::optional<MultipartParser> parser; // 为空时请求体整体是一个文件
+	std::vector<UploadPart> parts;
+	int fd = -1; // 当前文件部分的临时文件
+	bool skipping = false; // 当前部分被 onPartBegin 丢弃
+	int errorCode_ = 0;
+	std::string errorMessage_;
+
+	bool fail(int code, const char* message) {
+		if (!errorCode_) {
+			errorCode_ = code;
+			errorMessage_ = message;
+		}
+		return false;
+	}
+
+	bool storageFailed() {
+		LOG_ERROR("Failed to store upload in %s: %s", route.options.directory.c_str(), strerror(errno));
+		return fail(500, "Failed to store upload");
+	}
+
+	void closeFile() {
+		if (fd != -1) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+};
+
+#endif
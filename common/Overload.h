@@ -0,0 +1,196 @@
+/*************************************************************************
+	> File Name: Overload.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 19 Oct 2026 04:21:10 PM CST
+ ************************************************************************/
+
+// 过载保护：基于排队时延的准入控制（CoDel）、连接数上限、连接内存预算与按客户端IP的令牌桶限流
+#ifndef _OVERLOAD_H
+#define _OVERLOAD_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <ostream>
+
+// 过载保护的配置，数值为0表示关闭对应的功能
+struct OverloadOptions {
+	std::chrono::milliseconds targetDelay{5}; // CoDel目标排队时延
+	std::chrono::milliseconds interval{100}; // CoDel观察窗口
+	int retryAfterSeconds = 1; // 503/429 响应中的 Retry-After
+	int maxConnections = 10000; // 单个事件循环同时持有的最大连接数
+	double ratePerSecond = 0; // 每个客户端IP每秒允许的请求数
+	double burst = 0; // 令牌桶容量，为0时取 ratePerSecond
+	bool trustRealIpHeader = false; // 位于nginx之后时使用 X-Real-IP 作为客户端IP
+	// 只有来自这些对端（ListenAddress::peerName 的格式）的 X-Real-IP 才被采用，直接连接的客户端带的一律忽略，
+	// 否则任何人都能轮换这个头绕过自己的令牌桶。默认只信任经Unix域套接字转发的nginx
+	std::vector<std::string> trustedProxies = {"unix"};
+	size_t memoryBudgetBytes = 0; // 所有连接占用内存的上限，超出时关闭最久没有活动的空闲连接
+};
+
+// 过载相关的计数器，通过 /metrics 导出
+struct OverloadStats {
+	std::atomic<uint64_t> accepted{0}; // 接受的连接数
+	std::atomic<uint64_t> activeConnections{0}; // 当前连接数
+	std::atomic<uint64_t> rejectedConnections{0}; // 因连接数上限被拒绝的连接数
+	std::atomic<uint64_t> shedRequests{0}; // 因排队时延过长被快速拒绝（503）的连接数
+	std::atomic<uint64_t> rateLimited{0}; // 因限流被拒绝（429）的请求数
+	std::atomic<uint64_t> fdExhausted{0}; // accept 遇到 EMFILE/ENFILE 而丢弃的连接数
+	std::atomic<uint64_t> memoryShed{0}; // 因超出内存预算被关闭的空闲连接数
+};
+
+// 一个连接占用的内存（字节），按用途分类
+struct ConnectionMemory {
+	size_t connection = 0; // 连接结构体本身
+	size_t tls = 0; // TLS状态（SSL对象与记录层缓冲区）
+	size_t readBuffer = 0; // 读缓冲区持有的内存块
+	size_t writeQueue = 0; // 尚未发出的响应与WebSocket推送队列
+	size_t parser = 0; // HTTP/2、WebSocket的解析状态
+
+	size_t total() const {
+		return connection + tls + readBuffer + writeQueue + parser;
+	}
+};
+
+// 所有连接的内存合计。每个连接记住上次计入的数值，处理完一批事件后只把变化量加到合计上
+class MemoryAccounting {
+public:
+	void update(ConnectionMemory& accounted, const ConnectionMemory& now) {
+		add(connection, accounted.connection, now.connection);
+		add(tls, accounted.tls, now.tls);
+		add(readBuffer, accounted.readBuffer, now.readBuffer);
+		add(writeQueue, accounted.writeQueue, now.writeQueue);
+		add(parser, accounted.parser, now.parser);
+		accounted = now;
+	}
+
+	// 连接关闭时从合计中扣除
+	void remove(ConnectionMemory& accounted) {
+		update(accounted, ConnectionMemory());
+	}
+
+	size_t total() const {
+		return connection + tls + readBuffer + writeQueue + parser;
+	}
+
+	void writeMetrics(std::ostream& out) const {
+		out << "memory_connection_bytes " << connection << "\n"
+			<< "memory_tls_bytes " << tls << "\n"
+			<< "memory_read_buffer_bytes " << readBuffer << "\n"
+			<< "memory_write_queue_bytes " << writeQueue << "\n"
+			<< "memory_parser_bytes " << parser << "\n"
+			<< "memory_total_bytes " << total() << "\n";
+	}
+
+private:
+	std::atomic<size_t> connection{0}, tls{0}, readBuffer{0}, writeQueue{0}, parser{0};
+
+	static void add(std::atomic<size_t>& sum, size_t before, size_t after) {
+		if (after != before) sum.fetch_add(after - before, std::memory_order_relaxed); // 无符号回绕即为减法
+	}
+};
+
+// CoDel风格的准入控制：一个观察窗口内的最小排队时延持续超过目标值时进入过载状态，
+// 过载期间排队超过两倍目标时延的任务直接被拒绝，避免队列无限增长
+class CoDelAdmission {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit CoDelAdmission(const OverloadOptions& options)
+		: target(options.targetDelay), interval(options.interval),
+		  intervalEnd(Clock::now() + options.interval), minDelay(Clock::duration::max()), overloaded(false) {}
+
+	// 任务出队时调用，sojourn 为任务在线程池队列中等待的时间；返回true表示应当拒绝该任务
+	bool shouldShed(Clock::duration sojourn) {
+		std::lock_guard<std::mutex> lock(mutex);
+		Clock::time_point now = Clock::now();
+		if (sojourn < minDelay) minDelay = sojourn;
+		if (now >= intervalEnd) {
+			overloaded = minDelay > target; // 整个窗口内都没有低于目标的时延，说明队列是持续积压而非突发
+			minDelay = Clock::duration::max();
+			intervalEnd = now + interval;
+		}
+		return overloaded && sojourn > 2 * target;
+	}
+
+	bool isOverloaded() const { return overloaded; }
+
+private:
+	std::mutex mutex;
+	Clock::duration target, interval;
+	Clock::time_point intervalEnd;
+	Clock::duration minDelay;
+	std::atomic<bool> overloaded;
+};
+
+// 按客户端IP的令牌桶限流，按IP哈希分片以减少锁竞争。
+// 每个分片的桶按最近使用排成链表并有硬上限，超过上限时从表尾淘汰最久未用的桶，查找与淘汰都是O(1)。
+// 被淘汰的IP再次出现时按新桶对待（令牌是满的）：只有在大量不同IP同时活跃时才会发生，此时宁可放宽也不让内存无限增长
+class RateLimiter {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit RateLimiter(const OverloadOptions& options)
+		: rate(options.ratePerSecond), capacity(options.burst > 0 ? options.burst : options.ratePerSecond) {}
+
+	bool enabled() const { return rate > 0; }
+
+	// 尝试为该IP消耗一个令牌，令牌不足时返回false
+	bool allow(const std::string& ip) {
+		if (!enabled()) return true;
+		Shard& shard = shards[std::hash<std::string>()(ip) % kShards];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		Clock::time_point now = Clock::now();
+
+		auto it = shard.index.find(ip);
+		if (it != shard.index.end()) {
+			shard.lru.splice(shard.lru.begin(), shard.lru, it->second); // 移到表头
+		} else {
+			if (shard.lru.size() >= kMaxBucketsPerShard) {
+				shard.index.erase(shard.lru.back().ip);
+				shard.lru.pop_back();
+			}
+			shard.lru.push_front(Bucket{ip, capacity, now});
+			shard.index.emplace(ip, shard.lru.begin());
+		}
+		Bucket& bucket = shard.lru.front();
+		refill(bucket, now);
+		if (bucket.tokens < 1) return false;
+		bucket.tokens -= 1;
+		return true;
+	}
+
+private:
+	static const size_t kShards = 16;
+	static const size_t kMaxBucketsPerShard = 4096;
+
+	struct Bucket {
+		std::string ip;
+		double tokens;
+		Clock::time_point last;
+	};
+
+	struct Shard {
+		std::mutex mutex;
+		std::list<Bucket> lru; // 表头为最近使用
+		std::unordered_map<std::string, std::list<Bucket>::iterator> index;
+	};
+
+	double rate, capacity;
+	Shard shards[kShards];
+
+	void refill(Bucket& bucket, Clock::time_point now) {
+		double elapsed = std::chrono::duration<double>(now - bucket.last).count();
+		bucket.tokens = std::min(capacity, bucket.tokens + elapsed * rate);
+		bucket.last = now;
+	}
+};
+
+#endif
@@ -0,0 +1,42 @@
+/*************************************************************************
+	> File Name: Probes.h
+	> Author:
+	> Mail:
+	> Created Time: Wed 28 Oct 2026 03:12:40 PM CST
+ ************************************************************************/
+
+// USDT（SystemTap SDT）静态探针：每个探针在可执行文件中只是一条 nop 指令，位置与参数记录在 .note.stapsdt 节中，
+// 没有挂接时不产生开销（参数都是已经在手边的整数与指针，不为探针做额外计算）。用 bpftrace/perf 挂接后
+// 可以在生产环境中统计各阶段的时延分布，不需要重启或重新编译，也不经过文件日志。提供者为 httpserver：
+//   accept(fd)                                 acceptConnection 接受了一个连接
+//   handshake_start(fd) / handshake_done(fd, ok)   传输层握手开始与结束（TLS）
+//   read(fd, bytes)                            serviceConnection 读到请求数据
+//   parse_start(data, len) / parse_done(ok, path, pathLen)   HttpRequest::parse
+//   route_start(path, pathLen) / route_done(status)          Router::routeRequest
+//   query_start(sql) / query_done(sql, ok)     Database 执行一条SQL（已拿到 dbMutex），ok 为0表示失败或没有查到结果
+//   write(fd, bytes)                           响应数据写入套接字
+// 例如统计路由处理时间的分布：
+//   bpftrace -e 'usdt:./srv:httpserver:route_start { @s[tid] = nsecs; }
+//                usdt:./srv:httpserver:route_done /@s[tid]/ { @us = hist((nsecs - @s[tid]) / 1000); delete(@s[tid]); }'
+// 探针需要 <sys/sdt.h>（systemtap-sdt-dev），没有该头文件或定义了 HTTPSERVER_NO_PROBES 时探针编译为空
+#ifndef _PROBES_H
+#define _PROBES_H
+
+#if !defined(HTTPSERVER_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define HTTPSERVER_PROBES 1
+#endif
+#endif
+
+#ifdef HTTPSERVER_PROBES
+#define PROBE1(name, a) STAP_PROBE1(httpserver, name, a)
+#define PROBE2(name, a, b) STAP_PROBE2(httpserver, name, a, b)
+#define PROBE3(name, a, b, c) STAP_PROBE3(httpserver, name, a, b, c)
+#else
+#define PROBE1(name, a) do {} while (0)
+#define PROBE2(name, a, b) do {} while (0)
+#define PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,305 @@
+/*************************************************************************
+	> File Name: Profiler.h
+	> Author:
+	> Mail:
+	> Created Time: Thu 29 Oct 2026 11:20:08 AM CST
+ ************************************************************************/
+
+// 热路径分段剖析：PROFILE_SCOPE(stage) 用 rdtsc/rdtscp 计量作用域经过的周期数，每个线程各自汇总为
+// 次数、min/mean/max 与分位数（对数分桶，误差约12%），启动时把周期数校准为纳秒。用于对热路径上的改动做快速的 A/B 对比：
+//   g++ -std=c++20 -O2 -DHTTPSERVER_PROFILE ...    编译时打开（调试构建 -D_D 默认打开），否则 PROFILE_SCOPE 为空
+//   kill -USR2 <pid>                               清零，然后压测
+//   kill -USR1 <pid>                               把各线程的表与合计写到标准错误
+// 多进程时把信号发给工作进程（主进程的 SIGUSR2 是升级可执行文件）。信号处理函数只设置标志，
+// 由事件循环每秒一次的维护任务（Profiler::poll）输出或清零。
+// 分段：parse（HttpRequest::parse）、route（Router::routeRequest，包含 handler）、handler（处理函数；
+// 协程处理函数每次运行到挂起或完成计一次）、serialize（HTTP/1.1响应写入发送缓冲区，包括压缩）、read/write（套接字读写调用）
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#if defined(HTTPSERVER_PROFILE) || defined(_D)
+#define HTTPSERVER_PROFILING 1
+#endif
+
+#ifdef HTTPSERVER_PROFILING
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class Profiler {
+public:
+	enum Stage { PARSE, ROUTE, HANDLER, SERIALIZE, READ, WRITE, STAGE_COUNT };
+
+	// 开始计时。非x86平台上用 CLOCK_MONOTONIC 的纳秒数代替周期数
+	static uint64_t startCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return monotonicNanos();
+#endif
+	}
+
+	// 结束计时：rdtscp 等前面的指令都执行完才读取计数器
+	static uint64_t endCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+		unsigned int aux;
+		return __rdtscp(&aux);
+#else
+		return monotonicNanos();
+#endif
+	}
+
+	// 用一段稳定时钟的时间校准每纳秒的周期数（约20ms），在开始处理请求之前调用一次
+	static void calibrate() {
+		if (state().cyclesPerNs.load() > 0) return;
+#if defined(__x86_64__) || defined(__i386__)
+		uint64_t nanos0 = monotonicNanos(), cycles0 = startCycles();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		uint64_t nanos1 = monotonicNanos(), cycles1 = endCycles();
+		state().cyclesPerNs = double(cycles1 - cycles0) / double(nanos1 - nanos0);
+#else
+		state().cyclesPerNs = 1.0;
+#endif
+	}
+
+	static void record(Stage stage, uint64_t cycles) {
+		Table& table = localTable();
+		uint64_t epoch = state().epoch.load(std::memory_order_relaxed);
+		if (table.epoch.load(std::memory_order_relaxed) != epoch) table.clear(epoch); // 清零之后第一次记录
+		Row& row = table.rows[stage];
+		add(row.count, 1);
+		add(row.sum, cycles);
+		if (cycles < row.min.load(std::memory_order_relaxed)) row.min.store(cycles, std::memory_order_relaxed);
+		if (cycles > row.max.load(std::memory_order_relaxed)) row.max.store(cycles, std::memory_order_relaxed);
+		add(row.buckets[bucketOf(cycles)], 1);
+	}
+
+	// SIGUSR1 输出、SIGUSR2 清零（进程内多个服务器重复调用没有影响）
+	static void installSignals() {
+		struct sigaction action = {};
+		action.sa_handler = signalHandler;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = SA_RESTART;
+		sigaction(SIGUSR1, &action, nullptr);
+		sigaction(SIGUSR2, &action, nullptr);
+	}
+
+	// 执行信号请求的输出与清零，由事件循环定期调用
+	static void poll() {
+		if (state().dumpRequested.exchange(false)) dump(stderr);
+		if (state().resetRequested.exchange(false)) reset();
+	}
+
+	// 各线程的表（各线程的线程ID）与所有线程的合计，单位为纳秒
+	static void dump(FILE* out) {
+		std::vector<std::shared_ptr<Table> > tables;
+		{
+			std::lock_guard<std::mutex> lock(state().mutex);
+			tables = state().tables;
+		}
+		uint64_t epoch = state().epoch.load();
+		double perNs = state().cyclesPerNs.load() > 0 ? state().cyclesPerNs.load() : 1.0;
+		Snapshot total[STAGE_COUNT];
+		fprintf(out, "profile pid %d, %.3f cycles/ns\n", int(getpid()), perNs);
+		for (const std::shared_ptr<Table>& table : tables) {
+			if (table->epoch.load() != epoch) continue; // 清零之后没有记录
+			Snapshot rows[STAGE_COUNT];
+			bool any = false;
+			for (int i = 0; i < STAGE_COUNT; i++) {
+				rows[i].load(table->rows[i]);
+				total[i].merge(rows[i]);
+				any = any || rows[i].count > 0;
+			}
+			if (!any) continue;
+			fprintf(out, "thread %d\n", table->tid);
+			printTable(out, rows, perNs);
+		}
+		fprintf(out, "all threads\n");
+		printTable(out, total, perNs);
+		fflush(out);
+	}
+
+	// 清零：各线程在下一次记录时清空自己的表，输出时跳过尚未清空的表
+	static void reset() {
+		state().epoch++;
+	}
+
+private:
+	static const int kBuckets = 16 + 60 * 8; // 小于16逐个计数，之后每个2的幂分8个桶
+
+	struct Row {
+		std::atomic<uint64_t> count{0}, sum{0}, min{UINT64_MAX}, max{0};
+		std::atomic<uint64_t> buckets[kBuckets] = {};
+	};
+
+	// 一个线程的表：只有所属线程写入，输出时其他线程读取（计数为 relaxed 原子量，读到的可能差一两次记录）
+	struct Table {
+		Row rows[STAGE_COUNT];
+		std::atomic<uint64_t> epoch{0};
+		int tid = static_cast<int>(syscall(SYS_gettid));
+
+		void clear(uint64_t newEpoch) {
+			for (Row& row : rows) {
+				row.count.store(0, std::memory_order_relaxed);
+				row.sum.store(0, std::memory_order_relaxed);
+				row.min.store(UINT64_MAX, std::memory_order_relaxed);
+				row.max.store(0, std::memory_order_relaxed);
+				for (auto& bucket : row.buckets) bucket.store(0, std::memory_order_relaxed);
+			}
+			epoch.store(newEpoch, std::memory_order_relaxed);
+		}
+	};
+
+	// 输出时复制出来的一行，合计由各线程的行合并而成
+	struct Snapshot {
+		uint64_t count = 0, sum = 0, min = UINT64_MAX, max = 0;
+		uint64_t buckets[kBuckets] = {};
+
+		void load(const Row& row) {
+			count = row.count.load(std::memory_order_relaxed);
+			sum = row.sum.load(std::memory_order_relaxed);
+			min = row.min.load(std::memory_order_relaxed);
+			max = row.max.load(std::memory_order_relaxed);
+			for (int i = 0; i < kBuckets; i++) buckets[i] = row.buckets[i].load(std::memory_order_relaxed);
+		}
+
+		void merge(const Snapshot& other) {
+			count += other.count;
+			sum += other.sum;
+			if (other.min < min) min = other.min;
+			if (other.max > max) max = other.max;
+			for (int i = 0; i < kBuckets; i++) buckets[i] += other.buckets[i];
+		}
+
+		// 第 q 分位数所在桶的中点（周期数）
+		uint64_t percentile(double q) const {
+			uint64_t rank = uint64_t(std::ceil(q * double(count))), seen = 0; // 最近秩
+			if (rank == 0) rank = 1;
+			for (int i = 0; i < kBuckets; i++) {
+				seen += buckets[i];
+				if (seen >= rank) {
+					uint64_t low = bucketLow(i), high = bucketLow(i + 1);
+					uint64_t mid = low + (high - low) / 2;
+					return mid < min ? min : (mid > max ? max : mid);
+				}
+			}
+			return max;
+		}
+	};
+
+	struct State {
+		std::mutex mutex; // 保护 tables（每个线程只在第一次记录时注册一次）
+		std::vector<std::shared_ptr<Table> > tables;
+		std::atomic<uint64_t> epoch{0};
+		std::atomic<double> cyclesPerNs{0};
+		std::atomic<bool> dumpRequested{false}, resetRequested{false};
+	};
+
+	static State& state() {
+		static State instance;
+		return instance;
+	}
+
+	static Table& localTable() {
+		thread_local std::shared_ptr<Table> table;
+		if (!table) {
+			table = std::make_shared<Table>();
+			table->epoch.store(state().epoch.load());
+			std::lock_guard<std::mutex> lock(state().mutex);
+			state().tables.push_back(table);
+		}
+		return *table;
+	}
+
+	static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); // 单写者，不需要原子加
+	}
+
+	static int bucketOf(uint64_t v) {
+		if (v < 16) return int(v);
+		int msb = 63 - __builtin_clzll(v);
+		return 16 + (msb - 4) * 8 + int((v >> (msb - 3)) & 7);
+	}
+
+	// 桶的下界（最后一个桶之后的下界为 UINT64_MAX）
+	static uint64_t bucketLow(int i) {
+		if (i < 16) return uint64_t(i);
+		if (i >= kBuckets) return UINT64_MAX;
+		int msb = (i - 16) / 8 + 4;
+		return (uint64_t(8 + (i - 16) % 8)) << (msb - 3);
+	}
+
+	static uint64_t monotonicNanos() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	static void signalHandler(int sig) {
+		if (sig == SIGUSR1) state().dumpRequested = true;
+		else state().resetRequested = true;
+	}
+
+	static void printTable(FILE* out, const Snapshot* rows, double perNs) {
+		static const char* names[STAGE_COUNT] = {"parse", "route", "handler", "serialize", "read", "write"};
+		fprintf(out, "  %-10s %10s %10s %10s %10s %10s %10s %10s %10s\n", "stage", "count", "min_ns", "mean_ns", "p50_ns", "p90_ns", "p99_ns", "p999_ns", "max_ns");
+		for (int i = 0; i < STAGE_COUNT; i++) {
+			const Snapshot& row = rows[i];
+			if (row.count == 0) continue;
+			fprintf(out, "  %-10s %10llu %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f %10.0f\n", names[i], (unsigned long long)row.count,
+				row.min / perNs, double(row.sum) / row.count / perNs, row.percentile(0.5) / perNs, row.percentile(0.9) / perNs,
+				row.percentile(0.99) / perNs, row.percentile(0.999) / perNs, row.max / perNs);
+		}
+	}
+};
+
+// 作用域计时器
+class ProfileScope {
+public:
+	explicit ProfileScope(Profiler::Stage stage) : stage(stage), start(Profiler::startCycles()) {}
+
+	~ProfileScope() {
+		Profiler::record(stage, Profiler::endCycles() - start);
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	Profiler::Stage stage;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(Profiler::stage)
+
+#else
+
+// 未打开剖析：计时器为空，其余调用什么都不做
+class Profiler {
+public:
+	static void calibrate() {}
+	static void installSignals() {}
+	static void poll() {}
+};
+
+#define PROFILE_SCOPE(stage) do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+/*************************************************************************
+	> File Name: ResponseCache.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 19 Oct 2026 02:05:47 PM CST
+ ************************************************************************/
+
+#ifndef _RESPONSECACHE_H
+#define _RESPONSECACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+// 单条路由的缓存策略，只应用于幂等的GET路由
+struct CachePolicy {
+	std::chrono::milliseconds ttl{0}; // 新鲜期，为0表示不缓存
+	std::chrono::milliseconds staleWhileRevalidate{0}; // 过期后仍可返回旧响应的时长，期间由一个请求负责刷新
+	std::vector<std::string> vary; // 参与缓存键的请求头（例如 accept-encoding）
+
+	bool enabled() const { return ttl.count() > 0; }
+};
+
+// 进程内响应缓存：按内存上限做LRU淘汰，同一个键的并发未命中只执行一次处理函数（singleflight）
+class ResponseCache {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// 缓存命中情况的计数器
+	struct Stats {
+		std::atomic<uint64_t> hits{0}, misses{0}, stale{0}, coalesced{0}, evictions{0};
+	};
+
+	using Key = std::pmr::string;
+
+	explicit ResponseCache(size_t maxBytes = 8 * 1024 * 1024) : maxBytes(maxBytes), usedBytes(0) {}
+
+	// 根据方法、路径以及 Vary 指定的请求头生成缓存键，键从当前请求的内存池分配，存入缓存时才复制到堆上
+	static Key makeKey(const HttpRequest& request, const CachePolicy& policy) {
+		Key key(Arena::resource());
+		key += request.getMethodString();
+		key += '|';
+		key += request.getPath();
+		if (!request.getQuery().empty()) {
+			key += '?';
+			key += request.getQuery();
+		}
+		for (const auto& name : policy.vary) {
+			key += '\n';
+			key += name;
+			key += '=';
+			key += request.getHeader(name);
+		}
+		return key;
+	}
+
+	// 查找缓存，未命中时调用 compute 生成响应；只有200响应会被缓存，带 Cache-Control: no-store 的除外
+	template <class F>
+	HttpResponse getOrCompute(const Key& key, const CachePolicy& policy, F&& compute) {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			auto it = entries.find(key);
+			Clock::time_point now = Clock::now();
+			if (it != entries.end()) {
+				Entry& entry = it->second;
+				if (now < entry.freshUntil) {
+					// 新鲜命中，移动到LRU链表头部
+					lru.splice(lru.begin(), lru, entry.lruPos);
+					stats.hits++;
+					return withCacheStatus(entry.response, "HIT");
+				}
+				if (now < entry.staleUntil && (entry.revalidating || flights.count(key))) {
+					// 已有请求在刷新，其余请求直接返回旧响应
+					stats.stale++;
+					return withCacheStatus(entry.response, "STALE");
+				}
+				if (now < entry.staleUntil) {
+					entry.revalidating = true; // 由当前请求负责刷新，刷新期间其余请求拿到旧响应
+				}
+			}
+
+			auto flight = flights.find(key);
+			if (flight != flights.end()) {
+				// 同一个键已有请求在执行处理函数，等待其结果
+				std::shared_ptr<Flight> waiting = flight->second;
+				stats.coalesced++;
+				done.wait(lock, [&waiting] { return waiting->finished; });
+				if (waiting->ok) return withCacheStatus(waiting->response, "HIT");
+				continue; // 执行者失败（抛出异常），重新尝试
+			}
+
+			std::shared_ptr<Flight> mine = std::make_shared<Flight>();
+			flights[key] = mine;
+			stats.misses++;
+			lock.unlock();
+
+			HttpResponse response;
+			try {
+				response = compute();
+			} catch (...) {
+				lock.lock();
+				finishFlight(key, mine, false);
+				throw;
+			}
+
+			lock.lock();
+			if (response.isStreaming()) {
+				// 流式响应体只能发送一次，不缓存，等待中的请求各自重新执行处理函数
+				auto stale = entries.find(key);
+				if (stale != entries.end()) stale->second.revalidating = false;
+				finishFlight(key, mine, false);
+				return response;
+			}
+			if (response.getStatusCode() == 200 && response.getHeader("Cache-Control").find("no-store") == std::string_view::npos) {
+				store(key, policy, response);
+			} else {
+				auto stale = entries.find(key);
+				if (stale != entries.end()) stale->second.revalidating = false;
+			}
+			mine->response = response;
+			finishFlight(key, mine, true);
+			return withCacheStatus(response, "MISS");
+		}
+	}
+
+	// 清空所有缓存条目
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		lru.clear();
+		usedBytes = 0;
+	}
+
+	const Stats& getStats() const { return stats; }
+
+private:
+	// 缓存中的响应活得比请求久，必须分配在堆上
+	struct Entry {
+		HttpResponse response{200, std::pmr::new_delete_resource()};
+		size_t bytes;
+		Clock::time_point freshUntil, staleUntil;
+		bool revalidating = false;
+		std::list<Key>::iterator lruPos;
+	};
+
+	// 一次正在进行的处理函数调用，等待者共享其结果
+	struct Flight {
+		bool finished = false;
+		bool ok = false;
+		HttpResponse response{200, std::pmr::new_delete_resource()}; // 由其他线程的请求读取
+	};
+
+	size_t maxBytes, usedBytes;
+	std::mutex mutex;
+	std::condition_variable done;
+	std::unordered_map<Key, Entry> entries; // 插入时键被复制，复制品使用堆
+	std::list<Key> lru; // 头部为最近使用
+	std::unordered_map<Key, std::shared_ptr<Flight> > flights;
+	Stats stats;
+
+	// 复制一份到当前请求的内存池中返回
+	static HttpResponse withCacheStatus(const HttpResponse& cached, const char* status) {
+		HttpResponse response(cached, Arena::resource());
+		response.setHeader("X-Cache", status);
+		return response;
+	}
+
+	void finishFlight(const Key& key, const std::shared_ptr<Flight>& flight, bool ok) {
+		flight->finished = true;
+		flight->ok = ok;
+		flights.erase(key);
+		done.notify_all();
+	}
+
+	// 插入或替换缓存条目，超出内存上限时从LRU尾部淘汰（调用时已持有锁）
+	void store(const Key& key, const CachePolicy& policy, const HttpResponse& response) {
+		size_t bytes = key.size() + response.byteSize();
+		if (bytes > maxBytes) return; // 单个响应超过上限，不缓存
+
+		auto old = entries.find(key);
+		if (old != entries.end()) {
+			usedBytes -= old->second.bytes;
+			lru.erase(old->second.lruPos);
+			entries.erase(old);
+		}
+		while (usedBytes + bytes > maxBytes && !lru.empty()) {
+			auto victim = entries.find(lru.back());
+			usedBytes -= victim->second.bytes;
+			entries.erase(victim);
+			lru.pop_back();
+			stats.evictions++;
+		}
+
+		Clock::time_point now = Clock::now();
+		lru.push_front(key);
+		Entry& entry = entries[key];
+		entry.response = response;
+		entry.bytes = bytes;
+		entry.freshUntil = now + policy.ttl;
+		entry.staleUntil = entry.freshUntil + policy.staleWhileRevalidate;
+		entry.lruPos = lru.begin();
+		usedBytes += bytes;
+	}
+};
+
+#endif
@@ -0,0 +1,407 @@
+/*************************************************************************
+	> File Name: Router.h
+	> Author: 
+	> Mail: 
+	> Created Time: Sat 24 May 2025 04:32:49 PM CST
+ ************************************************************************/
+
+#ifndef _ROUTER_H
+#define _ROUTER_H
+#include <functional>
+#include <unordered_map>
+#include <string_view>
+#include <memory_resource>
+#include <memory>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Database.h"
+#include "DbExecutor.h"
+#include "ResponseCache.h"
+#include "WebSocket.h"
+#include "SessionStore.h"
+#include "AuthToken.h"
+#include "Coroutine.h"
+#include "Middleware.h"
+#include "StaticAssets.h"
+#include "Multipart.h"
+#include "Probes.h"
+#include "Profiler.h"
+
+// Router 类负责将特定的HTTP请求映射到相应的处理函数
+class Router {
+public:
+	// 定义处理函数的类型
+	using HandlerFunc = std::function<HttpResponse(const HttpRequest&)>;
+	// 协程处理函数：其中可以 co_await blocking()/sleepFor()，挂起期间不占用工作线程（见 Coroutine.h）
+	using AsyncHandlerFunc = std::function<Task<HttpResponse>(const HttpRequest&)>;
+
+	// 添加路由：将 HTTP 方法和路径映射到处理函数
+	// cache 为该路由的响应缓存策略，只对GET路由生效（POST等非幂等请求永远不缓存）
+	void addRoute(const std::string& method, const std::string& path, HandlerFunc handler,
+		const CachePolicy& cache = CachePolicy()) {
+		Route& route = routes[routeKey(method, path)];
+		route.handler = handler;
+		route.cache = cache;
+		if (cache.enabled() && method != "GET") {
+			LOG_WARNING("Ignoring cache policy for non-idempotent route %s %s", method.c_str(), path.c_str());
+			route.cache = CachePolicy();
+		}
+	}
+
+	// 添加协程路由。HTTP/1.1连接上处理函数挂起时连接暂停读取，恢复并写出响应后再处理后续请求；
+	// HTTP/2与0-RTT早期数据中的请求在当前工作线程中等待协程完成。协程路由不使用响应缓存
+	void addAsyncRoute(const std::string& method, const std::string& path, AsyncHandlerFunc handler) {
+		Route& route = routes[routeKey(method, path)];
+		route.handler = nullptr;
+		route.asyncHandler = handler;
+		route.cache = CachePolicy();
+	}
+
+	// 请求对应的协程路由（需要登录的路由已通过校验），不是协程路由或未通过登录校验时返回空指针，
+	// 由 routeRequest 同步处理（未登录时返回401）
+	const AsyncHandlerFunc* findAsyncRoute(HttpRequest& request) {
+		auto it = routes.find(routeKey(request.getMethodString(), request.getPath()));
+		if (it == routes.end() || !it->second.asyncHandler) return nullptr;
+		if (it->second.authenticated && !authenticate(request)) return nullptr;
+		if (it->second.trustedOnly && !request.isTrusted()) return nullptr;
+		return &it->second.asyncHandler;
+	}
+
+	// 添加流式上传路由（POST）：HTTP/1.1连接上请求体边到达边解析，文件部分直接写入 options.directory，
+	// 每个部分接收完调用 handler.onPart，全部接收完由 handler.onComplete 生成响应（见 Multipart.h）。
+	// HTTP/2与0-RTT中的请求体已经完整缓存在内存中，同样按部分交给回调
+	void addUploadRoute(const std::string& path, const UploadHandler& handler, const UploadOptions& options = UploadOptions()) {
+		Route& route = routes[routeKey("POST", path)];
+		route.handler = nullptr;
+		route.asyncHandler = nullptr;
+		route.cache = CachePolicy();
+		route.upload = std::make_shared<UploadRoute>(UploadRoute{handler, options});
+	}
+
+	// 请求对应的上传路由，不是上传路由时返回空指针；需要登录而未通过校验时 allowed 为false
+	const UploadRoute* findUploadRoute(HttpRequest& request, bool& allowed) {
+		auto it = routes.find(routeKey(request.getMethodString(), request.getPath()));
+		if (it == routes.end() || !it->second.upload) return nullptr;
+		if (it->second.trustedOnly && !request.isTrusted()) return nullptr;
+		allowed = !it->second.authenticated || authenticate(request);
+		return it->second.upload.get();
+	}
+
+	// 添加WebSocket路由：对该路径的升级请求完成握手后，连接上的消息交给 handler
+	void addWebSocketRoute(const std::string& path, const WebSocketHandler& handler) {
+		webSocketRoutes[path] = handler;
+	}
+
+	// 查找WebSocket路由，不存在时返回空指针
+	const WebSocketHandler* findWebSocketRoute(const std::string& path) const {
+		auto it = webSocketRoutes.find(path);
+		return it == webSocketRoutes.end() ? nullptr : &it->second;
+	}
+
+	// 将路由标记为幂等：重复执行没有副作用，允许直接处理TLS 1.3 0-RTT早期数据中的请求
+	// （早期数据可能被攻击者重放，只有GET路由可以标记）
+	void markIdempotent(const std::string& method, const std::string& path) {
+		auto it = routes.find(routeKey(method, path));
+		if (it == routes.end() || method != "GET") {
+			LOG_WARNING("Cannot mark %s %s as idempotent", method.c_str(), path.c_str());
+			return ;
+		}
+		it->second.idempotent = true;
+	}
+
+	// 将路由标记为需要登录：未携带有效令牌或会话的请求直接返回401，不会进入处理函数
+	void markAuthenticated(const std::string& method, const std::string& path) {
+		auto it = routes.find(routeKey(method, path));
+		if (it == routes.end()) {
+			LOG_WARNING("Cannot mark unknown route %s %s as authenticated", method.c_str(), path.c_str());
+			return ;
+		}
+		if (it->second.cache.enabled()) {
+			LOG_WARNING("Disabling cache for authenticated route %s %s", method.c_str(), path.c_str());
+			it->second.cache = CachePolicy(); // 响应因用户而异，不能共用缓存
+		}
+		it->second.authenticated = true;
+	}
+
+	// 将路由标记为只对可信对端开放（调试与诊断接口）：其他请求得到404，与路由不存在时相同
+	void markTrustedOnly(const std::string& method, const std::string& path) {
+		auto it = routes.find(routeKey(method, path));
+		if (it == routes.end()) {
+			LOG_WARNING("Cannot mark unknown route %s %s as trusted-only", method.c_str(), path.c_str());
+			return ;
+		}
+		it->second.trustedOnly = true;
+	}
+
+	// 设置路由响应的压缩级别（zlib的1~9，0表示不压缩）：大而变化少的响应用高级别，频繁的小响应用低级别
+	void setCompressionLevel(const std::string& method, const std::string& path, int level) {
+		auto it = routes.find(routeKey(method, path));
+		if (it == routes.end()) {
+			LOG_WARNING("Cannot set compression level of unknown route %s %s", method.c_str(), path.c_str());
+			return ;
+		}
+		it->second.compressionLevel = level;
+	}
+
+	// 请求对应路由的压缩级别，-1表示使用默认级别
+	int compressionLevel(const HttpRequest& request) const {
+		auto it = routes.find(routeKey(request.getMethodString(), request.getPath()));
+		return it == routes.end() ? -1 : it->second.compressionLevel;
+	}
+
+	// 请求对应的路由是否被标记为幂等
+	bool isIdempotent(const HttpRequest& request) const {
+		auto it = routes.find(routeKey(request.getMethodString(), request.getPath()));
+		return it != routes.end() && it->second.idempotent;
+	}
+
+	// 根据 HTTP 请求路由到相应的处理函数
+	HttpResponse routeRequest(HttpRequest& request) {
+		PROFILE_SCOPE(ROUTE);
+		PROBE2(route_start, request.getPath().data(), request.getPath().size());
+		HttpResponse response = dispatch(request);
+		PROBE1(route_done, response.getStatusCode());
+		return response;
+	}
+
+	const ResponseCache::Stats& getCacheStats() const {
+		return cache.getStats();
+	}
+
+	SessionStore& getSessions() {
+		return sessions;
+	}
+
+	TokenSigner& getTokenSigner() {
+		return tokens;
+	}
+
+	StaticAssets& getAssets() {
+		return assets;
+	}
+
+	// 识别已登录的用户，成功时写入 request.setUser()：先校验无状态令牌（只需密钥），
+	// 没有令牌时再查会话表；两者都不访问数据库
+	bool authenticate(HttpRequest& request) {
+		std::string user;
+		std::string token = tokens.extract(request);
+		if (!token.empty()) {
+			if (!tokens.verify(token, user)) return false;
+		} else {
+			std::string id(request.getCookie(sessions.getOptions().cookieName));
+			if (id.empty() || !sessions.lookup(id, user)) return false;
+		}
+		request.setUser(user);
+		return true;
+	}
+
+	// 设置数据库相关的路由，例如注册和登录
+	void setupDatabaseRoutes(DbExecutor& db) {
+		tokens.ensureKey(); // 没有配置共享密钥时，令牌只在本进程内有效
+		// 静态页面嵌入在可执行文件中（见 StaticAssets.h）。页面缓存60秒，过期后60秒内先返回旧页面再由一个请求刷新；
+		// 按 Accept-Encoding 区分gzip与未压缩的版本，带 If-None-Match 的请求单独成键（304不缓存）。
+		// UI_DIR 开发模式下的页面带 no-store，不会进入缓存
+		CachePolicy pageCache;
+		pageCache.ttl = std::chrono::seconds(60);
+		pageCache.staleWhileRevalidate = std::chrono::seconds(60);
+		pageCache.vary = {"accept-encoding", "if-none-match"};
+
+		addRoute("GET", "/login", [this](const HttpRequest& req) {
+			HttpResponse response;
+			if (!assets.serve("login.html", req, response)) return HttpResponse::makeErrorResponse(404, "NotFound");
+			return response;
+		}, pageCache);
+
+		addRoute("GET", "/register", [this](const HttpRequest& req) {
+			HttpResponse response;
+			if (!assets.serve("register.html", req, response)) return HttpResponse::makeErrorResponse(404, "NotFound");
+			return response;
+		}, pageCache);
+
+		// 静态页面可以从0-RTT早期数据直接返回，登录与注册的POST必须等握手完成
+		markIdempotent("GET", "/login");
+		markIdempotent("GET", "/register");
+
+		// 登录页面通过WebSocket订阅登录/注册事件，由服务端主动推送
+		WebSocketHandler events;
+		events.onOpen = [this](const WebSocketPtr& channel, const HttpRequest&) {
+			accountEvents.join(channel);
+		};
+		events.onClose = [this](const WebSocketPtr& channel) {
+			accountEvents.leave(channel);
+		};
+		addWebSocketRoute("/events", events);
+
+		// 注册与登录使用的中间件：记录访问日志，并在响应中带上处理耗时
+		Pipeline<AccessLog, Timing> accounts;
+
+		// 注册路由
+		addAsyncRoute("POST", "/register", accounts.wrap([this, &db](const HttpRequest& req) -> Task<HttpResponse> {
+			// 解析表单数据：字段直接指向请求体，只有含转义的字段解码到请求的内存池中
+			std::string_view username, password;
+			req.formParams().extract({{"username", &username}, {"password", &password}});
+
+			//调用数据库方法进行注册：在数据库执行器线程中执行，等待期间工作线程去处理其他连接
+			bool registered = co_await db.write([&](Database& database) { return database.registerUser(username, password); });
+			if (registered) {
+				accountEvents.broadcast("{\"event\":\"register\"}");
+				//return HttpResponse::makeOkResponse("Register Success!");
+
+                // HttpResponse response;
+                // response.setStatusCode(302); // 设置状态码为302，表示重定向
+                // response.setHeader("Location", "/login"); // 设置Location头字段为登录页面的URL
+                // return response; // 返回重定向响应
+
+				HttpResponse response;
+				response.setStatusCode(200); // HTTP 状态码 200 表示成功
+				response.setHeader("Content-Type", "text/html");
+				std::string responseBody = R"(
+                    <html>
+                    <head>
+                        <title>Register Success</title>
+                        <script type="text/javascript">
+                            alert("Register Success!");
+                            window.location = "/login";
+                        </script>
+                    </head>
+                    <body>
+                        <h2>moving to login...</h2>
+                    </body>
+                    </html>
+				)";
+				response.setBody(responseBody);
+				co_return response;
+			}
+			co_return HttpResponse::makeErrorResponse(400, "Register Failed!");
+		}));
+		//登录路由
+		addAsyncRoute("POST", "/login", accounts.wrap([this, &db](const HttpRequest& req) -> Task<HttpResponse> {
+			std::string_view username, password, mode;
+			req.formParams().extract({{"username", &username}, {"password", &password}, {"mode", &mode}});
+
+			//调用数据库方法进行登录（查询在数据库执行器线程中执行，可能与其他登录合并到一个读事务中）
+			bool loggedIn = co_await db.read([&](Database& database) { return database.loginUser(username, password); });
+			if (loggedIn) {
+				accountEvents.broadcast("{\"event\":\"login\"}");
+				if (mode == "token") {
+					// 无状态令牌：API客户端之后以 Authorization: Bearer <token> 访问
+					HttpResponse response;
+					response.setHeader("Content-Type", "application/json");
+					response.setBody("{\"token\":\"" + tokens.mint(std::string(username)) + "\",\"expires_in\":" +
+						std::to_string(tokens.getOptions().ttl.count()) + "}");
+					co_return response;
+				}
+				HttpResponse response;
+				response.setStatusCode(200); // HTTP 状态码 200 表示成功
+				response.setHeader("Content-Type", "text/html");
+				response.setHeader("Set-Cookie", sessions.makeCookie(sessions.create(std::string(username)))); // 之后的请求凭会话识别用户
+				response.setBody("<html><body><h2>Login Successful</h2></body></html>");
+				co_return response;
+			}
+			//登录失败
+			HttpResponse response;
+			response.setStatusCode(401); // HTTP 状态码 401 表示未授权
+			response.setHeader("Content-Type", "text/html");
+			response.setBody("<html><body><h2>Login Failed</h2></body></html>");
+			co_return response;
+		}));
+
+		// 需要登录的路由：返回当前会话对应的用户名
+		addRoute("GET", "/whoami", [](const HttpRequest& req) {
+			return HttpResponse::makeOkResponse(req.getUser());
+		});
+		markAuthenticated("GET", "/whoami");
+
+		// 注销：删除会话并清除Cookie
+		addRoute("POST", "/logout", [this](const HttpRequest& req) {
+			sessions.remove(std::string(req.getCookie(sessions.getOptions().cookieName)));
+			HttpResponse response = HttpResponse::makeOkResponse("Logged out");
+			response.setHeader("Set-Cookie", sessions.makeExpiredCookie());
+			return response;
+		});
+	}
+private:
+	// 路由表的键；查找时键分配在当前请求的内存池中，不产生全局分配
+	static std::pmr::string routeKey(std::string_view method, std::string_view path) {
+		std::pmr::string key(Arena::resource());
+		key.reserve(method.size() + 1 + path.size());
+		key += method;
+		key += '|';
+		key += path;
+		return key;
+	}
+
+	// 一条路由：处理函数及其缓存策略
+	struct Route {
+		HandlerFunc handler;
+		AsyncHandlerFunc asyncHandler; // 非空时为协程路由
+		std::shared_ptr<UploadRoute> upload; // 非空时为流式上传路由
+		CachePolicy cache;
+		bool idempotent = false; // 是否允许在0-RTT早期数据中执行
+		bool authenticated = false; // 是否需要登录
+		bool trustedOnly = false; // 是否只对可信对端开放
+		int compressionLevel = -1; // 响应的压缩级别，-1表示使用服务器的默认级别，0表示不压缩
+	};
+
+	// 查找路由并执行：需要登录的路由先校验，可缓存的路由经响应缓存
+	HttpResponse dispatch(HttpRequest& request) {
+		auto it = routes.find(routeKey(request.getMethodString(), request.getPath()));
+		if (it != routes.end() && it->second.trustedOnly && !request.isTrusted()) {
+			return HttpResponse::makeErrorResponse(404, "NotFound");
+		}
+		if (it != routes.end()) {
+			const Route& route = it->second;
+			if (route.authenticated) {
+				if (!authenticate(request)) {
+					HttpResponse response = HttpResponse::makeErrorResponse(401, "Not logged in");
+					response.setHeader("WWW-Authenticate", "Bearer");
+					return response;
+				}
+				return invoke(route, request);
+			}
+			if (!route.cache.enabled()) {
+				return invoke(route, request);
+			}
+			return cache.getOrCompute(ResponseCache::makeKey(request, route.cache), route.cache,
+				[&route, &request] { return invoke(route, request); });
+		}
+		// 如果没有找到匹配的路由，返回 404 Not Found 响应
+		return HttpResponse::makeErrorResponse(404, "NotFound");
+	}
+
+	// 协程路由在当前线程中等待完成（HTTP/2与0-RTT路径），数据库队列已满时返回503
+	static HttpResponse invoke(const Route& route, const HttpRequest& request) {
+		PROFILE_SCOPE(HANDLER);
+		if (route.upload) return receiveUpload(*route.upload, request);
+		if (!route.asyncHandler) return route.handler(request);
+		try {
+			return syncWait(route.asyncHandler(request));
+		} catch (const DbExecutor::Overloaded&) {
+			HttpResponse response = HttpResponse::makeErrorResponse(503, "Service Unavailable");
+			response.setHeader("Retry-After", "1");
+			return response;
+		}
+	}
+
+	// 请求体已经完整在内存中的上传请求（HTTP/2与0-RTT路径）：一次交给 UploadReceiver
+	static HttpResponse receiveUpload(const UploadRoute& upload, const HttpRequest& request) {
+		std::string_view body = request.getBody();
+		UploadReceiver receiver(upload, request);
+		if (body.size() > upload.options.maxBodyBytes) return HttpResponse::makeErrorResponse(413, "Payload Too Large");
+		if (!receiver.start(body.size()) || !receiver.feed(body.data(), body.size()) || !receiver.finish()) {
+			return HttpResponse::makeErrorResponse(receiver.errorCode(), receiver.errorMessage());
+		}
+		return receiver.complete();
+	}
+
+	std::unordered_map<std::pmr::string, Route> routes; // 存储路由映射，键为 "方法|路径"
+	std::unordered_map<std::string, WebSocketHandler> webSocketRoutes; // WebSocket路由（按路径）
+	WebSocketHub accountEvents; // 订阅了 /events 的登录页面
+	SessionStore sessions; // 登录会话
+	TokenSigner tokens; // 无状态登录令牌的签发与校验
+	ResponseCache cache; // 幂等路由的进程内响应缓存
+	StaticAssets assets; // 嵌入的静态页面
+};
+
+#endif
@@ -0,0 +1,259 @@
+/*************************************************************************
+	> File Name: SessionStore.h
+	> Author:
+	> Mail:
+	> Created Time: Thu 22 Oct 2026 02:14:37 PM CST
+ ************************************************************************/
+
+// 会话存储：登录成功后发放随机会话ID（Cookie），之后的请求凭会话ID识别用户，不再访问数据库。
+// 会话按ID哈希分片存放，每个分片一把锁；分片内按最近访问时间排成链表，
+// 访问时移到头部（滑动过期），过期与超出上限的淘汰都从尾部进行
+#ifndef _SESSIONSTORE_H
+#define _SESSIONSTORE_H
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <sys/random.h>
+#include <sys/stat.h>
+
+#include "Logger.h"
+
+// 会话相关的配置
+struct SessionOptions {
+	std::string cookieName = "SESSIONID";
+	std::chrono::seconds idleTimeout{1800}; // 超过该时间没有访问的会话失效
+	size_t maxSessions = 100000; // 会话数上限，超出时淘汰最久未访问的会话
+	bool secureCookie = false; // Cookie 带 Secure 属性（只在HTTPS上发送）
+	std::string snapshotPath; // 非空时定期把会话写入该文件，重启后恢复
+	int snapshotIntervalSeconds = 60;
+};
+
+class SessionStore {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Stats {
+		std::atomic<uint64_t> created{0}, hits{0}, misses{0}, expired{0}, evicted{0};
+	};
+
+	explicit SessionStore(const SessionOptions& options = SessionOptions()) : options(options) {}
+
+	SessionStore(const SessionStore&) = delete;
+	SessionStore& operator=(const SessionStore&) = delete;
+
+	// 需在处理请求之前调用
+	void setOptions(const SessionOptions& o) {
+		options = o;
+	}
+
+	const SessionOptions& getOptions() const { return options; }
+
+	// 为用户创建会话，返回会话ID
+	std::string create(const std::string& user) {
+		std::string id = generateId();
+		insert(id, user, Clock::now() + options.idleTimeout);
+		stats.created++;
+		return id;
+	}
+
+	// 查找会话并刷新过期时间；会话存在时把用户名写入 user 并返回true
+	bool lookup(const std::string& id, std::string& user) {
+		if (id.size() != kIdLength) {
+			stats.misses++;
+			return false;
+		}
+		Shard& shard = shardFor(id);
+		Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.sessions.find(id);
+		if (it == shard.sessions.end() || it->second.expires <= now) {
+			stats.misses++;
+			return false;
+		}
+		Entry& entry = it->second;
+		entry.expires = now + options.idleTimeout;
+		shard.lru.splice(shard.lru.begin(), shard.lru, entry.lruPos); // 移到头部，O(1)
+		user = entry.user;
+		stats.hits++;
+		return true;
+	}
+
+	// 删除会话（注销）
+	void remove(const std::string& id) {
+		Shard& shard = shardFor(id);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.sessions.find(id);
+		if (it == shard.sessions.end()) return;
+		shard.lru.erase(it->second.lruPos);
+		shard.sessions.erase(it);
+		count--;
+	}
+
+	// 清理过期会话，由事件循环的定时器周期性调用。各分片的链表尾部就是最早过期的会话，
+	// 因此每次只需从尾部删到第一个未过期的会话为止
+	void expire() {
+		Clock::time_point now = Clock::now();
+		for (Shard& shard : shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			while (!shard.lru.empty()) {
+				auto it = shard.sessions.find(shard.lru.back());
+				if (it->second.expires > now) break;
+				shard.sessions.erase(it);
+				shard.lru.pop_back();
+				count--;
+				stats.expired++;
+			}
+		}
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	// 生成登录成功后下发会话ID的 Set-Cookie 值
+	std::string makeCookie(const std::string& id) const {
+		std::string cookie = options.cookieName + "=" + id + "; Path=/; HttpOnly; SameSite=Lax; Max-Age=" +
+			std::to_string(options.idleTimeout.count());
+		if (options.secureCookie) cookie += "; Secure";
+		return cookie;
+	}
+
+	// 注销时清除浏览器中的Cookie
+	std::string makeExpiredCookie() const {
+		return options.cookieName + "=; Path=/; HttpOnly; SameSite=Lax; Max-Age=0";
+	}
+
+	// 把未过期的会话写入快照文件：先写临时文件再rename，中途崩溃不会留下半个快照。
+	// 文件中每行为 "会话ID 剩余秒数 用户名"，只有属主可读
+	bool save(const std::string& path) const {
+		std::string tmp = path + ".tmp";
+		std::ofstream out(tmp, std::ios::trunc);
+		if (!out.is_open()) {
+			LOG_ERROR("Cannot write session snapshot %s", tmp.c_str());
+			return false;
+		}
+		chmod(tmp.c_str(), 0600);
+		Clock::time_point now = Clock::now();
+		for (const Shard& shard : shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			for (const auto& session : shard.sessions) {
+				auto remaining = std::chrono::duration_cast<std::chrono::seconds>(session.second.expires - now).count();
+				if (remaining <= 0 || session.second.user.find('\n') != std::string::npos) continue;
+				out << session.first << ' ' << remaining << ' ' << session.second.user << '\n';
+			}
+		}
+		out.close();
+		if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+			LOG_ERROR("Failed to save session snapshot %s: %s", path.c_str(), strerror(errno));
+			return false;
+		}
+		return true;
+	}
+
+	// 从快照文件恢复会话，文件不存在时什么也不做；返回恢复的会话数
+	size_t load(const std::string& path) {
+		std::ifstream in(path);
+		if (!in.is_open()) return 0;
+		size_t count = 0;
+		std::string id, user;
+		long long remaining;
+		Clock::time_point now = Clock::now();
+		while (in >> id >> remaining && std::getline(in >> std::ws, user)) {
+			if (id.size() != kIdLength || remaining <= 0) continue;
+			std::chrono::seconds ttl(std::min<long long>(remaining, options.idleTimeout.count()));
+			insert(id, user, now + ttl);
+			count++;
+		}
+		LOG_INFO("Restored %zu sessions from %s", count, path.c_str());
+		return count;
+	}
+
+	const Stats& getStats() const { return stats; }
+
+private:
+	static const size_t kShards = 64;
+	static const size_t kIdBytes = 32; // 256位随机数
+	static const size_t kIdLength = 43; // base64url编码（无填充）后的长度
+
+	struct Entry {
+		std::string user;
+		Clock::time_point expires;
+		std::list<std::string>::iterator lruPos;
+	};
+
+	struct Shard {
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, Entry> sessions;
+		std::list<std::string> lru; // 头部为最近访问
+	};
+
+	SessionOptions options;
+	Shard shards[kShards];
+	std::atomic<size_t> count{0}; // 所有分片的会话总数
+	Stats stats;
+
+	Shard& shardFor(const std::string& id) {
+		return shards[std::hash<std::string>()(id) % kShards];
+	}
+
+	// 插入会话，总数达到上限时从本分片尾部淘汰最久未访问的会话（近似的全局LRU，只需持有一把锁）
+	void insert(const std::string& id, const std::string& user, Clock::time_point expires) {
+		Shard& shard = shardFor(id);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (shard.sessions.count(id)) return;
+		if (count >= options.maxSessions && !shard.lru.empty()) {
+			shard.sessions.erase(shard.lru.back());
+			shard.lru.pop_back();
+			count--;
+			stats.evicted++;
+		}
+		count++;
+		shard.lru.push_front(id);
+		Entry& entry = shard.sessions[id];
+		entry.user = user;
+		entry.expires = expires;
+		entry.lruPos = shard.lru.begin();
+	}
+
+	// 会话ID取自内核的密码学安全随机数
+	static std::string generateId() {
+		unsigned char bytes[kIdBytes];
+		size_t filled = 0;
+		while (filled < sizeof(bytes)) {
+			ssize_t n = getrandom(bytes + filled, sizeof(bytes) - filled, 0);
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				LOG_ERROR("getrandom failed: %s", strerror(errno));
+				throw std::runtime_error("getrandom failed");
+			}
+			filled += n;
+		}
+		static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+		std::string id;
+		id.reserve(kIdLength);
+		uint32_t acc = 0;
+		int bits = 0;
+		for (unsigned char b : bytes) {
+			acc = (acc << 8) | b;
+			bits += 8;
+			while (bits >= 6) {
+				bits -= 6;
+				id += alphabet[(acc >> bits) & 0x3f];
+			}
+		}
+		if (bits > 0) id += alphabet[(acc << (6 - bits)) & 0x3f];
+		return id;
+	}
+};
+
+#endif
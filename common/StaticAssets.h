@@ -0,0 +1,151 @@
+/*************************************************************************
+	> File Name: StaticAssets.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 26 Oct 2026 02:36:19 PM CST
+ ************************************************************************/
+
+// 嵌入可执行文件的静态页面：构建时由 embed_assets.py 把 UI/ 生成为 UiAssets.h（constexpr 字符串、ETag、MIME类型与gzip预压缩版本），
+// 启动与处理请求都不读文件，可执行文件也不依赖工作目录。
+// 开发时用 setOverrideDirectory（UI_DIR 环境变量）改为每次请求从磁盘读取，修改页面后刷新即可看到，无需重新编译。
+// UiAssets.h 生成在各阶段目录下，编译时用 -I. 找到；没有生成时（直接编译 main.cpp）同样从 UI/ 目录读取
+#ifndef _STATIC_ASSETS_H
+#define _STATIC_ASSETS_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "Logger.h"
+
+// 一个嵌入的文件
+struct EmbeddedAsset {
+	std::string_view name; // 相对 UI/ 的路径
+	std::string_view mime;
+	std::string_view etag; // 内容的SHA-256前缀（带引号）
+	std::string_view gzipEtag; // gzip版本的ETag（etag 加 -gz 后缀），没有gzip版本时为空
+	std::string_view body;
+	std::string_view gzip; // gzip预压缩的内容，压缩后不够小时为空
+};
+
+#if __has_include("UiAssets.h")
+#include "UiAssets.h"
+#define HAVE_EMBEDDED_ASSETS 1
+#endif
+
+class StaticAssets {
+public:
+	StaticAssets() {
+#ifndef HAVE_EMBEDDED_ASSETS
+		directory = "UI";
+#endif
+	}
+
+	// 从 dir 目录读取页面（开发时热更新），为空时使用嵌入的页面
+	void setOverrideDirectory(const std::string& dir) {
+		directory = dir;
+#ifndef HAVE_EMBEDDED_ASSETS
+		if (directory.empty()) directory = "UI"; // 没有可用的嵌入页面
+#endif
+		if (!directory.empty()) LOG_INFO("Serving UI pages from directory %s", directory.c_str());
+	}
+
+	// 把名为 name 的页面写入 response：带 ETag，If-None-Match 相同时回复304；
+	// 客户端接受gzip时直接发送预压缩的版本。页面不存在时返回false
+	bool serve(std::string_view name, const HttpRequest& request, HttpResponse& response) const {
+		if (!directory.empty()) return serveFromDisk(name, response);
+#ifdef HAVE_EMBEDDED_ASSETS
+		for (const EmbeddedAsset& asset : kEmbeddedAssets) {
+			if (asset.name != name) continue;
+			bool gzip = !asset.gzip.empty() && acceptsGzip(request.getHeader("accept-encoding"));
+			response.setHeader("Cache-Control", "no-cache"); // 每次使用前凭ETag向服务器确认，页面更新后立即生效
+			response.setHeader("Vary", "Accept-Encoding");
+			// 两个版本的ETag不同；客户端持有任一版本都回复304，并带上它持有的那个ETag
+			std::string_view ifNoneMatch = request.getHeader("if-none-match");
+			bool identityMatch = matchesEtag(ifNoneMatch, asset.etag);
+			if (identityMatch || (!asset.gzipEtag.empty() && matchesEtag(ifNoneMatch, asset.gzipEtag))) {
+				response.setHeader("ETag", identityMatch ? asset.etag : asset.gzipEtag);
+				response.setStatusCode(304);
+				return true;
+			}
+			response.setHeader("Content-Type", asset.mime);
+			if (gzip) {
+				response.setHeader("ETag", asset.gzipEtag);
+				response.setHeader("Content-Encoding", "gzip");
+				response.setBody(asset.gzip);
+			} else {
+				response.setHeader("ETag", asset.etag);
+				response.setBody(asset.body);
+			}
+			return true;
+		}
+#endif
+		return false;
+	}
+
+	// If-None-Match 中是否有与 etag 相同的值（"*" 匹配任意值，弱比较忽略 W/ 前缀）
+	static bool matchesEtag(std::string_view header, std::string_view etag) {
+		if (header.empty()) return false;
+		if (header == "*") return true;
+		size_t pos = 0;
+		while ((pos = header.find(etag, pos)) != std::string_view::npos) {
+			size_t end = pos + etag.size();
+			if (end == header.size() || header[end] == ',' || header[end] == ' ') return true;
+			pos = end;
+		}
+		return false;
+	}
+
+	// Accept-Encoding 中是否接受gzip（gzip;q=0 表示不接受）
+	static bool acceptsGzip(std::string_view header) {
+		size_t pos = 0;
+		while (pos < header.size()) {
+			size_t end = header.find(',', pos);
+			if (end == std::string_view::npos) end = header.size();
+			std::string_view item = header.substr(pos, end - pos);
+			pos = end + 1;
+			while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+			std::string_view coding = item.substr(0, item.find(';'));
+			while (!coding.empty() && coding.back() == ' ') coding.remove_suffix(1);
+			if (coding != "gzip" && coding != "*") continue;
+			size_t q = item.find("q=");
+			return q == std::string_view::npos || strtod(std::string(item.substr(q + 2)).c_str(), nullptr) > 0;
+		}
+		return false;
+	}
+
+	static const char* mimeType(std::string_view name) {
+		std::string_view ext = name.substr(name.rfind('.') == std::string_view::npos ? name.size() : name.rfind('.'));
+		if (ext == ".html") return "text/html; charset=utf-8";
+		if (ext == ".css") return "text/css; charset=utf-8";
+		if (ext == ".js") return "text/javascript; charset=utf-8";
+		if (ext == ".json") return "application/json";
+		if (ext == ".svg") return "image/svg+xml";
+		return "application/octet-stream";
+	}
+
+private:
+	std::string directory; // 非空时从该目录读取页面
+
+	bool serveFromDisk(std::string_view name, HttpResponse& response) const {
+		if (name.find("..") != std::string_view::npos) return false;
+		std::string path = directory + "/" + std::string(name);
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			LOG_ERROR("Unable to open UI file %s", path.c_str());
+			return false;
+		}
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		response.setHeader("Content-Type", mimeType(name));
+		response.setHeader("Cache-Control", "no-store"); // 开发模式：总是取最新的文件
+		response.setBody(buffer.str());
+		return true;
+	}
+};
+
+#endif
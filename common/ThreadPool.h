@@ -72,6 +72,17 @@ public:
 	}
 
 	//析构函数
+	// 提交不需要返回值的任务：不创建 packaged_task 与 future，
+	// 捕获不超过两个指针的 lambda 可以直接存放在 std::function 内部，不产生堆分配
+	void post(std::function<void()> task) {
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			if (stop) throw std::runtime_error("post on stopped ThreadPool");
+			tasks.push(std::move(task));
+		}
+		condition.notify_one();
+	}
+
 	~ThreadPool() {
 		{
 			//使用互斥锁保护停止标志
@@ -0,0 +1,90 @@
+/*************************************************************************
+	> File Name: Timer.h
+	> Author:
+	> Mail:
+	> Created Time: Wed 21 Oct 2026 10:26:40 AM CST
+ ************************************************************************/
+
+// 定时器：哈希时间轮，定时器节点侵入式地嵌在连接等对象中，
+// 添加、取消都是O(1)，每个tick只扫描一个槽位，适合大量长连接的心跳与超时
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 嵌入到需要定时的对象中的链表节点
+struct TimerNode {
+	TimerNode* prev = nullptr;
+	TimerNode* next = nullptr;
+	uint64_t expires = 0; // 到期的tick
+	void* owner = nullptr; // 嵌入该节点的对象，供到期回调使用
+
+	bool scheduled() const { return next != nullptr; }
+};
+
+// 时间轮本身不加锁，只能在一个线程（事件循环线程）中使用
+class TimerWheel {
+public:
+	explicit TimerWheel(size_t slotCount = 1024) : slots(slotCount), current(0) {
+		for (auto& head : slots) head.prev = head.next = &head;
+	}
+
+	TimerWheel(const TimerWheel&) = delete;
+	TimerWheel& operator=(const TimerWheel&) = delete;
+
+	// ticks 个tick之后到期；已在时间轮中的节点会先被移除
+	void schedule(TimerNode* node, uint64_t ticks) {
+		cancel(node);
+		node->expires = current + (ticks > 0 ? ticks : 1);
+		TimerNode& head = slots[node->expires % slots.size()];
+		node->prev = head.prev;
+		node->next = &head;
+		head.prev->next = node;
+		head.prev = node;
+	}
+
+	void cancel(TimerNode* node) {
+		if (!node->scheduled()) return;
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+		node->prev = node->next = nullptr;
+	}
+
+	// 前进 ticks 个tick，对每个到期的节点调用 onExpire(TimerNode*)；回调中可以重新 schedule 该节点
+	template <class F>
+	void advance(uint64_t ticks, F&& onExpire) {
+		while (ticks-- > 0) {
+			current++;
+			TimerNode& head = slots[current % slots.size()];
+			// 先把到期节点摘到临时链表上，避免回调中重新加入同一槽位时被重复处理
+			TimerNode expired;
+			expired.prev = expired.next = &expired;
+			for (TimerNode* node = head.next; node != &head; ) {
+				TimerNode* next = node->next;
+				if (node->expires <= current) { // 槽位中还有需要再转几圈才到期的节点
+					cancel(node);
+					node->prev = expired.prev;
+					node->next = &expired;
+					expired.prev->next = node;
+					expired.prev = node;
+				}
+				node = next;
+			}
+			while (expired.next != &expired) {
+				TimerNode* node = expired.next;
+				cancel(node);
+				onExpire(node);
+			}
+		}
+	}
+
+	uint64_t now() const { return current; }
+
+private:
+	std::vector<TimerNode> slots; // 每个槽位是一个带哨兵的双向循环链表
+	uint64_t current; // 当前tick
+};
+
+#endif
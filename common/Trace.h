@@ -0,0 +1,288 @@
+/*************************************************************************
+	> File Name: Trace.h
+	> Author:
+	> Mail:
+	> Created Time: Wed 28 Oct 2026 10:05:27 AM CST
+ ************************************************************************/
+
+// 请求生命周期追踪：被采样的请求在各个阶段（入队、握手、解析、路由、数据库排队与执行、发送）记录纳秒级的时间段，
+// 写入每个线程自己的环形缓冲区（单写者，无锁，写满后覆盖最旧的记录），需要时导出为 Chrome trace-event JSON，
+// 用 chrome://tracing 或 ui.perfetto.dev 打开即可逐段查看一个慢请求的时间花在了哪里。
+//   Tracer::start(force)   决定是否追踪一个请求：按 sampleRate 随机采样，force（可信对端的 X-Trace 请求头）为 "1" 时必定追踪
+//   TraceScope scope(id)   作用域内把 id 设为当前线程正在追踪的请求
+//   TraceSpan span("x")    作用域内的一段时间，当前线程没有正在追踪的请求时什么都不做
+//   Tracer::record(...)    记录已知起止时间的一段（例如入队与握手，它们发生在决定采样之前）
+//   Tracer::dump(out, id)  导出所有线程缓冲区中的记录（id 非0时只导出该请求）
+// 未被采样的请求只多一次 clock_gettime（vDSO，不进入内核）
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <random>
+#include <ostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+struct TraceOptions {
+	double sampleRate = 0.001; // 随机采样的比例，0表示只追踪带 X-Trace: 1 的请求
+	size_t eventsPerThread = 4096; // 每个线程环形缓冲区的记录数
+	// 可以用 X-Trace 强制追踪、读取 /debug/trace 的对端地址（直接连接的TCP对端，与 ListenAddress::peerName 的格式相同）。
+	// 经nginx转发的请求对端都是 "unix"，默认不信任
+	std::vector<std::string> trustedAddresses = {"127.0.0.1", "::1"};
+
+	bool trusts(std::string_view peer) const {
+		for (const std::string& address : trustedAddresses) {
+			if (address == peer) return true;
+		}
+		return false;
+	}
+};
+
+// 一个线程的追踪记录。只有所属线程写入；导出时其他线程按序号校验读取（seqlock），读到正在写的记录时跳过
+class TraceBuffer {
+public:
+	explicit TraceBuffer(size_t capacity)
+		: capacity(capacity ? capacity : 1), events(new Event[this->capacity]), tid(static_cast<int>(syscall(SYS_gettid))) {}
+
+	void push(const char* name, uint64_t trace, uint64_t start, uint64_t end, std::string_view detail) {
+		uint64_t index = head.load(std::memory_order_relaxed);
+		Event& event = events[index % capacity];
+		uint32_t seq = event.seq.load(std::memory_order_relaxed);
+		event.seq.store(seq + 1, std::memory_order_relaxed); // 奇数：正在写入
+		std::atomic_thread_fence(std::memory_order_release);
+		event.name = name;
+		event.trace = trace;
+		event.start = start;
+		event.duration = end > start ? end - start : 0;
+		size_t n = detail.size() < sizeof(event.detail) - 1 ? detail.size() : sizeof(event.detail) - 1;
+		memcpy(event.detail, detail.data(), n);
+		event.detail[n] = '\0';
+		event.seq.store(seq + 2, std::memory_order_release);
+		head.store(index + 1, std::memory_order_release);
+	}
+
+	// 对缓冲区中每条完整的记录调用 f(name, trace, start, duration, detail)
+	template <class F>
+	void forEach(F f) const {
+		uint64_t end = head.load(std::memory_order_acquire);
+		uint64_t begin = end > capacity ? end - capacity : 0;
+		for (uint64_t i = begin; i < end; i++) {
+			const Event& event = events[i % capacity];
+			uint32_t seq = event.seq.load(std::memory_order_acquire);
+			if (seq & 1) continue;
+			const char* name = event.name;
+			uint64_t trace = event.trace, start = event.start, duration = event.duration;
+			char detail[sizeof(event.detail)];
+			memcpy(detail, event.detail, sizeof(detail));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (event.seq.load(std::memory_order_relaxed) != seq) continue; // 读的过程中被覆盖
+			detail[sizeof(detail) - 1] = '\0';
+			f(name, trace, start, duration, detail);
+		}
+	}
+
+	int getTid() const {
+		return tid;
+	}
+
+private:
+	struct Event {
+		std::atomic<uint32_t> seq{0};
+		const char* name = nullptr; // 阶段名，必须是静态字符串
+		uint64_t trace = 0;
+		uint64_t start = 0, duration = 0; // 纳秒（CLOCK_MONOTONIC）
+		char detail[40] = {}; // 附加信息，例如请求行
+	};
+
+	size_t capacity;
+	std::unique_ptr<Event[]> events;
+	std::atomic<uint64_t> head{0}; // 已写入的记录总数
+	int tid;
+};
+
+class Tracer {
+public:
+	// 当前时间，纳秒（CLOCK_MONOTONIC，与 std::chrono::steady_clock 同一时钟）
+	static uint64_t now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+	}
+
+	static uint64_t toNanos(std::chrono::steady_clock::time_point t) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+	}
+
+	// 在开始处理请求之前设置
+	static void setOptions(const TraceOptions& options) {
+		state().options = options;
+	}
+
+	static const TraceOptions& getOptions() {
+		return state().options;
+	}
+
+	// 决定是否追踪一个请求，返回新的追踪ID，不追踪时返回0
+	static uint64_t start(std::string_view force) {
+		double rate = state().options.sampleRate;
+		bool sampled = force == "1" || (rate > 0 && (rate >= 1 || (random() >> 11) * 0x1.0p-53 < rate));
+		if (!sampled) return 0;
+		state().sampled++;
+		uint64_t id;
+		do {
+			id = random();
+		} while (id == 0);
+		return id;
+	}
+
+	// 当前线程正在追踪的请求，没有时为0
+	static uint64_t current() {
+		return currentTrace();
+	}
+
+	static void record(const char* name, uint64_t start, uint64_t end, std::string_view detail = std::string_view(), uint64_t trace = current()) {
+		if (trace == 0) return;
+		localBuffer().push(name, trace, start, end, detail);
+		state().recorded.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// 追踪ID的文本形式（16位十六进制），用于 X-Trace-Id 响应头与导出的 args.trace
+	static std::string idString(uint64_t id) {
+		char text[17];
+		snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(id));
+		return text;
+	}
+
+	// 导出为 Chrome trace-event JSON；trace 非0时只导出该请求的记录
+	static void dump(std::ostream& out, uint64_t trace = 0) {
+		std::vector<std::shared_ptr<TraceBuffer> > buffers;
+		{
+			std::lock_guard<std::mutex> lock(state().mutex);
+			buffers = state().buffers;
+		}
+		int pid = getpid();
+		bool first = true;
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		for (const std::shared_ptr<TraceBuffer>& buffer : buffers) {
+			int tid = buffer->getTid();
+			buffer->forEach([&](const char* name, uint64_t id, uint64_t start, uint64_t duration, const char* detail) {
+				if (trace != 0 && id != trace) return ;
+				char line[160];
+				snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"cat\":\"http\",\"ph\":\"X\",\"ts\":%llu.%03u,\"dur\":%llu.%03u,\"pid\":%d,\"tid\":%d,",
+					first ? "\n" : ",\n", name, static_cast<unsigned long long>(start / 1000), unsigned(start % 1000),
+					static_cast<unsigned long long>(duration / 1000), unsigned(duration % 1000), pid, tid);
+				out << line << "\"args\":{\"trace\":\"" << idString(id) << "\"";
+				if (*detail) {
+					out << ",\"detail\":\"";
+					writeEscaped(out, detail);
+					out << "\"";
+				}
+				out << "}}";
+				first = false;
+			});
+		}
+		out << "\n]}\n";
+	}
+
+	static void writeMetrics(std::ostream& out) {
+		out << "trace_requests_sampled_total " << state().sampled << "\n"
+			<< "trace_events_recorded_total " << state().recorded << "\n";
+	}
+
+private:
+	struct State {
+		TraceOptions options;
+		std::mutex mutex; // 保护 buffers（每个线程只在第一次记录时注册一次）
+		std::vector<std::shared_ptr<TraceBuffer> > buffers; // 线程退出后缓冲区仍保留，可以导出
+		std::atomic<uint64_t> sampled{0}, recorded{0};
+	};
+
+	static State& state() {
+		static State instance;
+		return instance;
+	}
+
+	static uint64_t& currentTrace() {
+		thread_local uint64_t trace = 0;
+		return trace;
+	}
+
+	static TraceBuffer& localBuffer() {
+		thread_local std::shared_ptr<TraceBuffer> buffer;
+		if (!buffer) {
+			buffer = std::make_shared<TraceBuffer>(state().options.eventsPerThread);
+			std::lock_guard<std::mutex> lock(state().mutex);
+			state().buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	// 每个线程一个 xorshift64* 生成器，采样与生成追踪ID都不加锁
+	static uint64_t random() {
+		thread_local uint64_t seed = (uint64_t(std::random_device()()) << 32 | std::random_device()()) | 1;
+		seed ^= seed >> 12;
+		seed ^= seed << 25;
+		seed ^= seed >> 27;
+		return seed * 0x2545F4914F6CDD1DULL;
+	}
+
+	static void writeEscaped(std::ostream& out, const char* text) {
+		for (; *text; text++) {
+			unsigned char c = *text;
+			if (c == '"' || c == '\\') out << '\\' << c;
+			else if (c < 0x20) out << ' ';
+			else out << c;
+		}
+	}
+
+	friend class TraceScope;
+};
+
+// 作用域内把 trace 设为当前线程正在追踪的请求，结束时恢复之前的值
+class TraceScope {
+public:
+	explicit TraceScope(uint64_t trace) : previous(Tracer::currentTrace()) {
+		Tracer::currentTrace() = trace;
+	}
+
+	~TraceScope() {
+		Tracer::currentTrace() = previous;
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	uint64_t previous;
+};
+
+// 作用域内的一段时间，记入当前线程正在追踪的请求；detail 需在作用域结束前有效
+class TraceSpan {
+public:
+	explicit TraceSpan(const char* name, std::string_view detail = std::string_view())
+		: name(name), detail(detail), trace(Tracer::current()), start(trace ? Tracer::now() : 0) {}
+
+	~TraceSpan() {
+		if (trace) Tracer::record(name, start, Tracer::now(), detail, trace);
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+	const char* name;
+	std::string_view detail;
+	uint64_t trace;
+	uint64_t start;
+};
+
+#endif
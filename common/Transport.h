@@ -0,0 +1,126 @@
+/*************************************************************************
+	> File Name: Transport.h
+	> Author:
+	> Mail:
+	> Created Time: Mon 19 Oct 2026 10:12:31 AM CST
+ ************************************************************************/
+
+// 传输层策略：HttpServer<Transport> 在编译期选择具体的读写实现，I/O路径上没有虚函数调用
+// 每个策略需要提供：
+//   struct Session;                                    每个连接的传输层状态
+//   static constexpr bool needsHandshake;              连接建立后是否需要握手
+//   bool open(Session&, int fd);                       为新连接创建传输层状态
+//   IoStatus handshake(Session&);                      推进握手（明文传输直接返回IO_OK）
+//   IoStatus read(Session&, char*, size_t, size_t&);   读取数据
+//   IoStatus readv(Session&, const iovec*, int, size_t&); 依次读入多段缓冲区
+//   IoStatus write(Session&, const char*, size_t, size_t&);  发送数据
+//   static constexpr bool canSplice;                   能否用 splice 把收到的数据直接移入管道
+//   IoStatus splice(Session&, int, size_t, size_t&);   把套接字上的数据移入管道（canSplice 为true时才需要）
+//   bool takeEarlyData(Session&, std::string&);        取走握手期间收到的0-RTT早期数据
+//   bool negotiatedHttp2(Session&);                     握手时是否通过ALPN协商了HTTP/2
+//   void close(Session&);                              释放传输层状态（不关闭fd）
+//   size_t memoryUsage(const Session&);                传输层为该连接占用的内存（字节）
+//   void writeMetrics(std::ostream&);                  导出传输层计数器（/metrics）
+#ifndef _TRANSPORT_H
+#define _TRANSPORT_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ostream>
+#include <string>
+
+// 一次传输层操作的结果
+enum IoStatus {
+	IO_OK,          // 操作成功，n 中为实际处理的字节数
+	IO_WANT_READ,   // 需要等待套接字可读后重试
+	IO_WANT_WRITE,  // 需要等待套接字可写后重试
+	IO_CLOSED,      // 对端已关闭连接
+	IO_ERROR        // 发生不可恢复的错误
+};
+
+// 明文TCP传输，直接使用 read/send/splice 系统调用
+class PlainTransport {
+public:
+	struct Session {
+		int fd = -1;
+	};
+
+	static constexpr bool needsHandshake = false;
+	static constexpr bool canSplice = true; // 套接字上就是明文，可以不经过用户态直接搬走
+
+	static const char* name() { return "HTTP"; }
+
+	bool open(Session& s, int fd) {
+		s.fd = fd;
+		return true;
+	}
+
+	IoStatus handshake(Session&) {
+		return IO_OK; // 明文连接不需要握手
+	}
+
+	IoStatus read(Session& s, char* buf, size_t len, size_t& n) {
+		ssize_t ret = ::read(s.fd, buf, len);
+		if (ret > 0) {
+			n = ret;
+			return IO_OK;
+		}
+		if (ret == 0) return IO_CLOSED;
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? IO_WANT_READ : IO_ERROR;
+	}
+
+	IoStatus readv(Session& s, const struct iovec* iov, int count, size_t& n) {
+		ssize_t ret = ::readv(s.fd, iov, count); // 一次系统调用填满多个内存块
+		if (ret > 0) {
+			n = ret;
+			return IO_OK;
+		}
+		if (ret == 0) return IO_CLOSED;
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? IO_WANT_READ : IO_ERROR;
+	}
+
+	IoStatus write(Session& s, const char* buf, size_t len, size_t& n) {
+		ssize_t ret = ::send(s.fd, buf, len, MSG_NOSIGNAL); // MSG_NOSIGNAL 避免对端关闭时触发SIGPIPE
+		if (ret >= 0) {
+			n = ret;
+			return IO_OK;
+		}
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? IO_WANT_WRITE : IO_ERROR;
+	}
+
+	// 把套接字上最多 len 字节的数据移入管道 pipe_fd（上传请求体经管道写入文件）。
+	// 管道以非阻塞方式使用，调用方保证每次移入后取空管道，EAGAIN 只可能来自套接字
+	IoStatus splice(Session& s, int pipe_fd, size_t len, size_t& n) {
+		ssize_t ret = ::splice(s.fd, nullptr, pipe_fd, nullptr, len, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (ret > 0) {
+			n = ret;
+			return IO_OK;
+		}
+		if (ret == 0) return IO_CLOSED;
+		return (errno == EAGAIN || errno == EWOULDBLOCK) ? IO_WANT_READ : IO_ERROR;
+	}
+
+	bool takeEarlyData(Session&, std::string&) {
+		return false; // 明文连接没有早期数据
+	}
+
+	bool negotiatedHttp2(Session&) {
+		return false; // 明文连接没有ALPN，HTTP/2只能通过连接前言识别（h2c先验知识）
+	}
+
+	void close(Session& s) {
+		s.fd = -1;
+	}
+
+	size_t memoryUsage(const Session&) const {
+		return 0; // 明文连接在内核之外没有传输层状态
+	}
+
+	void writeMetrics(std::ostream&) {}
+};
+
+#endif
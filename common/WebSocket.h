@@ -0,0 +1,529 @@
+/*************************************************************************
+	> File Name: WebSocket.h
+	> Author:
+	> Mail:
+	> Created Time: Wed 21 Oct 2026 11:02:15 AM CST
+ ************************************************************************/
+
+// WebSocket（RFC 6455）：升级握手、帧解析（SIMD去掩码）、分片重组、心跳与每连接的发送队列
+// 与传输层无关，明文与TLS连接共用；帧的收发由处理该连接的工作线程完成，
+// 其他线程通过 WebSocketChannel 推送消息
+#ifndef _WEBSOCKET_H
+#define _WEBSOCKET_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+#include <cstring>
+#include <strings.h>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "HttpRequest.h"
+
+// WebSocket相关的配置
+struct WebSocketOptions {
+	size_t maxMessageSize = 1 << 20; // 单条消息（分片重组后）的上限，超过时以1009关闭
+	size_t maxQueuedBytes = 1 << 20; // 每个连接发送队列的上限，超过时新消息被丢弃（慢消费者）
+	int pingIntervalSeconds = 30; // 空闲心跳间隔，连续两个间隔没有收到任何帧时关闭连接
+};
+
+// 帧编解码与握手用到的工具函数
+class WebSocket {
+public:
+	enum Opcode {
+		CONTINUATION = 0x0, TEXT = 0x1, BINARY = 0x2, CLOSE = 0x8, PING = 0x9, PONG = 0xa
+	};
+
+	// 关闭码
+	enum CloseCode {
+		NORMAL_CLOSURE = 1000, GOING_AWAY = 1001, PROTOCOL_ERROR = 1002, INVALID_PAYLOAD = 1007,
+		MESSAGE_TOO_BIG = 1009
+	};
+
+	// 请求是否为WebSocket升级请求
+	static bool isUpgradeRequest(const HttpRequest& request) {
+		return request.getMethodString() == "GET" && containsToken(request.getHeader("upgrade"), "websocket") &&
+			containsToken(request.getHeader("connection"), "upgrade");
+	}
+
+	// Sec-WebSocket-Accept = base64(SHA1(key + GUID))
+	static std::string acceptKey(const std::string& key) {
+		return base64Encode(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+	}
+
+	// 服务端发出的帧不加掩码
+	static void encodeFrame(std::string& out, uint8_t opcode, const char* data, size_t len) {
+		out += static_cast<char>(0x80 | opcode); // FIN=1，不分片
+		if (len < 126) {
+			out += static_cast<char>(len);
+		} else if (len <= 0xffff) {
+			out += static_cast<char>(126);
+			out += static_cast<char>(len >> 8);
+			out += static_cast<char>(len);
+		} else {
+			out += static_cast<char>(127);
+			for (int shift = 56; shift >= 0; shift -= 8) out += static_cast<char>(uint64_t(len) >> shift);
+		}
+		out.append(data, len);
+	}
+
+	static void encodeClose(std::string& out, uint16_t code, const std::string& reason = "") {
+		std::string payload;
+		payload += static_cast<char>(code >> 8);
+		payload += static_cast<char>(code);
+		payload += reason.substr(0, 123); // 控制帧负载不超过125字节
+		encodeFrame(out, CLOSE, payload.data(), payload.size());
+	}
+
+	// 用4字节掩码异或负载；支持时每次处理32/16字节，其余按8字节处理
+	static void unmask(char* data, size_t len, const uint8_t key[4]) {
+		uint32_t k;
+		memcpy(&k, key, 4);
+		size_t i = 0;
+#if defined(__AVX2__)
+		__m256i mask256 = _mm256_set1_epi32(k);
+		for (; i + 32 <= len; i += 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(v, mask256));
+		}
+#endif
+#if defined(__SSE2__)
+		__m128i mask128 = _mm_set1_epi32(k);
+		for (; i + 16 <= len; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(v, mask128));
+		}
+#endif
+		uint64_t k8 = (uint64_t(k) << 32) | k;
+		for (; i + 8 <= len; i += 8) {
+			uint64_t v;
+			memcpy(&v, data + i, 8);
+			v ^= k8;
+			memcpy(data + i, &v, 8);
+		}
+		for (; i < len; ++i) data[i] ^= key[i % 4]; // 前面每次处理4的倍数个字节，掩码相位不变
+	}
+
+	// 文本消息必须是合法的UTF-8
+	static bool isValidUtf8(const std::string& s) {
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+		const unsigned char* end = p + s.size();
+		while (p < end) {
+			if (*p < 0x80) {
+				p++;
+				continue;
+			}
+			int n;
+			uint32_t cp;
+			if ((*p & 0xe0) == 0xc0) { n = 1; cp = *p & 0x1f; }
+			else if ((*p & 0xf0) == 0xe0) { n = 2; cp = *p & 0x0f; }
+			else if ((*p & 0xf8) == 0xf0) { n = 3; cp = *p & 0x07; }
+			else return false;
+			if (end - p <= n) return false;
+			for (int i = 1; i <= n; ++i) {
+				if ((p[i] & 0xc0) != 0x80) return false;
+				cp = (cp << 6) | (p[i] & 0x3f);
+			}
+			static const uint32_t minimum[] = {0, 0x80, 0x800, 0x10000};
+			if (cp < minimum[n] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) return false; // 过长编码与代理区
+			p += n + 1;
+		}
+		return true;
+	}
+
+	static std::string base64Encode(const std::string& in) {
+		static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string out;
+		size_t i = 0;
+		for (; i + 2 < in.size(); i += 3) {
+			uint32_t v = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8) | uint8_t(in[i + 2]);
+			out += table[v >> 18];
+			out += table[(v >> 12) & 63];
+			out += table[(v >> 6) & 63];
+			out += table[v & 63];
+		}
+		if (i + 1 == in.size()) {
+			uint32_t v = uint8_t(in[i]) << 16;
+			out += table[v >> 18];
+			out += table[(v >> 12) & 63];
+			out += "==";
+		} else if (i + 2 == in.size()) {
+			uint32_t v = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8);
+			out += table[v >> 18];
+			out += table[(v >> 12) & 63];
+			out += table[(v >> 6) & 63];
+			out += '=';
+		}
+		return out;
+	}
+
+	// SHA-1（只用于握手，不用于安全目的），返回20字节摘要
+	static std::string sha1(const std::string& message) {
+		uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+		std::string data = message;
+		uint64_t bitLength = uint64_t(message.size()) * 8;
+		data += static_cast<char>(0x80);
+		while (data.size() % 64 != 56) data += '\0';
+		for (int shift = 56; shift >= 0; shift -= 8) data += static_cast<char>(bitLength >> shift);
+
+		for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+			uint32_t w[80];
+			for (int i = 0; i < 16; ++i) {
+				const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data() + chunk + i * 4);
+				w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+			}
+			for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+			uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+			for (int i = 0; i < 80; ++i) {
+				uint32_t f, k;
+				if (i < 20) { f = (b & c) | (~b & d); k = 0x5a827999; }
+				else if (i < 40) { f = b ^ c ^ d; k = 0x6ed9eba1; }
+				else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; }
+				else { f = b ^ c ^ d; k = 0xca62c1d6; }
+				uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+				e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+			}
+			h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+		}
+		std::string digest;
+		for (uint32_t v : h) {
+			for (int shift = 24; shift >= 0; shift -= 8) digest += static_cast<char>(v >> shift);
+		}
+		return digest;
+	}
+
+private:
+	static uint32_t rotl(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+	// 逗号分隔的请求头中是否包含某个标记（不区分大小写）
+	static bool containsToken(std::string_view value, std::string_view token) {
+		size_t start = 0;
+		while (start <= value.size()) {
+			size_t end = value.find(',', start);
+			if (end == std::string_view::npos) end = value.size();
+			size_t b = value.find_first_not_of(" \t", start);
+			size_t e = value.find_last_not_of(" \t", end - 1);
+			if (b != std::string_view::npos && b < end && e - b + 1 == token.size() &&
+				strncasecmp(value.data() + b, token.data(), token.size()) == 0) return true;
+			start = end + 1;
+		}
+		return false;
+	}
+};
+
+// 一个WebSocket连接的发送端，可在任意线程中使用；连接关闭后发送会失败
+class WebSocketChannel : public std::enable_shared_from_this<WebSocketChannel> {
+public:
+	using Wakeup = std::function<void(const std::shared_ptr<WebSocketChannel>&)>;
+
+	WebSocketChannel(size_t maxQueuedBytes, Wakeup wakeup)
+		: maxQueued(maxQueuedBytes), wakeup(std::move(wakeup)), open(true), closeCode(0) {}
+
+	bool sendText(const std::string& text) {
+		std::string frame;
+		WebSocket::encodeFrame(frame, WebSocket::TEXT, text.data(), text.size());
+		return sendFrame(frame);
+	}
+
+	bool sendBinary(const std::string& data) {
+		std::string frame;
+		WebSocket::encodeFrame(frame, WebSocket::BINARY, data.data(), data.size());
+		return sendFrame(frame);
+	}
+
+	// 发送一个已编码的帧（广播时同一帧只编码一次）
+	bool sendFrame(const std::string& frame) {
+		bool wasEmpty;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!open || closeCode) return false;
+			if (outbox.size() + frame.size() > maxQueued) {
+				dropped++;
+				return false; // 对端读得太慢，丢弃新消息而不是无限占用内存
+			}
+			wasEmpty = outbox.empty();
+			outbox += frame;
+		}
+		if (wasEmpty) wakeup(shared_from_this()); // 队列由空变为非空时才需要通知事件循环
+		return true;
+	}
+
+	// 发起关闭握手
+	void close(uint16_t code = WebSocket::NORMAL_CLOSURE) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!open || closeCode) return;
+			closeCode = code;
+		}
+		wakeup(shared_from_this());
+	}
+
+	bool isOpen() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return open;
+	}
+
+	uint64_t getDropped() const { return dropped; }
+
+	// 发送队列占用的内存
+	size_t memoryUsage() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return sizeof(*this) + outbox.capacity();
+	}
+
+	// 以下由服务器调用：取走待发送的数据与关闭请求
+	void takeOutbox(std::string& out, uint16_t& code) {
+		std::lock_guard<std::mutex> lock(mutex);
+		out += outbox;
+		outbox.clear();
+		if (outbox.capacity() > 4096) std::string().swap(outbox); // 空闲连接不保留大块缓冲
+		code = closeCode;
+	}
+
+	// 连接已关闭
+	void detach() {
+		std::lock_guard<std::mutex> lock(mutex);
+		open = false;
+		std::string().swap(outbox);
+	}
+
+private:
+	std::mutex mutex;
+	std::string outbox; // 已编码、等待工作线程发出的帧
+	size_t maxQueued;
+	Wakeup wakeup; // 通知事件循环该连接有数据要发送
+	bool open;
+	uint16_t closeCode; // 非0表示应用请求关闭连接
+	std::atomic<uint64_t> dropped{0};
+};
+
+using WebSocketPtr = std::shared_ptr<WebSocketChannel>;
+
+// 路由上的WebSocket回调，均在处理该连接的工作线程中调用
+struct WebSocketHandler {
+	std::function<void(const WebSocketPtr&, const HttpRequest&)> onOpen; // 握手完成
+	std::function<void(const WebSocketPtr&, const std::string&, bool)> onMessage; // 收到完整消息（第三个参数表示二进制）
+	std::function<void(const WebSocketPtr&)> onClose; // 连接已关闭
+};
+
+// 增量帧解析器：处理掩码、分片重组与控制帧，不完整的帧留在缓冲区中等待后续数据
+class WebSocketFrameParser {
+public:
+	explicit WebSocketFrameParser(size_t maxMessageSize) : maxMessageSize(maxMessageSize), messageOpcode(0), fragmented(false) {}
+
+	size_t memoryUsage() const { return buffer.capacity() + message.capacity(); }
+
+	// 每个完整的数据消息或控制帧调用一次 onMessage(opcode, payload)；
+	// 返回0表示正常，否则为应当发送给对端的关闭码
+	template <class F>
+	uint16_t feed(const char* data, size_t len, F&& onMessage) {
+		buffer.append(data, len);
+		size_t pos = 0;
+		uint16_t error = 0;
+		while (buffer.size() - pos >= 2) {
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(buffer.data() + pos);
+			size_t avail = buffer.size() - pos;
+			bool fin = p[0] & 0x80;
+			uint8_t opcode = p[0] & 0x0f;
+			uint64_t payloadLength = p[1] & 0x7f;
+			size_t headerLength = 2;
+			// 未协商扩展，RSV位必须为0；客户端发出的帧必须带掩码
+			if ((p[0] & 0x70) || !(p[1] & 0x80)) { error = WebSocket::PROTOCOL_ERROR; break; }
+			if (payloadLength == 126) {
+				if (avail < 4) break;
+				payloadLength = (p[2] << 8) | p[3];
+				headerLength = 4;
+			} else if (payloadLength == 127) {
+				if (avail < 10) break;
+				payloadLength = 0;
+				for (int i = 0; i < 8; ++i) payloadLength = (payloadLength << 8) | p[2 + i];
+				headerLength = 10;
+			}
+			headerLength += 4; // 掩码
+			bool control = opcode & 0x8;
+			if (control) {
+				// 控制帧不能分片，负载不超过125字节，可以插在分片消息的中间
+				if (!fin || payloadLength > 125 || opcode > WebSocket::PONG) { error = WebSocket::PROTOCOL_ERROR; break; }
+			} else {
+				if (opcode > WebSocket::BINARY || (opcode == WebSocket::CONTINUATION) != fragmented) {
+					error = WebSocket::PROTOCOL_ERROR; // 分片顺序错误或未知操作码
+					break;
+				}
+				if (payloadLength > maxMessageSize - message.size()) { error = WebSocket::MESSAGE_TOO_BIG; break; }
+			}
+			if (avail < headerLength + payloadLength) break; // 帧尚未完整到达
+
+			char* payload = &buffer[pos + headerLength];
+			WebSocket::unmask(payload, payloadLength, p + headerLength - 4);
+			pos += headerLength + payloadLength;
+			if (control) {
+				std::string body(payload, payloadLength);
+				onMessage(opcode, body);
+				continue;
+			}
+			if (opcode != WebSocket::CONTINUATION) messageOpcode = opcode;
+			message.append(payload, payloadLength);
+			fragmented = !fin;
+			if (fin) {
+				if (messageOpcode == WebSocket::TEXT && !WebSocket::isValidUtf8(message)) {
+					error = WebSocket::INVALID_PAYLOAD;
+					break;
+				}
+				onMessage(messageOpcode, message);
+				message.clear();
+			}
+		}
+		buffer.erase(0, pos);
+		// 空闲连接不保留大块缓冲，大量空闲连接时内存只与连接数成正比
+		if (buffer.empty() && buffer.capacity() > 4096) std::string().swap(buffer);
+		if (message.empty() && message.capacity() > 4096) std::string().swap(message);
+		return error;
+	}
+
+private:
+	size_t maxMessageSize;
+	std::string buffer; // 尚未构成完整帧的输入
+	std::string message; // 正在重组的分片消息
+	uint8_t messageOpcode; // 分片消息的类型（TEXT/BINARY）
+	bool fragmented; // 是否处于分片消息的中间
+};
+
+// 每个已升级连接的状态，由拥有该连接的工作线程访问（pingDue 除外）
+class WebSocketSession {
+public:
+	WebSocketSession(const WebSocketHandler* handler, const WebSocketOptions& options, WebSocketChannel::Wakeup wakeup)
+		: parser(options.maxMessageSize), handler(handler),
+		  channel(std::make_shared<WebSocketChannel>(options.maxQueuedBytes, std::move(wakeup))),
+		  awaitingPong(false), closeSent(false) {}
+
+	const WebSocketPtr& getChannel() const { return channel; }
+
+	void opened(const HttpRequest& request) {
+		if (handler->onOpen) handler->onOpen(channel, request);
+	}
+
+	// 处理收到的数据，回复写入 out；返回false表示连接应在发送完 out 后关闭
+	bool onData(const char* data, size_t len, std::string& out) {
+		awaitingPong = false; // 收到任何数据都说明对端仍然存活
+		bool keepOpen = true;
+		uint16_t error = parser.feed(data, len, [&](uint8_t opcode, std::string& payload) {
+			if (!keepOpen) return;
+			switch (opcode) {
+				case WebSocket::TEXT:
+				case WebSocket::BINARY:
+					if (handler->onMessage) handler->onMessage(channel, payload, opcode == WebSocket::BINARY);
+					break;
+				case WebSocket::PING:
+					WebSocket::encodeFrame(out, WebSocket::PONG, payload.data(), payload.size());
+					break;
+				case WebSocket::CLOSE: {
+					// 回应关闭帧（原样带回关闭码）后关闭连接
+					uint16_t code = WebSocket::NORMAL_CLOSURE;
+					if (payload.size() >= 2) code = (uint8_t(payload[0]) << 8) | uint8_t(payload[1]);
+					if (!closeSent) WebSocket::encodeClose(out, code);
+					closeSent = true;
+					keepOpen = false;
+					break;
+				}
+				default: // PONG
+					break;
+			}
+		});
+		if (error && keepOpen) {
+			WebSocket::encodeClose(out, error);
+			closeSent = true;
+			return false;
+		}
+		return keepOpen;
+	}
+
+	// 把应用推送的消息移入 out；返回false表示连接应在发送完 out 后关闭
+	bool pump(std::string& out) {
+		uint16_t code = 0;
+		channel->takeOutbox(out, code);
+		if (code && !closeSent) {
+			WebSocket::encodeClose(out, code); // 等待对端回应关闭帧，超时由心跳处理
+			closeSent = true;
+		}
+		if (pingDue.exchange(false)) {
+			// 上一个间隔发出的PING没有得到任何回应，或者关闭握手迟迟没有完成
+			if (awaitingPong || closeSent) return false;
+			WebSocket::encodeFrame(out, WebSocket::PING, "", 0);
+			awaitingPong = true;
+		}
+		return true;
+	}
+
+	// 解析状态占用的内存
+	size_t parserMemory() const {
+		return sizeof(*this) + parser.memoryUsage();
+	}
+
+	// 尚未取走的推送消息占用的内存
+	size_t queueMemory() const {
+		return channel->memoryUsage();
+	}
+
+	void closed() {
+		channel->detach();
+		if (handler->onClose) handler->onClose(channel);
+	}
+
+	std::atomic<bool> pingDue{false}; // 心跳定时器到期，由事件循环线程设置
+
+private:
+	WebSocketFrameParser parser;
+	const WebSocketHandler* handler;
+	WebSocketPtr channel;
+	bool awaitingPong; // 已发出PING且之后没有收到任何数据
+	bool closeSent; // 已发出关闭帧
+};
+
+// 一组WebSocket连接，用于向所有订阅者广播
+class WebSocketHub {
+public:
+	void join(const WebSocketPtr& channel) {
+		std::lock_guard<std::mutex> lock(mutex);
+		channels.insert(channel);
+	}
+
+	void leave(const WebSocketPtr& channel) {
+		std::lock_guard<std::mutex> lock(mutex);
+		channels.erase(channel);
+	}
+
+	// 返回成功入队的连接数
+	size_t broadcast(const std::string& text) {
+		std::string frame;
+		WebSocket::encodeFrame(frame, WebSocket::TEXT, text.data(), text.size());
+		std::vector<WebSocketPtr> targets;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			targets.assign(channels.begin(), channels.end());
+		}
+		size_t sent = 0;
+		for (const auto& channel : targets) {
+			if (channel->sendFrame(frame)) sent++;
+		}
+		return sent;
+	}
+
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return channels.size();
+	}
+
+private:
+	std::mutex mutex;
+	std::unordered_set<WebSocketPtr> channels;
+};
+
+#endif
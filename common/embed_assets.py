@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# 把 UI/ 目录下的页面嵌入可执行文件：生成 UiAssets.h，其中每个文件是一个 constexpr 字符串，
+# 并在构建时算好 ETag、MIME类型与gzip预压缩的版本，运行时不再读文件、也不再压缩。
+# 用法（Dockerfile 中在阶段目录下、编译之前执行）：
+#     python3 ../common/embed_assets.py UI UiAssets.h
+import gzip
+import hashlib
+import os
+import sys
+
+MIME_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "text/javascript; charset=utf-8",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".ico": "image/x-icon",
+}
+
+SIMPLE_ESCAPES = {"\n": "\\n", "\t": "\\t", '"': '\\"', "\\": "\\\\"}
+
+# 压缩后不够小的文件（图片等）不保存gzip版本
+MIN_GZIP_SAVING = 0.9
+
+
+def literal(data):
+    """转成C++字符串字面量：可打印字符原样保留，其余写成三位八进制转义（不会与后面的数字连在一起）"""
+    lines, line = [], []
+    for byte in data:
+        c = chr(byte)
+        if c in SIMPLE_ESCAPES:
+            line.append(SIMPLE_ESCAPES[c])
+        elif 32 <= byte < 127 and c != "?":
+            line.append(c)
+        else:
+            line.append("\\%03o" % byte)
+        if byte == 10 or len(line) >= 120:
+            lines.append('"' + "".join(line) + '"')
+            line = []
+    if line or not lines:
+        lines.append('"' + "".join(line) + '"')
+    return "\n\t".join(lines)
+
+
+def main():
+    source, output = sys.argv[1], sys.argv[2]
+    entries = []
+    out = [
+        "// 由 embed_assets.py 根据 %s/ 生成，请勿手工修改；由 StaticAssets.h 在定义 EmbeddedAsset 之后包含" % source,
+        "#ifndef _UI_ASSETS_H",
+        "#define _UI_ASSETS_H",
+        "",
+        "#include <string_view>",
+        "",
+        "namespace ui_assets {",
+    ]
+    for root, _, files in sorted(os.walk(source)):
+        for name in sorted(files):
+            path = os.path.join(root, name)
+            rel = os.path.relpath(path, source).replace(os.sep, "/")
+            with open(path, "rb") as f:
+                data = f.read()
+            ident = "".join(c if c.isalnum() else "_" for c in rel)
+            compressed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(compressed) > len(data) * MIN_GZIP_SAVING:
+                compressed = b""
+            digest = hashlib.sha256(data).hexdigest()[:16]
+            etag = '\\"' + digest + '\\"'
+            # gzip版本是另一个表示，强ETag必须不同，否则缓存可能用未压缩版本的304回应gzip请求
+            gzip_etag = '\\"' + digest + '-gz\\"' if compressed else ""
+            mime = MIME_TYPES.get(os.path.splitext(name)[1].lower(), "application/octet-stream")
+            out.append("inline constexpr char %s[] =\n\t%s;" % (ident, literal(data)))
+            out.append("inline constexpr char %s_gz[] =\n\t%s;" % (ident, literal(compressed)))
+            entries.append('\t{"%s", "%s", "%s", "%s", std::string_view(%s, %d), std::string_view(%s_gz, %d)},'
+                           % (rel, mime, etag, gzip_etag, ident, len(data), ident, len(compressed)))
+    out += [
+        "}",
+        "",
+        "inline constexpr EmbeddedAsset kEmbeddedAssets[] = {",
+    ] + [e.replace("std::string_view(", "std::string_view(ui_assets::") for e in entries] + [
+        "};",
+        "",
+        "#endif",
+        "",
+    ]
+    with open(output, "w") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()